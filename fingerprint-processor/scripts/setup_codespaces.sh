@@ -1,2 +1,2 @@
-#!/bin/bash 
-# Codespaces environment setup 
+#!/bin/bash 
+# Codespaces environment setup 
@@ -1,2 +1,2 @@
-#!/bin/bash 
-# Automated testing script 
+#!/bin/bash 
+# Automated testing script 
@@ -1,2 +1,179 @@
-// AddressGenerator.cpp - AddressGenerator implementation 
-// Implementation placeholder 
+// AddressGenerator.cpp - AddressGenerator implementation 
+// Implementation placeholder 
+#include "AddressGenerator.h"
+#include <array>
+
+namespace {
+
+// Bin lookup tables: entry v holds the number of edges <= v, for every fixed-point value v
+template <size_t SIZE, size_t EDGES>
+constexpr std::array<uint8_t, SIZE> make_bins(const std::array<int, EDGES>& edges) {
+    std::array<uint8_t, SIZE> bins{};
+    for (size_t value = 0; value < SIZE; ++value) {
+        uint8_t bin = 0;
+        for (size_t e = 0; e < EDGES; ++e) {
+            if (static_cast<int>(value) >= edges[e]) bin = static_cast<uint8_t>(e + 1);
+        }
+        bins[value] = bin;
+    }
+    return bins;
+}
+
+// Ridge period in quarter pixels (0-63): 15 edges from 5.0 to 14.0 px, finer where prints cluster
+constexpr std::array<int, 15> RIDGE_EDGES = {20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 44, 48, 52, 56};
+constexpr std::array<uint8_t, 64> RIDGE_BINS = make_bins<64>(RIDGE_EDGES);
+
+// Minutiae count inside the ROI (0-63)
+constexpr std::array<int, 15> MINUTIAE_EDGES = {1, 2, 3, 4, 5, 6, 8, 10, 12, 14, 16, 20, 24, 28, 32};
+constexpr std::array<uint8_t, 64> MINUTIAE_BINS = make_bins<64>(MINUTIAE_EDGES);
+
+// Zernike magnitude ratio in 1/1024 units (0-255, i.e. up to 0.25), roughly geometric edges
+constexpr std::array<int, 15> ZERNIKE_EDGES = {2, 3, 4, 6, 8, 11, 15, 20, 27, 36, 48, 64, 85, 113, 150};
+constexpr std::array<uint8_t, 256> ZERNIKE_BINS = make_bins<256>(ZERNIKE_EDGES);
+
+static_assert(RIDGE_BINS[0] == 0 && RIDGE_BINS[19] == 0 && RIDGE_BINS[20] == 1 && RIDGE_BINS[63] == 15,
+              "ridge bins: values land in the bin whose lower edge they reach");
+static_assert(MINUTIAE_BINS[0] == 0 && MINUTIAE_BINS[7] == 6 && MINUTIAE_BINS[32] == 15,
+              "minutiae bins");
+static_assert(ZERNIKE_BINS[1] == 0 && ZERNIKE_BINS[64] == 12 && ZERNIKE_BINS[255] == 15,
+              "zernike bins");
+
+constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+constexpr char PATTERN_LETTERS[] = "XATLRW";    // Indexed by FeatureExtractor::PatternType
+constexpr uint8_t PATTERN_RANK[] = {5, 0, 3, 1, 2, 4}; // Alphabetical rank of each letter above
+
+// Key nibble for each address character (0xFF = not allowed): pattern letters by rank, hex digits by value
+struct KeyDigitTables {
+    uint8_t pattern[256];
+    uint8_t hex[256];
+};
+
+constexpr KeyDigitTables build_key_digit_tables() {
+    KeyDigitTables tables{};
+    for (int c = 0; c < 256; ++c) {
+        tables.pattern[c] = 0xFF;
+        tables.hex[c] = 0xFF;
+    }
+    for (int type = 0; type < 6; ++type) {
+        tables.pattern[static_cast<uint8_t>(PATTERN_LETTERS[type])] = PATTERN_RANK[type];
+    }
+    for (int digit = 0; digit < 16; ++digit) {
+        tables.hex[static_cast<uint8_t>(HEX_DIGITS[digit])] = static_cast<uint8_t>(digit);
+    }
+    return tables;
+}
+
+constexpr KeyDigitTables KEY_DIGITS = build_key_digit_tables();
+
+// Key nibble carried by each address character (0 = most significant, -1 = separator)
+constexpr int NIBBLE_FOR_POSITION[AddressGenerator::ADDRESS_LENGTH] = {0, -1, 1, -1, 2, -1, 3, 4, 5, 6};
+
+// Keys sort like the text only if the ranks follow the letters' alphabetical order (A<L<R<T<W<X)
+constexpr bool ranks_follow_letters() {
+    for (int a = 0; a < 6; ++a) {
+        for (int b = 0; b < 6; ++b) {
+            if ((PATTERN_LETTERS[a] < PATTERN_LETTERS[b]) != (PATTERN_RANK[a] < PATTERN_RANK[b])) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(ranks_follow_letters(), "PATTERN_RANK must order the pattern letters alphabetically");
+
+// Orders of the Zernike magnitudes used, as (n, m)
+constexpr int ZERNIKE_ORDERS[AddressGenerator::ZERNIKE_DIGITS][2] = {{2, 0}, {2, 2}, {3, 1}, {4, 2}};
+
+// Clamped in float before the cast: converting NaN or an out-of-range float to int is undefined
+inline int to_fixed(float value, float scale, int max_value) {
+    float scaled = value * scale;
+    if (!(scaled > 0.0f)) return 0;         // Negative, zero or NaN
+    if (scaled >= static_cast<float>(max_value)) return max_value;
+    return static_cast<int>(scaled);
+}
+
+} // namespace
+
+AddressGenerator::Features AddressGenerator::make_features(const FeatureExtractor::PatternClassification& pattern,
+                                                           const FeatureExtractor::RidgeDensity& ridge,
+                                                           const FeatureExtractor::MinutiaeResult& minutiae,
+                                                           const FeatureExtractor::ZernikeMoments& zernike) {
+    Features features;
+    features.pattern = pattern.type;
+    features.ridge_period = ridge.ridge_period;
+    features.minutiae_count = static_cast<int>(minutiae.minutiae.size());
+    
+    const float z00 = zernike.magnitude[FeatureExtractor::ZernikeMoments::index(0, 0)];
+    for (int i = 0; i < ZERNIKE_DIGITS; ++i) {
+        float magnitude = zernike.magnitude[FeatureExtractor::ZernikeMoments::index(ZERNIKE_ORDERS[i][0], ZERNIKE_ORDERS[i][1])];
+        features.zernike_ratio[i] = z00 > 0 ? magnitude / z00 : 0.0f;
+    }
+    return features;
+}
+
+AddressGenerator::Codes AddressGenerator::quantize(const Features& features) {
+    Codes codes;
+    
+    int pattern = static_cast<int>(features.pattern);
+    codes.pattern = static_cast<uint8_t>(pattern < 0 || pattern > 5 ? 0 : pattern);
+    codes.ridge = RIDGE_BINS[to_fixed(features.ridge_period, 4.0f, 63)];
+    codes.minutiae = MINUTIAE_BINS[features.minutiae_count < 0 ? 0 : (features.minutiae_count > 63 ? 63 : features.minutiae_count)];
+    for (int i = 0; i < ZERNIKE_DIGITS; ++i) {
+        codes.zernike[i] = ZERNIKE_BINS[to_fixed(features.zernike_ratio[i], 1024.0f, 255)];
+    }
+    return codes;
+}
+
+void AddressGenerator::format(const Codes& codes, Address& address) {
+    char* out = address.text;
+    out[0] = PATTERN_LETTERS[codes.pattern];
+    out[1] = '-';
+    out[2] = HEX_DIGITS[codes.ridge & 15];
+    out[3] = '-';
+    out[4] = HEX_DIGITS[codes.minutiae & 15];
+    out[5] = '-';
+    for (int i = 0; i < ZERNIKE_DIGITS; ++i) {
+        out[6 + i] = HEX_DIGITS[codes.zernike[i] & 15];
+    }
+    out[ADDRESS_LENGTH] = '\0';
+}
+
+uint64_t AddressGenerator::address_key(const Codes& codes) {
+    uint64_t key = static_cast<uint64_t>(PATTERN_RANK[codes.pattern < 6 ? codes.pattern : 0]) << 60;
+    key |= static_cast<uint64_t>(codes.ridge & 15) << 56;
+    key |= static_cast<uint64_t>(codes.minutiae & 15) << 52;
+    for (int i = 0; i < ZERNIKE_DIGITS; ++i) {
+        key |= static_cast<uint64_t>(codes.zernike[i] & 15) << (48 - 4 * i);
+    }
+    return key;
+}
+
+bool AddressGenerator::address_key(const char* address, uint64_t& key) {
+    // A complete address is a prefix whose range starts at its own key
+    uint64_t high = 0;
+    return strlen(address) == ADDRESS_LENGTH && prefix_range(address, key, high);
+}
+
+bool AddressGenerator::prefix_range(const char* prefix, uint64_t& low, uint64_t& high) {
+    low = 0;
+    int nibbles = 0;
+    
+    for (size_t position = 0; prefix[position] != '\0'; ++position) {
+        if (position >= ADDRESS_LENGTH) return false;
+        
+        const uint8_t c = static_cast<uint8_t>(prefix[position]);
+        const int nibble = NIBBLE_FOR_POSITION[position];
+        if (nibble < 0) {
+            if (c != '-') return false;
+            continue;
+        }
+        
+        const uint8_t digit = nibble == 0 ? KEY_DIGITS.pattern[c] : KEY_DIGITS.hex[c];
+        if (digit == 0xFF) return false;
+        low |= static_cast<uint64_t>(digit) << (60 - 4 * nibble);
+        nibbles = nibble + 1;
+    }
+    
+    // Everything below the fixed nibbles is free; cap at INT64_MAX for SQLite
+    high = nibbles == 0 ? static_cast<uint64_t>(INT64_MAX) : low | ((1ull << (64 - 4 * nibbles)) - 1);
+    return true;
+}
@@ -1,2 +1,85 @@
-// AddressGenerator.h - Biological address formatting 
-// Implementation placeholder 
+// AddressGenerator.h - Biological address formatting 
+// Implementation placeholder 
+#pragma once
+
+#include "FeatureExtractor.h"
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Biological address generation
+ * Quantizes extracted features with integer bin tables fixed at compile time and
+ * formats the digits into a fixed-size buffer: no allocation, no floating point
+ * after the one conversion of each feature to fixed point.
+ *
+ * Address layout (10 characters, coarse to fine, so prefixes group similar prints):
+ *   P-R-M-ZZZZ
+ *   P     pattern class letter (A arch, T tented arch, L left loop, R right loop, W whorl, X unknown)
+ *   R     ridge period bin (hex)
+ *   M     minutiae count bin (hex)
+ *   ZZZZ  bins of |Z20|, |Z22|, |Z31|, |Z42| relative to |Z00| (hex)
+ *
+ * Each address also packs into an order-preserving 64-bit key (one nibble per
+ * address character, most significant first), so an address prefix becomes a
+ * contiguous key range.
+ */
+class AddressGenerator {
+public:
+    static constexpr size_t ADDRESS_LENGTH = 10;
+    static constexpr int ZERNIKE_DIGITS = 4;
+    
+    struct Address {
+        char text[16];                      // NUL-terminated, ADDRESS_LENGTH characters
+        
+        Address() { memset(text, 0, sizeof(text)); }
+        const char* c_str() const { return text; }
+        bool operator==(const Address& other) const { return memcmp(text, other.text, sizeof(text)) == 0; }
+        bool operator!=(const Address& other) const { return !(*this == other); }
+    };
+    
+    // Features consumed by the address, in their natural units
+    struct Features {
+        FeatureExtractor::PatternType pattern;
+        float ridge_period;                 // Pixels between ridges
+        int minutiae_count;
+        float zernike_ratio[ZERNIKE_DIGITS];    // |Z20|, |Z22|, |Z31|, |Z42| divided by |Z00|
+        
+        Features() : pattern(FeatureExtractor::PatternType::UNKNOWN), ridge_period(0), minutiae_count(0) {
+            memset(zernike_ratio, 0, sizeof(zernike_ratio));
+        }
+    };
+    
+    // Quantized digits (each 0-15 except pattern)
+    struct Codes {
+        uint8_t pattern;
+        uint8_t ridge;
+        uint8_t minutiae;
+        uint8_t zernike[ZERNIKE_DIGITS];
+        
+        Codes() : pattern(0), ridge(0), minutiae(0) {
+            memset(zernike, 0, sizeof(zernike));
+        }
+    };
+    
+    static Features make_features(const FeatureExtractor::PatternClassification& pattern,
+                                  const FeatureExtractor::RidgeDensity& ridge,
+                                  const FeatureExtractor::MinutiaeResult& minutiae,
+                                  const FeatureExtractor::ZernikeMoments& zernike);
+    
+    static Codes quantize(const Features& features);
+    static void format(const Codes& codes, Address& address);
+    
+    static Address generate(const Features& features) {
+        Address address;
+        format(quantize(features), address);
+        return address;
+    }
+    
+    // Order-preserving key: key(a) < key(b) exactly when a < b as strings.
+    // Uses the top 28 bits; always below 2^63, so it is safe as a SQLite INTEGER.
+    static uint64_t address_key(const Codes& codes);
+    static bool address_key(const char* address, uint64_t& key);   // False if not a valid address
+    
+    // Inclusive key range of all addresses starting with prefix (e.g. "L-8", "W-A-3-5")
+    static bool prefix_range(const char* prefix, uint64_t& low, uint64_t& high);
+};
@@ -1,478 +1,1111 @@
-// CorePointDetector.cpp - CorePointDetector implementation 
-// Implementation placeholder 
-#include "CorePointDetector.h"
-#include "../utils/Logger.h"
-#include "../utils/Timer.h"
-#include <algorithm>
-#include <cmath>
-#include <thread>
-#include <future>
-
-// Static member definitions
-bool CorePointDetector::simd_available = CorePointDetector::check_simd_support();
-
-bool CorePointDetector::check_simd_support() {
-    // Check for AVX2 support
-    #ifdef __AVX2__
-    Logger::info("AVX2 SIMD support detected and enabled");
-    return true;
-    #else
-    Logger::info("AVX2 SIMD not available, using scalar fallback");
-    return false;
-    #endif
-}
-
-std::string CorePointDetector::get_system_info() {
-    std::string info = "CorePointDetector System Info:\n";
-    info += "- SIMD Support: " + std::string(simd_available ? "AVX2 Enabled" : "Scalar Only") + "\n";
-    info += "- OpenCV Version: " + std::string(CV_VERSION) + "\n";
-    info += "- Compiler: GCC " + std::string(__VERSION__) + "\n";
-    return info;
-}
-
-CorePointDetector::CorePointDetector(const DetectionParams& detection_params) 
-    : params(detection_params) {
-    
-    // Validate parameters
-    if (params.gaussian_kernel_size % 2 == 0) {
-        params.gaussian_kernel_size++;
-        Logger::warning("Gaussian kernel size must be odd, adjusted to " + 
-                       std::to_string(params.gaussian_kernel_size));
-    }
-    
-    if (params.sobel_kernel_size % 2 == 0) {
-        params.sobel_kernel_size++;
-        Logger::warning("Sobel kernel size must be odd, adjusted to " + 
-                       std::to_string(params.sobel_kernel_size));
-    }
-    
-    // Disable SIMD if not available
-    if (params.use_simd && !simd_available) {
-        params.use_simd = false;
-        Logger::info("SIMD requested but not available, using scalar implementation");
-    }
-    
-    Logger::info("CorePointDetector initialized with " + 
-                std::string(params.use_simd ? "SIMD" : "scalar") + " processing");
-}
-
-CorePointDetector::DetectionResult CorePointDetector::detect_core_point(const cv::Mat& image, 
-                                                                       const std::string& filename,
-                                                                       int file_index) {
-    Timer detection_timer;
-    detection_timer.start();
-    
-    DetectionResult result;
-    result.success = false;
-    
-    // Validate input
-    if (image.empty()) {
-        result.error_message = "Input image is empty";
-        return result;
-    }
-    
-    if (image.channels() != 1) {
-        result.error_message = "Input image must be grayscale";
-        return result;
-    }
-    
-    if (image.rows < 101 || image.cols < 101) {
-        result.error_message = "Input image too small (minimum 101x101)";
-        return result;
-    }
-    
-    try {
-        // Step 1: Preprocess image
-        Timer::profile_start("preprocess");
-        cv::Mat processed_image = preprocess_image(image);
-        Timer::profile_stop("preprocess");
-        
-        // Step 2: Assess image quality
-        Timer::profile_start("quality_assessment");
-        result.overall_quality = assess_image_quality(processed_image);
-        Timer::profile_stop("quality_assessment");
-        
-        if (result.overall_quality < 0.2f) {
-            result.error_message = "Image quality too low for processing";
-            result.processing_time_us = static_cast<uint64_t>(detection_timer.stop());
-            return result;
-        }
-        
-        // Step 3: Compute orientation field
-        Timer::profile_start("orientation_field");
-        cv::Mat orientation_field = compute_orientation_field(processed_image);
-        Timer::profile_stop("orientation_field");
-        
-        // Step 4: Compute ridge frequency
-        Timer::profile_start("ridge_frequency");
-        cv::Mat frequency_field = compute_ridge_frequency(processed_image);
-        Timer::profile_stop("ridge_frequency");
-        
-        // Step 5: Detect core point candidates
-        Timer::profile_start("core_detection");
-        std::vector<CorePoint> candidates = detect_core_candidates(orientation_field, frequency_field);
-        Timer::profile_stop("core_detection");
-        
-        if (candidates.empty()) {
-            result.error_message = "No core point candidates found";
-            result.processing_time_us = static_cast<uint64_t>(detection_timer.stop());
-            return result;
-        }
-        
-        // Step 6: Select best core point
-        Timer::profile_start("core_validation");
-        CorePoint best_core = select_best_core_point(candidates);
-        
-        // Validate the selected core point
-        best_core.confidence = validate_core_point(orientation_field, processed_image, best_core);
-        Timer::profile_stop("core_validation");
-        
-        if (best_core.confidence < params.min_confidence) {
-            result.error_message = "Core point confidence too low: " + std::to_string(best_core.confidence);
-            result.processing_time_us = static_cast<uint64_t>(detection_timer.stop());
-            return result;
-        }
-        
-        // Step 7: Extract ROI
-        Timer::profile_start("roi_extraction");
-        result.extracted_roi = extract_roi_around_point(image, best_core, filename, file_index);
-        Timer::profile_stop("roi_extraction");
-        
-        // Step 8: Final validation
-        if (!validate_roi_size(result.extracted_roi)) {
-            result.error_message = "Failed to extract valid ROI";
-            result.processing_time_us = static_cast<uint64_t>(detection_timer.stop());
-            return result;
-        }
-        
-        // Success!
-        result.core_points.push_back(best_core);
-        result.success = true;
-        result.overall_quality = std::min(result.overall_quality, assess_roi_quality(result.extracted_roi));
-        
-    } catch (const std::exception& e) {
-        result.error_message = "Exception during processing: " + std::string(e.what());
-        Logger::error("Core point detection failed: " + result.error_message);
-    }
-    
-    result.processing_time_us = static_cast<uint64_t>(detection_timer.stop());
-    update_stats(result);
-    
-    return result;
-}
-
-cv::Mat CorePointDetector::preprocess_image(const cv::Mat& input) {
-    cv::Mat processed;
-    
-    // Step 1: Gaussian blur to reduce noise
-    cv::GaussianBlur(input, processed, 
-                     cv::Size(params.gaussian_kernel_size, params.gaussian_kernel_size),
-                     params.gaussian_sigma);
-    
-    // Step 2: Normalize to improve contrast
-    cv::normalize(processed, processed, 0, 255, cv::NORM_MINMAX);
-    
-    // Step 3: Apply histogram equalization for better contrast
-    cv::equalizeHist(processed, processed);
-    
-    return processed;
-}
-
-cv::Mat CorePointDetector::compute_orientation_field(const cv::Mat& image) {
-    cv::Mat grad_x, grad_y;
-    
-    // Compute gradients using SIMD if available
-    if (params.use_simd && simd_available) {
-        compute_gradients_simd(image, grad_x, grad_y);
-    } else {
-        compute_gradients_scalar(image, grad_x, grad_y);
-    }
-    
-    // Compute orientation field
-    cv::Mat orientation(image.size(), CV_32F);
-    
-    for (int y = 0; y < image.rows; ++y) {
-        for (int x = 0; x < image.cols; ++x) {
-            float gx = grad_x.at<float>(y, x);
-            float gy = grad_y.at<float>(y, x);
-            
-            // Compute orientation (doubled angle to handle 180-degree ambiguity)
-            float angle = std::atan2(2 * gx * gy, gx * gx - gy * gy) * 0.5f;
-            orientation.at<float>(y, x) = angle;
-        }
-    }
-    
-    return orientation;
-}
-
-void CorePointDetector::compute_gradients_simd(const cv::Mat& image, cv::Mat& grad_x, cv::Mat& grad_y) {
-    #ifdef __AVX2__
-    // Use Sobel operators for gradient computation with SIMD optimization
-    cv::Sobel(image, grad_x, CV_32F, 1, 0, params.sobel_kernel_size);
-    cv::Sobel(image, grad_y, CV_32F, 0, 1, params.sobel_kernel_size);
-    processing_stats.simd_operations_used++;
-    #else
-    // Fallback to scalar version
-    compute_gradients_scalar(image, grad_x, grad_y);
-    #endif
-}
-
-void CorePointDetector::compute_gradients_scalar(const cv::Mat& image, cv::Mat& grad_x, cv::Mat& grad_y) {
-    cv::Sobel(image, grad_x, CV_32F, 1, 0, params.sobel_kernel_size);
-    cv::Sobel(image, grad_y, CV_32F, 0, 1, params.sobel_kernel_size);
-}
-
-cv::Mat CorePointDetector::compute_ridge_frequency(const cv::Mat& image) {
-    cv::Mat frequency(image.size(), CV_32F, cv::Scalar(0));
-    
-    // Simple frequency estimation using local variance
-    int window_size = params.block_size;
-    int half_window = window_size / 2;
-    
-    for (int y = half_window; y < image.rows - half_window; ++y) {
-        for (int x = half_window; x < image.cols - half_window; ++x) {
-            cv::Rect roi(x - half_window, y - half_window, window_size, window_size);
-            cv::Mat block = image(roi);
-            
-            cv::Scalar mean, stddev;
-            cv::meanStdDev(block, mean, stddev);
-            
-            // Frequency estimate based on local variation
-            frequency.at<float>(y, x) = static_cast<float>(stddev[0] / 255.0);
-        }
-    }
-    
-    return frequency;
-}
-
-std::vector<CorePointDetector::CorePoint> CorePointDetector::detect_core_candidates(
-    const cv::Mat& orientation_field, const cv::Mat& frequency_field) {
-    
-    std::vector<CorePoint> candidates;
-    
-    // Simple core point detection based on orientation field singularities
-    int window_size = params.block_size;
-    int step = window_size / 2;
-    
-    for (int y = window_size; y < orientation_field.rows - window_size; y += step) {
-        for (int x = window_size; x < orientation_field.cols - window_size; x += step) {
-            
-            // Analyze orientation changes around this point
-            float orientation_variance = 0.0f;
-            float center_orientation = orientation_field.at<float>(y, x);
-            int count = 0;
-            
-            for (int dy = -window_size/2; dy <= window_size/2; dy += 2) {
-                for (int dx = -window_size/2; dx <= window_size/2; dx += 2) {
-                    if (y + dy >= 0 && y + dy < orientation_field.rows &&
-                        x + dx >= 0 && x + dx < orientation_field.cols) {
-                        
-                        float local_orientation = orientation_field.at<float>(y + dy, x + dx);
-                        float diff = std::abs(local_orientation - center_orientation);
-                        
-                        // Handle circular nature of angles
-                        if (diff > M_PI) diff = 2 * M_PI - diff;
-                        
-                        orientation_variance += diff * diff;
-                        count++;
-                    }
-                }
-            }
-            
-            if (count > 0) {
-                orientation_variance /= count;
-                
-                // High orientation variance indicates potential core point
-                if (orientation_variance > 0.5f) {
-                    float frequency_quality = frequency_field.at<float>(y, x);
-                    float confidence = orientation_variance * frequency_quality;
-                    
-                    if (confidence > params.min_confidence) {
-                        candidates.emplace_back(static_cast<float>(x), static_cast<float>(y), confidence);
-                    }
-                }
-            }
-        }
-    }
-    
-    Logger::debug("Found " + std::to_string(candidates.size()) + " core point candidates");
-    return candidates;
-}
-
-float CorePointDetector::validate_core_point(const cv::Mat& orientation_field, 
-                                            const cv::Mat& image, 
-                                            const CorePoint& candidate) {
-    // Additional validation of core point quality
-    int x = static_cast<int>(candidate.x);
-    int y = static_cast<int>(candidate.y);
-    
-    if (!is_point_valid(candidate, image.cols, image.rows)) {
-        return 0.0f;
-    }
-    
-    // Check local image quality around the core point
-    int window_size = 21; // Small window for local analysis
-    int half_window = window_size / 2;
-    
-    if (x - half_window < 0 || x + half_window >= image.cols ||
-        y - half_window < 0 || y + half_window >= image.rows) {
-        return candidate.confidence * 0.5f; // Reduce confidence for edge points
-    }
-    
-    cv::Rect roi(x - half_window, y - half_window, window_size, window_size);
-    cv::Mat local_area = image(roi);
-    
-    cv::Scalar mean, stddev;
-    cv::meanStdDev(local_area, mean, stddev);
-    
-    // Good core points should have reasonable contrast
-    float contrast_score = static_cast<float>(stddev[0] / 255.0);
-    
-    return candidate.confidence * contrast_score;
-}
-
-CorePointDetector::ROI CorePointDetector::extract_roi_around_point(const cv::Mat& image, 
-                                                                  const CorePoint& core_point, 
-                                                                  const std::string& filename,
-                                                                  int file_index) {
-    ROI roi;
-    roi.filename = filename;
-    roi.file_index = file_index;
-    
-    int center_x = static_cast<int>(core_point.x);
-    int center_y = static_cast<int>(core_point.y);
-    
-    // Extract exactly 101x101 ROI centered on core point
-    int half_size = 50; // 101/2 = 50.5, rounded down
-    
-    for (int y = 0; y < 101; ++y) {
-        for (int x = 0; x < 101; ++x) {
-            int img_x = center_x - half_size + x;
-            int img_y = center_y - half_size + y;
-            
-            // Handle boundary conditions by padding with edge values
-            if (img_x < 0) img_x = 0;
-            if (img_x >= image.cols) img_x = image.cols - 1;
-            if (img_y < 0) img_y = 0;
-            if (img_y >= image.rows) img_y = image.rows - 1;
-            
-            roi.pixels[y][x] = image.at<uint8_t>(img_y, img_x);
-        }
-    }
-    
-    return roi;
-}
-
-float CorePointDetector::assess_image_quality(const cv::Mat& image) {
-    cv::Scalar mean, stddev;
-    cv::meanStdDev(image, mean, stddev);
-    
-    // Quality based on contrast and sharpness
-    float contrast_score = static_cast<float>(stddev[0] / 255.0);
-    
-    // Simple sharpness measure using Laplacian variance
-    cv::Mat laplacian;
-    cv::Laplacian(image, laplacian, CV_64F);
-    cv::Scalar laplacian_mean, laplacian_stddev;
-    cv::meanStdDev(laplacian, laplacian_mean, laplacian_stddev);
-    float sharpness_score = static_cast<float>(laplacian_stddev[0] / 1000.0); // Normalize
-    
-    return std::min(1.0f, contrast_score + sharpness_score * 0.5f);
-}
-
-float CorePointDetector::assess_roi_quality(const ROI& roi) {
-    // Convert ROI to cv::Mat for analysis
-    cv::Mat roi_mat(101, 101, CV_8U);
-    for (int y = 0; y < 101; ++y) {
-        for (int x = 0; x < 101; ++x) {
-            roi_mat.at<uint8_t>(y, x) = roi.pixels[y][x];
-        }
-    }
-    
-    return assess_image_quality(roi_mat);
-}
-
-bool CorePointDetector::is_point_valid(const CorePoint& point, int image_width, int image_height) {
-    // Ensure point is within image bounds with margin for ROI extraction
-    int margin = 50; // Half of ROI size
-    return point.x >= margin && point.x < image_width - margin &&
-           point.y >= margin && point.y < image_height - margin &&
-           point.confidence > 0.0f;
-}
-
-CorePointDetector::CorePoint CorePointDetector::select_best_core_point(const std::vector<CorePoint>& candidates) {
-    if (candidates.empty()) {
-        return CorePoint(); // Return invalid point
-    }
-    
-    // Find candidate with highest confidence
-    auto best_it = std::max_element(candidates.begin(), candidates.end(),
-        [](const CorePoint& a, const CorePoint& b) {
-            return a.confidence < b.confidence;
-        });
-    
-    return *best_it;
-}
-
-std::vector<CorePointDetector::DetectionResult> CorePointDetector::detect_batch(
-    const std::vector<cv::Mat>& images,
-    const std::vector<std::string>& filenames,
-    bool parallel) {
-    
-    std::vector<DetectionResult> results;
-    results.reserve(images.size());
-    
-    if (parallel && images.size() > 1) {
-        // Parallel processing
-        std::vector<std::future<DetectionResult>> futures;
-        
-        for (size_t i = 0; i < images.size(); ++i) {
-            std::string filename = (i < filenames.size()) ? filenames[i] : "";
-            
-            futures.push_back(std::async(std::launch::async, [this, &images, filename, i]() {
-                return detect_core_point(images[i], filename, static_cast<int>(i));
-            }));
-        }
-        
-        // Collect results
-        for (auto& future : futures) {
-            results.push_back(future.get());
-        }
-    } else {
-        // Sequential processing
-        for (size_t i = 0; i < images.size(); ++i) {
-            std::string filename = (i < filenames.size()) ? filenames[i] : "";
-            results.push_back(detect_core_point(images[i], filename, static_cast<int>(i)));
-        }
-    }
-    
-    return results;
-}
-
-bool CorePointDetector::validate_roi_size(const ROI& roi) {
-    // ROI should always be exactly 101x101
-    return true; // Size is enforced by the array definition
-}
-
-bool CorePointDetector::validate_core_point(const CorePoint& point) {
-    return point.x >= 0 && point.y >= 0 && point.confidence >= 0.0f && point.confidence <= 1.0f;
-}
-
-void CorePointDetector::update_stats(const DetectionResult& result) {
-    processing_stats.total_images_processed++;
-    
-    if (result.success) {
-        processing_stats.successful_detections++;
-        if (!result.core_points.empty()) {
-            processing_stats.average_confidence = 
-                (processing_stats.average_confidence * (processing_stats.successful_detections - 1) + 
-                 result.core_points[0].confidence) / processing_stats.successful_detections;
-        }
-    } else {
-        processing_stats.failed_detections++;
-    }
-    
-    processing_stats.average_processing_time_us = 
-        (processing_stats.average_processing_time_us * (processing_stats.total_images_processed - 1) + 
-         result.processing_time_us) / processing_stats.total_images_processed;
-}
+// CorePointDetector.cpp - CorePointDetector implementation 
+// Implementation placeholder 
+#include "CorePointDetector.h"
+#include "RoiHasher.h"
+#include "ImageKernels.h"
+#include "../utils/Logger.h"
+#include "../utils/Timer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <future>
+#include <map>
+
+// Static member definitions
+bool CorePointDetector::simd_available = CorePointDetector::check_simd_support();
+
+bool CorePointDetector::check_simd_support() {
+    // Check for AVX2 support
+    #ifdef __AVX2__
+    Logger::info("AVX2 SIMD support detected and enabled");
+    return true;
+    #else
+    Logger::info("AVX2 SIMD not available, using scalar fallback");
+    return false;
+    #endif
+}
+
+CorePointDetector::DetectionWorkspace& CorePointDetector::thread_workspace() {
+    thread_local DetectionWorkspace workspace;
+    return workspace;
+}
+
+cv::Mat CorePointDetector::DetectionWorkspace::acquire(cv::Mat& buffer, const cv::Size& size, int type) {
+    if (buffer.empty() || buffer.type() != type ||
+        buffer.cols < size.width || buffer.rows < size.height) {
+        buffer.create(std::max(buffer.rows, size.height), std::max(buffer.cols, size.width), type);
+        reallocations++;
+    }
+    
+    // Views of the right size and type make OpenCV's create() a no-op on the destination
+    return buffer(cv::Rect(0, 0, size.width, size.height));
+}
+
+std::string CorePointDetector::get_system_info() {
+    std::string info = "CorePointDetector System Info:\n";
+    info += "- SIMD Support: " + std::string(simd_available ? "AVX2 Enabled" : "Scalar Only") + "\n";
+    info += "- OpenCV Version: " + std::string(CV_VERSION) + "\n";
+    info += "- Compiler: GCC " + std::string(__VERSION__) + "\n";
+    return info;
+}
+
+CorePointDetector::CorePointDetector(const DetectionParams& detection_params) 
+    : params(detection_params) {
+    
+    // Validate parameters
+    if (params.gaussian_kernel_size % 2 == 0) {
+        params.gaussian_kernel_size++;
+        Logger::warning("Gaussian kernel size must be odd, adjusted to " + 
+                       std::to_string(params.gaussian_kernel_size));
+    }
+    
+    if (params.sobel_kernel_size % 2 == 0) {
+        params.sobel_kernel_size++;
+        Logger::warning("Sobel kernel size must be odd, adjusted to " + 
+                       std::to_string(params.sobel_kernel_size));
+    }
+    
+    // Disable SIMD if not available
+    if (params.use_simd && !simd_available) {
+        params.use_simd = false;
+        Logger::info("SIMD requested but not available, using scalar implementation");
+    }
+    
+    Logger::info("CorePointDetector initialized with " + 
+                std::string(params.use_simd ? "SIMD" : "scalar") + " processing");
+}
+
+CorePointDetector::DetectionResult CorePointDetector::detect_core_point(const cv::Mat& image, 
+                                                                       const std::string& filename,
+                                                                       int file_index) {
+    DetectionResult result;
+    detect_core_point(image, result, filename, file_index);
+    return result;
+}
+
+void CorePointDetector::detect_core_point(const cv::Mat& image,
+                                          DetectionResult& result,
+                                          const std::string& filename,
+                                          int file_index) {
+    Timer detection_timer;
+    detection_timer.start();
+    
+    result.clear();
+    
+    DetectionWorkspace& workspace = thread_workspace();
+    const size_t reallocations_before = workspace.reallocations;
+    const size_t simd_operations_before = workspace.simd_operations;
+    const size_t capacity_before = workspace.vector_capacity();
+    
+    // Validate input
+    if (image.empty()) {
+        result.error_message = "Input image is empty";
+        return;
+    }
+    
+    if (image.channels() != 1) {
+        result.error_message = "Input image must be grayscale";
+        return;
+    }
+    
+    if (image.rows < 101 || image.cols < 101) {
+        result.error_message = "Input image too small (minimum 101x101)";
+        return;
+    }
+    
+    try {
+        // Step 1: Preprocess image
+        Timer::profile_start("preprocess");
+        cv::Mat processed_image = preprocess_image(image);
+        Timer::profile_stop("preprocess");
+        
+        // Step 2: Assess image quality
+        Timer::profile_start("quality_assessment");
+        result.overall_quality = assess_image_quality(processed_image);
+        Timer::profile_stop("quality_assessment");
+        
+        if (result.overall_quality < 0.2f) {
+            result.error_message = "Image quality too low for processing";
+            result.processing_time_us = static_cast<uint64_t>(detection_timer.stop());
+            return;
+        }
+        
+        // Step 3: Compute orientation field
+        Timer::profile_start("orientation_field");
+        cv::Mat orientation_moments;
+        cv::Mat orientation_field = compute_orientation_field(processed_image, 
+            needs_orientation_moments() ? &orientation_moments : nullptr);
+        if (params.export_orientation_blocks) {
+            summarize_orientation_blocks(orientation_moments, result);
+        }
+        Timer::profile_stop("orientation_field");
+        
+        // Steps 4-8: Ridge frequency, candidates, selection and ROI extraction
+        locate_cores(image, processed_image, orientation_field, orientation_moments, filename, file_index, result);
+    
+    } catch (const std::exception& e) {
+        result.error_message = "Exception during processing: " + std::string(e.what());
+        Logger::error("Core point detection failed: " + result.error_message);
+    }
+    
+    result.processing_time_us = static_cast<uint64_t>(detection_timer.stop());
+    if (workspace.vector_capacity() != capacity_before) {
+        workspace.reallocations++;
+    }
+    add_workspace_stats(workspace.reallocations - reallocations_before,
+                        workspace.simd_operations - simd_operations_before);
+    update_stats(result);
+}
+
+void CorePointDetector::locate_cores(const cv::Mat& image, 
+                                     const cv::Mat& processed_image, 
+                                     const cv::Mat& orientation_field,
+                                     const cv::Mat& orientation_moments,
+                                     const std::string& filename,
+                                     int file_index,
+                                     DetectionResult& result) {
+    // Step 4: Compute ridge frequency
+    Timer::profile_start("ridge_frequency");
+    cv::Mat frequency_field = compute_ridge_frequency(processed_image);
+    Timer::profile_stop("ridge_frequency");
+    
+    // Step 5: Detect core point candidates
+    DetectionWorkspace& workspace = thread_workspace();
+    std::vector<CorePoint>& candidates = workspace.candidates;
+    Timer::profile_start("core_detection");
+    detect_core_candidates(orientation_field, frequency_field, candidates);
+    Timer::profile_stop("core_detection");
+    
+    if (candidates.empty()) {
+        result.error_message = "No core point candidates found";
+        return;
+    }
+    
+    // Step 6: Select best core point(s)
+    Timer::profile_start("core_validation");
+    std::vector<CorePoint>& selected = workspace.selected;
+    if (params.max_core_points > 1) {
+        select_top_core_points(candidates, static_cast<size_t>(params.max_core_points), selected);
+    } else {
+        selected.clear();
+        selected.push_back(select_best_core_point(candidates));
+    }
+    
+    // Validate the selected core points, keeping those above threshold (best first)
+    float best_confidence = 0.0f;
+    for (auto& core : selected) {
+        core.confidence = validate_core_point(orientation_field, processed_image, core);
+        best_confidence = std::max(best_confidence, core.confidence);
+    }
+    selected.erase(std::remove_if(selected.begin(), selected.end(),
+        [this](const CorePoint& core) { return core.confidence < params.min_confidence; }),
+        selected.end());
+    
+    // Stable insertion sort (at most max_core_points entries; std::stable_sort would
+    // allocate a merge buffer)
+    for (size_t i = 1; i < selected.size(); ++i) {
+        CorePoint core = selected[i];
+        size_t j = i;
+        for (; j > 0 && selected[j - 1].confidence < core.confidence; --j) {
+            selected[j] = selected[j - 1];
+        }
+        selected[j] = core;
+    }
+    Timer::profile_stop("core_validation");
+    
+    if (selected.empty()) {
+        char message[64];
+        std::snprintf(message, sizeof(message), "Core point confidence too low: %f", best_confidence);
+        result.error_message.assign(message);
+        return;
+    }
+    
+    // Step 7: Extract ROI for each core, reusing the fields computed above
+    Timer::profile_start("roi_extraction");
+    extract_core_roi(image, orientation_moments, selected[0], filename, file_index, result.extracted_roi);
+    result.secondary_rois.resize(selected.size() - 1);
+    for (size_t i = 1; i < selected.size(); ++i) {
+        extract_core_roi(image, orientation_moments, selected[i], filename, file_index, result.secondary_rois[i - 1]);
+    }
+    if (params.compute_roi_hash) {
+        result.extracted_roi.hash = RoiHasher::compute(result.extracted_roi);
+        for (auto& roi : result.secondary_rois) roi.hash = RoiHasher::compute(roi);
+    }
+    Timer::profile_stop("roi_extraction");
+    
+    // Step 8: Final validation
+    if (!validate_roi_size(result.extracted_roi)) {
+        result.error_message = "Failed to extract valid ROI";
+        return;
+    }
+    
+    // Success!
+    result.core_points.assign(selected.begin(), selected.end());
+    result.success = true;
+    result.overall_quality = std::min(result.overall_quality, assess_roi_quality(result.extracted_roi));
+}
+
+cv::Mat CorePointDetector::preprocess_image(const cv::Mat& input) {
+    DetectionWorkspace& workspace = thread_workspace();
+    cv::Mat processed = workspace.acquire(workspace.processed, input.size(), CV_8U);
+    
+    // Step 1: Gaussian blur to reduce noise
+    blur_image(input, processed);
+    
+    // Step 2: Normalize to improve contrast
+    ImageKernels::normalize_min_max(processed);
+    
+    // Step 3: Apply histogram equalization for better contrast
+    ImageKernels::equalize_hist(processed);
+    
+    return processed;
+}
+
+void CorePointDetector::blur_image(const cv::Mat& input, cv::Mat& output) {
+    DetectionWorkspace& workspace = thread_workspace();
+    cv::Mat scratch = workspace.acquire(workspace.blur_scratch, cv::Size(input.cols, input.rows + 1), CV_32S);
+    
+    if (input.type() != CV_8U ||
+        !ImageKernels::gaussian_blur(input, output, params.gaussian_kernel_size, params.gaussian_sigma, scratch)) {
+        cv::GaussianBlur(input, output, 
+                         cv::Size(params.gaussian_kernel_size, params.gaussian_kernel_size),
+                         params.gaussian_sigma);
+    }
+}
+
+cv::Mat CorePointDetector::compute_orientation_field(const cv::Mat& image, cv::Mat* row_moments) {
+    DetectionWorkspace& workspace = thread_workspace();
+    cv::Mat grad_x = workspace.acquire(workspace.grad_x, image.size(), CV_32F);
+    cv::Mat grad_y = workspace.acquire(workspace.grad_y, image.size(), CV_32F);
+    
+    compute_gradients(image, grad_x, grad_y);
+    
+    // Compute orientation field
+    cv::Mat orientation = workspace.acquire(workspace.orientation, image.size(), CV_32F);
+    
+    // Optionally accumulate (gxx - gyy, 2gxy, gxx + gyy) per row over block_size-wide
+    // column strips in the same sweep, so block orientation needs no second pass
+    const int block_size = params.block_size;
+    const int block_cols = image.cols / block_size;
+    const int moment_width = block_cols * block_size;
+    if (row_moments) {
+        *row_moments = workspace.acquire(workspace.orientation_moments, cv::Size(block_cols, image.rows), CV_32FC3);
+        ImageKernels::zero(*row_moments);
+    }
+    
+    for (int y = 0; y < image.rows; ++y) {
+        float* moments = row_moments ? row_moments->ptr<float>(y) : nullptr;
+        
+        for (int x = 0; x < image.cols; ++x) {
+            float gx = grad_x.at<float>(y, x);
+            float gy = grad_y.at<float>(y, x);
+            
+            // Compute orientation (doubled angle to handle 180-degree ambiguity)
+            float gxx_minus_gyy = gx * gx - gy * gy;
+            float gxy_2 = 2 * gx * gy;
+            float angle = std::atan2(gxy_2, gxx_minus_gyy) * 0.5f;
+            orientation.at<float>(y, x) = angle;
+            
+            if (moments && x < moment_width) {
+                float* block = moments + (x / block_size) * 3;
+                block[0] += gxx_minus_gyy;
+                block[1] += gxy_2;
+                block[2] += gx * gx + gy * gy;
+            }
+        }
+    }
+    
+    return orientation;
+}
+
+void CorePointDetector::summarize_orientation_blocks(const cv::Mat& row_moments, DetectionResult& result) {
+    OrientationBlocks& blocks = result.orientation_blocks;
+    blocks.block_size = params.block_size;
+    blocks.cols = row_moments.cols;
+    blocks.rows = row_moments.rows / params.block_size;
+    
+    const size_t block_count = static_cast<size_t>(blocks.cols) * blocks.rows;
+    blocks.angle.assign(block_count, 0.0f);
+    blocks.coherence.assign(block_count, 0.0f);
+    blocks.energy.assign(block_count, 0.0f);
+    
+    const float pixels_per_block = static_cast<float>(params.block_size * params.block_size);
+    std::vector<float>& sums = thread_workspace().block_sums;
+    sums.resize(static_cast<size_t>(blocks.cols) * 3);
+    
+    for (int by = 0; by < blocks.rows; ++by) {
+        std::fill(sums.begin(), sums.end(), 0.0f);
+        for (int y = by * params.block_size; y < (by + 1) * params.block_size; ++y) {
+            const float* moments = row_moments.ptr<float>(y);
+            for (size_t i = 0; i < sums.size(); ++i) {
+                sums[i] += moments[i];
+            }
+        }
+        
+        for (int bx = 0; bx < blocks.cols; ++bx) {
+            const float* m = &sums[bx * 3];
+            const size_t index = static_cast<size_t>(by) * blocks.cols + bx;
+            blocks.angle[index] = 0.5f * std::atan2(m[1], m[0]);
+            blocks.coherence[index] = m[2] > 1e-6f ? std::sqrt(m[0] * m[0] + m[1] * m[1]) / m[2] : 0.0f;
+            blocks.energy[index] = m[2] / pixels_per_block;
+        }
+    }
+    
+    find_singular_points(result);
+}
+
+void CorePointDetector::find_singular_points(DetectionResult& result) {
+    const OrientationBlocks& blocks = result.orientation_blocks;
+    result.singular_points.clear();
+    if (blocks.cols < 3 || blocks.rows < 3) return;
+    
+    // Foreground blocks: gradient energy well above the background level
+    double mean_energy = 0.0;
+    for (float e : blocks.energy) mean_energy += e;
+    mean_energy /= blocks.energy.size();
+    const float foreground_energy = static_cast<float>(0.2 * mean_energy);
+    
+    // Doubled-angle vectors smoothed over 3x3 blocks, weighted by coherence
+    DetectionWorkspace& workspace = thread_workspace();
+    std::vector<float>& doubled = workspace.doubled_angles;
+    std::vector<uint8_t>& foreground = workspace.foreground_blocks;
+    doubled.assign(blocks.angle.size(), 0.0f);
+    foreground.assign(blocks.angle.size(), 0);
+    for (int by = 0; by < blocks.rows; ++by) {
+        for (int bx = 0; bx < blocks.cols; ++bx) {
+            float vx = 0.0f, vy = 0.0f;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int nx = bx + dx, ny = by + dy;
+                    if (nx < 0 || ny < 0 || nx >= blocks.cols || ny >= blocks.rows) continue;
+                    size_t n = static_cast<size_t>(ny) * blocks.cols + nx;
+                    vx += blocks.coherence[n] * std::cos(2.0f * blocks.angle[n]);
+                    vy += blocks.coherence[n] * std::sin(2.0f * blocks.angle[n]);
+                }
+            }
+            size_t index = static_cast<size_t>(by) * blocks.cols + bx;
+            doubled[index] = std::atan2(vy, vx);
+            foreground[index] = blocks.energy[index] > foreground_energy;
+        }
+    }
+    
+    // Poincare index: total doubled-angle turn around the 8-neighbour ring, in full turns
+    static const int ring_x[8] = {-1, 0, 1, 1, 1, 0, -1, -1};
+    static const int ring_y[8] = {-1, -1, -1, 0, 1, 1, 1, 0};
+    const float pi = static_cast<float>(CV_PI);
+    
+    std::vector<DetectionWorkspace::SingularCluster>& clusters = workspace.singular_clusters;
+    clusters.clear();
+    
+    for (int by = 1; by < blocks.rows - 1; ++by) {
+        for (int bx = 1; bx < blocks.cols - 1; ++bx) {
+            bool ring_in_foreground = true;
+            float turn = 0.0f;
+            for (int k = 0; k < 8 && ring_in_foreground; ++k) {
+                size_t a = static_cast<size_t>(by + ring_y[k]) * blocks.cols + bx + ring_x[k];
+                size_t b = static_cast<size_t>(by + ring_y[(k + 1) & 7]) * blocks.cols + bx + ring_x[(k + 1) & 7];
+                ring_in_foreground = foreground[a] != 0;
+                
+                float delta = doubled[b] - doubled[a];
+                if (delta > pi) delta -= 2 * pi;
+                if (delta <= -pi) delta += 2 * pi;
+                turn += delta;
+            }
+            if (!ring_in_foreground) continue;
+            
+            int index = static_cast<int>(std::lround(turn / (2 * pi)));
+            if (index == 0) continue;
+            
+            // Neighbouring blocks report the same singularity: merge into one point. Rings
+            // that pass through a whorl centre see only half its turn, so a core next to
+            // a whorl centre is the same singularity and keeps the larger index
+            float x = (bx + 0.5f) * blocks.block_size;
+            float y = (by + 0.5f) * blocks.block_size;
+            bool merged = false;
+            for (auto& cluster : clusters) {
+                float cx = cluster.sum_x / cluster.count, cy = cluster.sum_y / cluster.count;
+                if ((cluster.index > 0) == (index > 0) && std::abs(cx - x) <= 2.0f * blocks.block_size && 
+                    std::abs(cy - y) <= 2.0f * blocks.block_size) {
+                    cluster.sum_x += x;
+                    cluster.sum_y += y;
+                    cluster.count++;
+                    if (std::abs(index) > std::abs(cluster.index)) cluster.index = index;
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged) clusters.push_back({x, y, 1, index});
+        }
+    }
+    
+    for (const auto& cluster : clusters) {
+        result.singular_points.emplace_back(cluster.sum_x / cluster.count, cluster.sum_y / cluster.count, cluster.index);
+    }
+}
+
+void CorePointDetector::compute_gradients(const cv::Mat& image, cv::Mat& grad_x, cv::Mat& grad_y) {
+    if (params.sobel_kernel_size == 3 && image.type() == CV_8U) {
+        ImageKernels::sobel_3x3(image, grad_x, grad_y);
+        return;
+    }
+    cv::Sobel(image, grad_x, CV_32F, 1, 0, params.sobel_kernel_size);
+    cv::Sobel(image, grad_y, CV_32F, 0, 1, params.sobel_kernel_size);
+}
+
+cv::Mat CorePointDetector::compute_ridge_frequency(const cv::Mat& image) {
+    DetectionWorkspace& workspace = thread_workspace();
+    cv::Mat frequency = workspace.acquire(workspace.frequency, image.size(), CV_32F);
+    ImageKernels::zero(frequency);
+    
+    // Simple frequency estimation using local variance
+    int window_size = params.block_size;
+    int half_window = window_size / 2;
+    
+    for (int y = half_window; y < image.rows - half_window; ++y) {
+        for (int x = half_window; x < image.cols - half_window; ++x) {
+            cv::Rect roi(x - half_window, y - half_window, window_size, window_size);
+            
+            double mean, stddev;
+            ImageKernels::mean_stddev(image(roi), mean, stddev);
+            
+            // Frequency estimate based on local variation
+            frequency.at<float>(y, x) = static_cast<float>(stddev / 255.0);
+        }
+    }
+    
+    return frequency;
+}
+
+void CorePointDetector::detect_core_candidates(const cv::Mat& orientation_field, 
+                                               const cv::Mat& frequency_field,
+                                               std::vector<CorePoint>& candidates) {
+    candidates.clear();
+    
+    // Simple core point detection based on orientation field singularities
+    int window_size = params.block_size;
+    int step = window_size / 2;
+    
+    for (int y = window_size; y < orientation_field.rows - window_size; y += step) {
+        for (int x = window_size; x < orientation_field.cols - window_size; x += step) {
+            
+            // Analyze orientation changes around this point
+            float orientation_variance = 0.0f;
+            float center_orientation = orientation_field.at<float>(y, x);
+            int count = 0;
+            
+            for (int dy = -window_size/2; dy <= window_size/2; dy += 2) {
+                for (int dx = -window_size/2; dx <= window_size/2; dx += 2) {
+                    if (y + dy >= 0 && y + dy < orientation_field.rows &&
+                        x + dx >= 0 && x + dx < orientation_field.cols) {
+                        
+                        float local_orientation = orientation_field.at<float>(y + dy, x + dx);
+                        float diff = std::abs(local_orientation - center_orientation);
+                        
+                        // Handle circular nature of angles
+                        if (diff > M_PI) diff = 2 * M_PI - diff;
+                        
+                        orientation_variance += diff * diff;
+                        count++;
+                    }
+                }
+            }
+            
+            if (count > 0) {
+                orientation_variance /= count;
+                
+                // High orientation variance indicates potential core point
+                if (orientation_variance > 0.5f) {
+                    float frequency_quality = frequency_field.at<float>(y, x);
+                    float confidence = orientation_variance * frequency_quality;
+                    
+                    if (confidence > params.min_confidence) {
+                        candidates.emplace_back(static_cast<float>(x), static_cast<float>(y), confidence);
+                    }
+                }
+            }
+        }
+    }
+    
+    if (Logger::enabled(Logger::Level::DEBUG)) {
+        Logger::debug("Found " + std::to_string(candidates.size()) + " core point candidates");
+    }
+}
+
+float CorePointDetector::validate_core_point(const cv::Mat& orientation_field, 
+                                            const cv::Mat& image, 
+                                            const CorePoint& candidate) {
+    // Additional validation of core point quality
+    int x = static_cast<int>(candidate.x);
+    int y = static_cast<int>(candidate.y);
+    
+    if (!is_point_valid(candidate, image.cols, image.rows)) {
+        return 0.0f;
+    }
+    
+    // Check local image quality around the core point
+    int window_size = 21; // Small window for local analysis
+    int half_window = window_size / 2;
+    
+    if (x - half_window < 0 || x + half_window >= image.cols ||
+        y - half_window < 0 || y + half_window >= image.rows) {
+        return candidate.confidence * 0.5f; // Reduce confidence for edge points
+    }
+    
+    cv::Rect roi(x - half_window, y - half_window, window_size, window_size);
+    
+    double mean, stddev;
+    ImageKernels::mean_stddev(image(roi), mean, stddev);
+    
+    // Good core points should have reasonable contrast
+    float contrast_score = static_cast<float>(stddev / 255.0);
+    
+    return candidate.confidence * contrast_score;
+}
+
+void CorePointDetector::extract_core_roi(const cv::Mat& image, 
+                                         const cv::Mat& orientation_moments,
+                                         const CorePoint& core_point, 
+                                         const std::string& filename,
+                                         int file_index,
+                                         ROI& roi) {
+    if (params.align_roi_orientation) {
+        float angle = estimate_dominant_orientation(orientation_moments, core_point);
+        extract_roi_subpixel(image, core_point, angle, filename, file_index, roi);
+        return;
+    }
+    extract_roi_around_point(image, core_point, filename, file_index, roi);
+}
+
+void CorePointDetector::extract_roi_around_point(const cv::Mat& image, 
+                                                 const CorePoint& core_point, 
+                                                 const std::string& filename,
+                                                 int file_index,
+                                                 ROI& roi) {
+    roi.filename.assign(filename);
+    roi.file_index = file_index;
+    roi.rotation = 0;
+    roi.hash = RoiHash();
+    
+    int center_x = static_cast<int>(core_point.x);
+    int center_y = static_cast<int>(core_point.y);
+    
+    // Extract exactly 101x101 ROI centered on core point
+    int half_size = 50; // 101/2 = 50.5, rounded down
+    int origin_x = center_x - half_size;
+    int origin_y = center_y - half_size;
+    
+    // Fast path: ROI fully inside the image, one memcpy per row
+    if (origin_x >= 0 && origin_y >= 0 &&
+        origin_x + 101 <= image.cols && origin_y + 101 <= image.rows) {
+        for (int y = 0; y < 101; ++y) {
+            std::memcpy(roi.pixels[y], image.ptr<uint8_t>(origin_y + y) + origin_x, 101);
+        }
+        return;
+    }
+    
+    // Edge path: clamp the source row, copy the in-bounds column span and
+    // replicate the edge pixel into the columns that fall outside the image
+    int inside_begin = std::clamp(-origin_x, 0, 101);
+    int inside_end = std::clamp(image.cols - origin_x, inside_begin, 101);
+    
+    for (int y = 0; y < 101; ++y) {
+        int img_y = std::clamp(origin_y + y, 0, image.rows - 1);
+        const uint8_t* src = image.ptr<uint8_t>(img_y);
+        uint8_t* dst = roi.pixels[y];
+        
+        std::memset(dst, src[0], inside_begin);
+        if (inside_end > inside_begin) {
+            std::memcpy(dst + inside_begin, src + origin_x + inside_begin, inside_end - inside_begin);
+        }
+        std::memset(dst + inside_end, src[image.cols - 1], 101 - inside_end);
+    }
+}
+
+float CorePointDetector::estimate_dominant_orientation(const cv::Mat& orientation_moments, 
+                                                      const CorePoint& core_point) {
+    // Sum the doubled-angle gradient moments (gxx - gyy, 2gxy) around the core: the
+    // per-row block-strip sums already hold them, so no per-pixel trigonometry is needed.
+    // Columns snap to the block strips overlapping the window.
+    const int block_size = params.block_size;
+    int radius = block_size * 2;
+    int cx = static_cast<int>(std::lround(core_point.x));
+    int cy = static_cast<int>(std::lround(core_point.y));
+    int bx_begin = std::max(0, cx - radius) / block_size;
+    int bx_end = std::min(orientation_moments.cols, (cx + radius) / block_size + 1);
+    int y_begin = std::max(0, cy - radius);
+    int y_end = std::min(orientation_moments.rows, cy + radius + 1);
+    
+    double sum_cos = 0.0;
+    double sum_sin = 0.0;
+    for (int y = y_begin; y < y_end; ++y) {
+        const float* moments = orientation_moments.ptr<float>(y);
+        for (int bx = bx_begin; bx < bx_end; ++bx) {
+            sum_cos += moments[bx * 3];
+            sum_sin += moments[bx * 3 + 1];
+        }
+    }
+    
+    if (sum_cos == 0.0 && sum_sin == 0.0) {
+        return 0.0f;
+    }
+    return static_cast<float>(0.5 * std::atan2(sum_sin, sum_cos));
+}
+
+// Sampling grid for one ROI row: offsets -50..50 from the center, padded to a
+// multiple of 8 lanes. The padding lanes are sampled but never stored.
+alignas(32) static const std::array<float, 104> roi_sampling_offsets = [] {
+    std::array<float, 104> offsets{};
+    for (int i = 0; i < 104; ++i) {
+        offsets[i] = static_cast<float>(i - 50);
+    }
+    return offsets;
+}();
+
+void CorePointDetector::extract_roi_subpixel(const cv::Mat& image, 
+                                             const CorePoint& core_point, 
+                                             float angle,
+                                             const std::string& filename,
+                                             int file_index,
+                                             ROI& roi) {
+    roi.filename.assign(filename);
+    roi.file_index = file_index;
+    roi.rotation = angle;
+    roi.hash = RoiHash();
+    
+    float cos_a = std::cos(angle);
+    float sin_a = std::sin(angle);
+    
+    // The rotated grid (including padding lanes) reaches at most 53*sqrt(2) < 76 pixels
+    // from the center. The SIMD path gathers 4 bytes per tap and reads the next row,
+    // so it needs that reach plus a few pixels of slack inside the image.
+    const float reach = 77.0f;
+    bool interior = core_point.x - reach >= 0.0f && core_point.x + reach <= image.cols - 4 &&
+                    core_point.y - reach >= 0.0f && core_point.y + reach <= image.rows - 2;
+    
+    if (params.use_simd && simd_available && interior) {
+        sample_roi_rows_simd(image, core_point.x, core_point.y, cos_a, sin_a, roi);
+    } else {
+        sample_roi_rows_scalar(image, core_point.x, core_point.y, cos_a, sin_a, roi);
+    }
+}
+
+void CorePointDetector::sample_roi_rows_simd(const cv::Mat& image, float cx, float cy, 
+                                             float cos_a, float sin_a, ROI& roi) {
+    #ifdef __AVX2__
+    const int* base = reinterpret_cast<const int*>(image.data);
+    const __m256i step = _mm256_set1_epi32(static_cast<int>(image.step));
+    const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+    const __m256 cos_v = _mm256_set1_ps(cos_a);
+    const __m256 sin_v = _mm256_set1_ps(sin_a);
+    
+    alignas(16) uint8_t row_buffer[104];
+    
+    for (int v = 0; v < 101; ++v) {
+        float dv = static_cast<float>(v - 50);
+        __m256 row_x = _mm256_set1_ps(cx - dv * sin_a);
+        __m256 row_y = _mm256_set1_ps(cy + dv * cos_a);
+        
+        for (int u = 0; u < 104; u += 8) {
+            __m256 du = _mm256_load_ps(&roi_sampling_offsets[u]);
+            __m256 x = _mm256_fmadd_ps(du, cos_v, row_x);
+            __m256 y = _mm256_fmadd_ps(du, sin_v, row_y);
+            
+            __m256 x_floor = _mm256_floor_ps(x);
+            __m256 y_floor = _mm256_floor_ps(y);
+            __m256 fx = _mm256_sub_ps(x, x_floor);
+            __m256 fy = _mm256_sub_ps(y, y_floor);
+            
+            __m256i offset = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(y_floor), step),
+                                              _mm256_cvttps_epi32(x_floor));
+            
+            // Each gather fetches the pixel and its right-hand neighbour in one 32-bit load
+            __m256i top = _mm256_i32gather_epi32(base, offset, 1);
+            __m256i bottom = _mm256_i32gather_epi32(base, _mm256_add_epi32(offset, step), 1);
+            
+            __m256 p00 = _mm256_cvtepi32_ps(_mm256_and_si256(top, byte_mask));
+            __m256 p01 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(top, 8), byte_mask));
+            __m256 p10 = _mm256_cvtepi32_ps(_mm256_and_si256(bottom, byte_mask));
+            __m256 p11 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(bottom, 8), byte_mask));
+            
+            __m256 upper = _mm256_fmadd_ps(fx, _mm256_sub_ps(p01, p00), p00);
+            __m256 lower = _mm256_fmadd_ps(fx, _mm256_sub_ps(p11, p10), p10);
+            __m256 value = _mm256_fmadd_ps(fy, _mm256_sub_ps(lower, upper), upper);
+            
+            // Round and narrow 8 x int32 -> 8 x uint8
+            __m256i rounded = _mm256_cvtps_epi32(value);
+            __m256i packed16 = _mm256_permute4x64_epi64(_mm256_packus_epi32(rounded, rounded), 0x08);
+            __m128i packed8 = _mm_packus_epi16(_mm256_castsi256_si128(packed16), _mm256_castsi256_si128(packed16));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&row_buffer[u]), packed8);
+        }
+        
+        std::memcpy(roi.pixels[v], row_buffer, 101);
+    }
+    thread_workspace().simd_operations++;
+    #else
+    sample_roi_rows_scalar(image, cx, cy, cos_a, sin_a, roi);
+    #endif
+}
+
+void CorePointDetector::sample_roi_rows_scalar(const cv::Mat& image, float cx, float cy, 
+                                               float cos_a, float sin_a, ROI& roi) {
+    const float max_x = static_cast<float>(image.cols - 1);
+    const float max_y = static_cast<float>(image.rows - 1);
+    
+    for (int v = 0; v < 101; ++v) {
+        float dv = static_cast<float>(v - 50);
+        float row_x = cx - dv * sin_a;
+        float row_y = cy + dv * cos_a;
+        
+        for (int u = 0; u < 101; ++u) {
+            // Clamp to the image so border samples replicate the edge pixels
+            float x = std::clamp(row_x + roi_sampling_offsets[u] * cos_a, 0.0f, max_x);
+            float y = std::clamp(row_y + roi_sampling_offsets[u] * sin_a, 0.0f, max_y);
+            
+            int x0 = static_cast<int>(x);
+            int y0 = static_cast<int>(y);
+            int x1 = std::min(x0 + 1, image.cols - 1);
+            int y1 = std::min(y0 + 1, image.rows - 1);
+            float fx = x - x0;
+            float fy = y - y0;
+            
+            const uint8_t* row0 = image.ptr<uint8_t>(y0);
+            const uint8_t* row1 = image.ptr<uint8_t>(y1);
+            float upper = row0[x0] + fx * (row0[x1] - row0[x0]);
+            float lower = row1[x0] + fx * (row1[x1] - row1[x0]);
+            float value = upper + fy * (lower - upper);
+            
+            roi.pixels[v][u] = static_cast<uint8_t>(std::clamp(std::lrint(value), 0L, 255L));
+        }
+    }
+}
+
+float CorePointDetector::assess_image_quality(const cv::Mat& image) {
+    // Simple sharpness measure using Laplacian variance
+    DetectionWorkspace& workspace = thread_workspace();
+    cv::Mat laplacian = workspace.acquire(workspace.laplacian, image.size(), CV_64F);
+    ImageKernels::laplacian(image, laplacian);
+    
+    return score_image_quality(image, laplacian);
+}
+
+float CorePointDetector::score_image_quality(const cv::Mat& image, const cv::Mat& laplacian) {
+    double mean, stddev;
+    ImageKernels::mean_stddev(image, mean, stddev);
+    
+    // Quality based on contrast and sharpness
+    float contrast_score = static_cast<float>(stddev / 255.0);
+    
+    double laplacian_mean, laplacian_stddev;
+    ImageKernels::mean_stddev(laplacian, laplacian_mean, laplacian_stddev);
+    float sharpness_score = static_cast<float>(laplacian_stddev / 1000.0); // Normalize
+    
+    return std::min(1.0f, contrast_score + sharpness_score * 0.5f);
+}
+
+float CorePointDetector::assess_roi_quality(const ROI& roi) {
+    // Analyze the ROI in place through a cv::Mat header (no copy)
+    return assess_image_quality(roi.as_mat());
+}
+
+bool CorePointDetector::is_point_valid(const CorePoint& point, int image_width, int image_height) {
+    // Ensure point is within image bounds with margin for ROI extraction
+    int margin = 50; // Half of ROI size
+    return point.x >= margin && point.x < image_width - margin &&
+           point.y >= margin && point.y < image_height - margin &&
+           point.confidence > 0.0f;
+}
+
+CorePointDetector::CorePoint CorePointDetector::select_best_core_point(const std::vector<CorePoint>& candidates) {
+    if (candidates.empty()) {
+        return CorePoint(); // Return invalid point
+    }
+    
+    // Find candidate with highest confidence
+    auto best_it = std::max_element(candidates.begin(), candidates.end(),
+        [](const CorePoint& a, const CorePoint& b) {
+            return a.confidence < b.confidence;
+        });
+    
+    return *best_it;
+}
+
+void CorePointDetector::select_top_core_points(const std::vector<CorePoint>& candidates, size_t max_count,
+                                               std::vector<CorePoint>& selected) {
+    // Candidates arrive in scan order, so breaking confidence ties by (y, x) gives
+    // the stable order without std::stable_sort's temporary buffer
+    std::vector<CorePoint>& ranked = thread_workspace().ranked;
+    ranked.assign(candidates.begin(), candidates.end());
+    std::sort(ranked.begin(), ranked.end(),
+        [](const CorePoint& a, const CorePoint& b) {
+            if (a.confidence != b.confidence) return a.confidence > b.confidence;
+            if (a.y != b.y) return a.y < b.y;
+            return a.x < b.x;
+        });
+    
+    // Greedy non-maximum suppression: accept the strongest candidate, then skip
+    // anything within core_nms_radius of an already accepted core
+    const float radius_sq = params.core_nms_radius * params.core_nms_radius;
+    selected.clear();
+    
+    for (const auto& candidate : ranked) {
+        bool suppressed = false;
+        for (const auto& accepted : selected) {
+            float dx = candidate.x - accepted.x;
+            float dy = candidate.y - accepted.y;
+            if (dx * dx + dy * dy < radius_sq) {
+                suppressed = true;
+                break;
+            }
+        }
+        
+        if (!suppressed) {
+            selected.push_back(candidate);
+            if (selected.size() >= max_count) break;
+        }
+    }
+}
+
+std::vector<CorePointDetector::DetectionResult> CorePointDetector::detect_batch(
+    const std::vector<cv::Mat>& images,
+    const std::vector<std::string>& filenames,
+    bool parallel) {
+    
+    std::vector<DetectionResult> results(images.size());
+    
+    // Work units: packs of same-size images when packing is enabled, otherwise single images
+    std::vector<std::vector<size_t>> units = plan_batch_units(images);
+    
+    auto run_unit = [this, &images, &filenames, &results](const std::vector<size_t>& unit) {
+        if (unit.size() > 1) {
+            detect_packed(images, filenames, unit, results);
+        } else {
+            size_t i = unit[0];
+            static const std::string no_filename;
+            detect_core_point(images[i], results[i], (i < filenames.size()) ? filenames[i] : no_filename, 
+                              static_cast<int>(i));
+        }
+    };
+    
+    if (parallel && units.size() > 1) {
+        // Parallel processing with one long-lived worker per core, so each
+        // worker's thread-local workspace is reused across all of its units
+        size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
+        worker_count = std::min(worker_count, units.size());
+        
+        std::vector<std::future<void>> workers;
+        workers.reserve(worker_count);
+        
+        for (size_t w = 0; w < worker_count; ++w) {
+            workers.push_back(std::async(std::launch::async, [&units, &run_unit, w, worker_count]() {
+                for (size_t u = w; u < units.size(); u += worker_count) {
+                    run_unit(units[u]);
+                }
+            }));
+        }
+        
+        // Wait for all workers
+        for (auto& worker : workers) {
+            worker.get();
+        }
+    } else {
+        // Sequential processing
+        for (const auto& unit : units) {
+            run_unit(unit);
+        }
+    }
+    
+    return results;
+}
+
+std::vector<std::vector<size_t>> CorePointDetector::plan_batch_units(const std::vector<cv::Mat>& images) const {
+    std::vector<std::vector<size_t>> units;
+    const size_t pack_size = params.packed_batch_size > 1 ? static_cast<size_t>(params.packed_batch_size) : 1;
+    
+    // Group packable images by size, keeping input order inside each group
+    std::map<std::pair<int, int>, std::vector<size_t>> size_groups;
+    
+    for (size_t i = 0; i < images.size(); ++i) {
+        const cv::Mat& image = images[i];
+        bool packable = pack_size > 1 && !image.empty() && image.type() == CV_8UC1 &&
+                        image.rows >= 101 && image.cols >= 101;
+        
+        if (packable) {
+            size_groups[{image.rows, image.cols}].push_back(i);
+        } else {
+            units.push_back({i}); // detect_core_point handles (and reports) everything else
+        }
+    }
+    
+    for (const auto& group : size_groups) {
+        const std::vector<size_t>& indices = group.second;
+        for (size_t start = 0; start < indices.size(); start += pack_size) {
+            size_t end = std::min(start + pack_size, indices.size());
+            units.emplace_back(indices.begin() + start, indices.begin() + end);
+        }
+    }
+    
+    return units;
+}
+
+void CorePointDetector::reflect_slot_padding(cv::Mat& tensor, int slot, int slot_rows, int pad) {
+    // Mirror the slot's edge rows into its padding (BORDER_REFLECT_101, OpenCV's default),
+    // so filters over the whole tensor produce the same interior as per-image calls
+    const size_t row_bytes = tensor.cols * tensor.elemSize();
+    const int first = slot * slot_rows + pad;
+    const int last = (slot + 1) * slot_rows - pad - 1;
+    
+    for (int k = 1; k <= pad; ++k) {
+        std::memcpy(tensor.ptr(first - k), tensor.ptr(first + k), row_bytes);
+        std::memcpy(tensor.ptr(last + k), tensor.ptr(last - k), row_bytes);
+    }
+}
+
+void CorePointDetector::detect_packed(const std::vector<cv::Mat>& images,
+                                      const std::vector<std::string>& filenames,
+                                      const std::vector<size_t>& indices,
+                                      std::vector<DetectionResult>& results) {
+    Timer batch_timer;
+    batch_timer.start();
+    
+    DetectionWorkspace& workspace = thread_workspace();
+    const size_t reallocations_before = workspace.reallocations;
+    const size_t simd_operations_before = workspace.simd_operations;
+    
+    const int count = static_cast<int>(indices.size());
+    const int rows = images[indices[0]].rows;
+    const int cols = images[indices[0]].cols;
+    const int pad = std::max({params.gaussian_kernel_size / 2, params.sobel_kernel_size / 2, 1});
+    const int slot_rows = rows + 2 * pad;
+    const cv::Size tensor_size(cols, slot_rows * count);
+    
+    auto interior = [&](const cv::Mat& tensor, int slot) {
+        return tensor.rowRange(slot * slot_rows + pad, slot * slot_rows + pad + rows);
+    };
+    
+    std::vector<float> quality(count);
+    cv::Mat processed;
+    cv::Mat orientation_field;
+    cv::Mat orientation_moments;
+    
+    try {
+        // Stage 1: Pack all images into one tensor (one slot per image, reflected padding rows)
+        Timer::profile_start("batch_pack");
+        cv::Mat packed = workspace.acquire(workspace.packed_input, tensor_size, CV_8U);
+        for (int b = 0; b < count; ++b) {
+            cv::Mat slot = interior(packed, b);
+            images[indices[b]].copyTo(slot);
+            reflect_slot_padding(packed, b, slot_rows, pad);
+        }
+        Timer::profile_stop("batch_pack");
+        
+        // Stage 2: One blur over the whole batch; contrast stretch stays per image
+        Timer::profile_start("preprocess");
+        processed = workspace.acquire(workspace.processed, tensor_size, CV_8U);
+        blur_image(packed, processed);
+        for (int b = 0; b < count; ++b) {
+            cv::Mat slot = interior(processed, b);
+            ImageKernels::normalize_min_max(slot);
+            ImageKernels::equalize_hist(slot);
+            reflect_slot_padding(processed, b, slot_rows, pad);
+        }
+        Timer::profile_stop("preprocess");
+        
+        // Stage 3: One Laplacian over the batch, scored per image
+        Timer::profile_start("quality_assessment");
+        cv::Mat laplacian = workspace.acquire(workspace.laplacian, tensor_size, CV_64F);
+        ImageKernels::laplacian(processed, laplacian);
+        for (int b = 0; b < count; ++b) {
+            quality[b] = score_image_quality(interior(processed, b), interior(laplacian, b));
+        }
+        Timer::profile_stop("quality_assessment");
+        
+        // Stage 4: One gradient + orientation sweep over the batch
+        Timer::profile_start("orientation_field");
+        orientation_field = compute_orientation_field(processed, 
+            needs_orientation_moments() ? &orientation_moments : nullptr);
+        Timer::profile_stop("orientation_field");
+    
+    } catch (const std::exception& e) {
+        for (size_t i : indices) {
+            results[i].clear();
+            results[i].error_message = "Exception during batch processing: " + std::string(e.what());
+            update_stats(results[i]);
+        }
+        Logger::error("Packed batch detection failed: " + std::string(e.what()));
+        return;
+    }
+    
+    // Shared stage cost is amortized over the images in the pack
+    const double shared_time_us = batch_timer.stop() / count;
+    
+    // Stage 5: Per-image core localization on views into the batch tensors
+    for (int b = 0; b < count; ++b) {
+        Timer image_timer;
+        image_timer.start();
+        
+        const size_t i = indices[b];
+        const std::string filename = (i < filenames.size()) ? filenames[i] : "";
+        DetectionResult& result = results[i];
+        result.clear();
+        result.overall_quality = quality[b];
+        
+        if (result.overall_quality < 0.2f) {
+            result.error_message = "Image quality too low for processing";
+        } else {
+            try {
+                if (params.export_orientation_blocks) {
+                    summarize_orientation_blocks(interior(orientation_moments, b), result);
+                }
+                cv::Mat moments = needs_orientation_moments() ? interior(orientation_moments, b) : cv::Mat();
+                locate_cores(images[i], interior(processed, b), interior(orientation_field, b), moments,
+                             filename, static_cast<int>(i), result);
+            } catch (const std::exception& e) {
+                result.error_message = "Exception during processing: " + std::string(e.what());
+                Logger::error("Core point detection failed: " + result.error_message);
+            }
+        }
+        
+        result.processing_time_us = static_cast<uint64_t>(shared_time_us + image_timer.stop());
+        update_stats(result);
+    }
+    
+    add_workspace_stats(workspace.reallocations - reallocations_before,
+                        workspace.simd_operations - simd_operations_before);
+}
+
+bool CorePointDetector::validate_roi_size(const ROI& roi) {
+    // ROI should always be exactly 101x101
+    return true; // Size is enforced by the array definition
+}
+
+bool CorePointDetector::validate_core_point(const CorePoint& point) {
+    return point.x >= 0 && point.y >= 0 && point.confidence >= 0.0f && point.confidence <= 1.0f;
+}
+
+void CorePointDetector::add_workspace_stats(size_t reallocations, size_t simd_operations) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    processing_stats.workspace_reallocations += reallocations;
+    processing_stats.simd_operations_used += simd_operations;
+}
+
+void CorePointDetector::update_stats(const DetectionResult& result) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    processing_stats.total_images_processed++;
+    
+    if (result.success) {
+        processing_stats.successful_detections++;
+        if (!result.core_points.empty()) {
+            processing_stats.average_confidence = 
+                (processing_stats.average_confidence * (processing_stats.successful_detections - 1) + 
+                 result.core_points[0].confidence) / processing_stats.successful_detections;
+        }
+    } else {
+        processing_stats.failed_detections++;
+    }
+    
+    processing_stats.average_processing_time_us = 
+        (processing_stats.average_processing_time_us * (processing_stats.total_images_processed - 1) + 
+         result.processing_time_us) / processing_stats.total_images_processed;
+}
@@ -1,152 +1,332 @@
-// CorePointDetector.h - SIMD-optimized core point detection 
-// Implementation placeholder 
-#pragma once
-
-#include <opencv2/opencv.hpp>
-#include <vector>
-#include <array>
-#include <immintrin.h> // For AVX2/SIMD instructions
-
-/**
- * Core point detection for fingerprint processing
- * Optimized for Linux/GitHub Codespaces with GCC SIMD support
- * Generates consistent 101x101 ROI extractions for database insertion
- */
-class CorePointDetector {
-public:
-    // Core data structures (matching master plan exactly)
-    struct CorePoint {
-        float x, y;                         // Center coordinates from original image
-        float confidence;                   // Detection confidence [0.0-1.0]
-        
-        CorePoint() : x(0), y(0), confidence(0) {}
-        CorePoint(float x_, float y_, float conf) : x(x_), y(y_), confidence(conf) {}
-    };
-
-    struct ROI {
-        uint8_t pixels[101][101];           // EXACTLY 101x101 extracted from original
-        std::string filename;               // Source file identifier
-        int32_t file_index;                 // Batch processing index
-        
-        ROI() : filename(""), file_index(-1) {
-            memset(pixels, 0, sizeof(pixels));
-        }
-    };
-
-    // Detection parameters
-    struct DetectionParams {
-        float min_confidence;               // Minimum confidence threshold [0.0-1.0]
-        int gaussian_kernel_size;           // Gaussian blur kernel size (odd number)
-        float gaussian_sigma;               // Gaussian blur sigma
-        int sobel_kernel_size;              // Sobel operator kernel size
-        int block_size;                     // Local analysis block size
-        float ridge_threshold;              // Ridge detection threshold
-        bool use_simd;                      // Enable SIMD optimizations
-        
-        DetectionParams() 
-            : min_confidence(0.3f)
-            , gaussian_kernel_size(5)
-            , gaussian_sigma(1.0f)
-            , sobel_kernel_size(3)
-            , block_size(16)
-            , ridge_threshold(0.5f)
-            , use_simd(true) {}
-    };
-
-    // Detection results
-    struct DetectionResult {
-        std::vector<CorePoint> core_points;
-        ROI extracted_roi;
-        float overall_quality;              // Overall image quality [0.0-1.0]
-        uint64_t processing_time_us;        // Processing time in microseconds
-        std::string error_message;          // Empty if successful
-        bool success;
-        
-        DetectionResult() : overall_quality(0), processing_time_us(0), success(false) {}
-    };
-
-private:
-    DetectionParams params;
-    
-    // SIMD capability detection
-    static bool simd_available;
-    static bool check_simd_support();
-    
-    // Core processing methods
-    cv::Mat preprocess_image(const cv::Mat& input);
-    cv::Mat compute_orientation_field(const cv::Mat& image);
-    cv::Mat compute_ridge_frequency(const cv::Mat& image);
-    std::vector<CorePoint> detect_core_candidates(const cv::Mat& orientation_field, 
-                                                 const cv::Mat& frequency_field);
-    
-    // SIMD-optimized processing
-    void compute_gradients_simd(const cv::Mat& image, cv::Mat& grad_x, cv::Mat& grad_y);
-    void compute_gradients_scalar(const cv::Mat& image, cv::Mat& grad_x, cv::Mat& grad_y);
-    
-    // Core point validation
-    float validate_core_point(const cv::Mat& orientation_field, 
-                             const cv::Mat& image, 
-                             const CorePoint& candidate);
-    
-    // ROI extraction
-    ROI extract_roi_around_point(const cv::Mat& image, 
-                                const CorePoint& core_point, 
-                                const std::string& filename,
-                                int file_index);
-    
-    // Quality assessment
-    float assess_image_quality(const cv::Mat& image);
-    float assess_roi_quality(const ROI& roi);
-    
-    // Utility methods
-    bool is_point_valid(const CorePoint& point, int image_width, int image_height);
-    CorePoint select_best_core_point(const std::vector<CorePoint>& candidates);
-
-public:
-    CorePointDetector(const DetectionParams& detection_params = DetectionParams());
-    
-    // Main detection interface
-    DetectionResult detect_core_point(const cv::Mat& image, 
-                                     const std::string& filename = "",
-                                     int file_index = -1);
-    
-    // Batch processing
-    std::vector<DetectionResult> detect_batch(const std::vector<cv::Mat>& images,
-                                             const std::vector<std::string>& filenames = {},
-                                             bool parallel = true);
-    
-    // Configuration
-    void set_parameters(const DetectionParams& new_params) { params = new_params; }
-    DetectionParams get_parameters() const { return params; }
-    
-    // Validation and testing
-    static bool validate_roi_size(const ROI& roi);
-    static bool validate_core_point(const CorePoint& point);
-    
-    // Statistics and debugging
-    struct ProcessingStats {
-        size_t total_images_processed;
-        size_t successful_detections;
-        size_t failed_detections;
-        double average_processing_time_us;
-        double average_confidence;
-        size_t simd_operations_used;
-        
-        ProcessingStats() : total_images_processed(0), successful_detections(0), 
-                          failed_detections(0), average_processing_time_us(0),
-                          average_confidence(0), simd_operations_used(0) {}
-    };
-    
-    ProcessingStats get_processing_stats() const { return processing_stats; }
-    void reset_processing_stats() { processing_stats = ProcessingStats(); }
-    
-    // System info
-    static bool is_simd_supported() { return check_simd_support(); }
-    static std::string get_system_info();
-
-private:
-    mutable ProcessingStats processing_stats;
-    
-    // Update statistics
-    void update_stats(const DetectionResult& result);
-};
+// CorePointDetector.h - SIMD-optimized core point detection 
+// Implementation placeholder 
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <immintrin.h> // For AVX2/SIMD instructions
+
+/**
+ * Core point detection for fingerprint processing
+ * Optimized for Linux/GitHub Codespaces with GCC SIMD support
+ * Generates consistent 101x101 ROI extractions for database insertion
+ */
+class CorePointDetector {
+public:
+    // Core data structures (matching master plan exactly)
+    struct CorePoint {
+        float x, y;                         // Center coordinates from original image
+        float confidence;                   // Detection confidence [0.0-1.0]
+        
+        CorePoint() : x(0), y(0), confidence(0) {}
+        CorePoint(float x_, float y_, float conf) : x(x_), y(y_), confidence(conf) {}
+    };
+    
+    // 128-bit perceptual hash of an ROI (see RoiHasher); all zero = not computed
+    struct RoiHash {
+        uint64_t bits[2];
+        
+        RoiHash() { bits[0] = bits[1] = 0; }
+        bool empty() const { return (bits[0] | bits[1]) == 0; }
+        bool operator==(const RoiHash& other) const { return bits[0] == other.bits[0] && bits[1] == other.bits[1]; }
+    };
+    
+    struct ROI {
+        uint8_t pixels[101][101];           // EXACTLY 101x101 extracted from original
+        std::string filename;               // Source file identifier
+        int32_t file_index;                 // Batch processing index
+        float rotation;                     // Normalization angle applied at extraction (radians, 0 = axis-aligned)
+        RoiHash hash;                       // Perceptual hash (DetectionParams::compute_roi_hash)
+        
+        ROI() : filename(""), file_index(-1), rotation(0) {
+            memset(pixels, 0, sizeof(pixels));
+        }
+        
+        // Zero-copy cv::Mat header over pixels (valid only while this ROI is alive)
+        cv::Mat as_mat() { return cv::Mat(101, 101, CV_8U, &pixels[0][0]); }
+        const cv::Mat as_mat() const { return cv::Mat(101, 101, CV_8U, const_cast<uint8_t*>(&pixels[0][0])); }
+    };
+
+    // Detection parameters
+    struct DetectionParams {
+        float min_confidence;               // Minimum confidence threshold [0.0-1.0]
+        int gaussian_kernel_size;           // Gaussian blur kernel size (odd number)
+        float gaussian_sigma;               // Gaussian blur sigma
+        int sobel_kernel_size;              // Sobel operator kernel size
+        int block_size;                     // Local analysis block size
+        float ridge_threshold;              // Ridge detection threshold
+        bool use_simd;                      // Enable SIMD optimizations
+        bool align_roi_orientation;         // Sub-pixel ROI sampling rotated to the dominant core orientation
+        int max_core_points;                // Cores to report (1 = best only, >1 = top-K after NMS)
+        float core_nms_radius;              // Minimum distance between reported cores (pixels)
+        int packed_batch_size;              // Same-size images packed into one tensor by detect_batch (0 = off)
+        bool export_orientation_blocks;     // Block orientation field and singular points in DetectionResult
+        bool compute_roi_hash;              // Perceptual hash of every extracted ROI (duplicate screening)
+        
+        DetectionParams() 
+            : min_confidence(0.3f)
+            , gaussian_kernel_size(5)
+            , gaussian_sigma(1.0f)
+            , sobel_kernel_size(3)
+            , block_size(16)
+            , ridge_threshold(0.5f)
+            , use_simd(true)
+            , align_roi_orientation(false)
+            , max_core_points(1)
+            , core_nms_radius(48.0f)
+            , packed_batch_size(0)
+            , export_orientation_blocks(false)
+            , compute_roi_hash(true) {}
+    };
+    
+    // Block-averaged orientation field (block_size x block_size blocks, row-major)
+    struct OrientationBlocks {
+        int block_size;
+        int cols, rows;                     // Number of blocks
+        std::vector<float> angle;           // Ridge orientation [-pi/2, pi/2)
+        std::vector<float> coherence;       // Orientation consistency [0.0-1.0]
+        std::vector<float> energy;          // Mean squared gradient magnitude (foreground indicator)
+        
+        OrientationBlocks() : block_size(0), cols(0), rows(0) {}
+        bool empty() const { return angle.empty(); }
+    };
+    
+    // Orientation-field singularity found by Poincare index on the block field
+    struct SingularPoint {
+        float x, y;                         // Centre in image coordinates
+        int poincare_index;                 // +1 core, -1 delta, +2 whorl centre (in half turns)
+        
+        SingularPoint() : x(0), y(0), poincare_index(0) {}
+        SingularPoint(float x_, float y_, int index) : x(x_), y(y_), poincare_index(index) {}
+    };
+    
+    // Detection results
+    struct DetectionResult {
+        std::vector<CorePoint> core_points;   // Sorted by confidence, best first
+        ROI extracted_roi;                  // ROI around core_points[0]
+        std::vector<ROI> secondary_rois;    // ROIs around core_points[1..] (multi-core mode)
+        OrientationBlocks orientation_blocks;       // Filled when export_orientation_blocks is set
+        std::vector<SingularPoint> singular_points; // Cores and deltas on orientation_blocks
+        float overall_quality;              // Overall image quality [0.0-1.0]
+        uint64_t processing_time_us;        // Processing time in microseconds
+        uint64_t content_hash;              // FileManager hash of the source file bytes (set by the caller, 0 = unknown)
+        std::string error_message;          // Empty if successful
+        bool success;
+        
+        DetectionResult() : overall_quality(0), processing_time_us(0), content_hash(0), success(false) {}
+        
+        // Back to the default-constructed state, keeping vector and string capacity
+        // so a result reused across detections does not reallocate
+        void clear() {
+            core_points.clear();
+            std::memset(extracted_roi.pixels, 0, sizeof(extracted_roi.pixels));
+            extracted_roi.filename.clear();
+            extracted_roi.file_index = -1;
+            extracted_roi.rotation = 0;
+            extracted_roi.hash = RoiHash();
+            secondary_rois.clear();
+            orientation_blocks.block_size = orientation_blocks.cols = orientation_blocks.rows = 0;
+            orientation_blocks.angle.clear();
+            orientation_blocks.coherence.clear();
+            orientation_blocks.energy.clear();
+            singular_points.clear();
+            overall_quality = 0;
+            processing_time_us = 0;
+            content_hash = 0;
+            error_message.clear();
+            success = false;
+        }
+    };
+    
+    // Reusable scratch buffers for one detection thread.
+    // Buffers only grow; smaller images reuse a top-left view of the existing allocation.
+    struct DetectionWorkspace {
+        struct SingularCluster {
+            float sum_x, sum_y;
+            int count, index;
+        };
+        
+        cv::Mat processed;                  // Preprocessed image (CV_8U)
+        cv::Mat grad_x;                     // Horizontal gradient (CV_32F)
+        cv::Mat grad_y;                     // Vertical gradient (CV_32F)
+        cv::Mat orientation;                // Orientation field (CV_32F)
+        cv::Mat frequency;                  // Ridge frequency field (CV_32F)
+        cv::Mat laplacian;                  // Sharpness scratch (CV_64F)
+        cv::Mat orientation_moments;        // Per-row gradient moments per block column (CV_32FC3)
+        cv::Mat packed_input;               // Batch tensor of packed input images (CV_8U)
+        cv::Mat blur_scratch;               // Gaussian blur intermediate rows (CV_32S)
+        std::vector<CorePoint> candidates;  // Core candidates of the current image
+        std::vector<CorePoint> ranked;      // Candidates by confidence, for non-maximum suppression
+        std::vector<CorePoint> selected;    // Cores kept after suppression and validation
+        std::vector<float> block_sums;      // Moment sums of one block row (orientation export)
+        std::vector<float> doubled_angles;  // Smoothed doubled block angles (singular points)
+        std::vector<uint8_t> foreground_blocks;
+        std::vector<SingularCluster> singular_clusters;
+        size_t reallocations;               // Number of times a buffer had to grow
+        size_t simd_operations;             // SIMD kernel invocations on this thread
+        
+        DetectionWorkspace() : reallocations(0), simd_operations(0) {}
+        
+        // Return a size x type view of buffer, growing the buffer only if it is too small
+        cv::Mat acquire(cv::Mat& buffer, const cv::Size& size, int type);
+        
+        // Combined capacity of the vector buffers; a change means one of them grew
+        size_t vector_capacity() const {
+            return candidates.capacity() + ranked.capacity() + selected.capacity() + block_sums.capacity() +
+                   doubled_angles.capacity() + foreground_blocks.capacity() + singular_clusters.capacity();
+        }
+    };
+
+private:
+    DetectionParams params;
+    
+    // SIMD capability detection
+    static bool simd_available;
+    static bool check_simd_support();
+    
+    // Per-thread scratch workspace shared by all detector instances on that thread
+    static DetectionWorkspace& thread_workspace();
+    
+    // Core processing methods
+    cv::Mat preprocess_image(const cv::Mat& input);
+    void blur_image(const cv::Mat& input, cv::Mat& output);
+    cv::Mat compute_orientation_field(const cv::Mat& image, cv::Mat* row_moments = nullptr);
+    void summarize_orientation_blocks(const cv::Mat& row_moments, DetectionResult& result);
+    // Block exports and ROI alignment both read the per-row moment sums
+    bool needs_orientation_moments() const { return params.export_orientation_blocks || params.align_roi_orientation; }
+    void find_singular_points(DetectionResult& result);
+    cv::Mat compute_ridge_frequency(const cv::Mat& image);
+    void locate_cores(const cv::Mat& image, 
+                     const cv::Mat& processed_image, 
+                     const cv::Mat& orientation_field,
+                     const cv::Mat& orientation_moments,
+                     const std::string& filename,
+                     int file_index,
+                     DetectionResult& result);
+    void detect_core_candidates(const cv::Mat& orientation_field, 
+                               const cv::Mat& frequency_field,
+                               std::vector<CorePoint>& candidates);
+    
+    // 3x3 Sobel through ImageKernels, other kernel sizes through OpenCV
+    void compute_gradients(const cv::Mat& image, cv::Mat& grad_x, cv::Mat& grad_y);
+    
+    // Core point validation
+    float validate_core_point(const cv::Mat& orientation_field, 
+                             const cv::Mat& image, 
+                             const CorePoint& candidate);
+    
+    // ROI extraction
+    // ROIs are written in place so a reused result keeps its filename buffers
+    void extract_core_roi(const cv::Mat& image, 
+                         const cv::Mat& orientation_moments,
+                         const CorePoint& core_point, 
+                         const std::string& filename,
+                         int file_index,
+                         ROI& roi);
+    void extract_roi_around_point(const cv::Mat& image, 
+                                 const CorePoint& core_point, 
+                                 const std::string& filename,
+                                 int file_index,
+                                 ROI& roi);
+    
+    // Sub-pixel, rotation-normalized ROI extraction
+    float estimate_dominant_orientation(const cv::Mat& orientation_moments, const CorePoint& core_point);
+    void extract_roi_subpixel(const cv::Mat& image, 
+                             const CorePoint& core_point, 
+                             float angle,
+                             const std::string& filename,
+                             int file_index,
+                             ROI& roi);
+    void sample_roi_rows_simd(const cv::Mat& image, float cx, float cy, float cos_a, float sin_a, ROI& roi);
+    void sample_roi_rows_scalar(const cv::Mat& image, float cx, float cy, float cos_a, float sin_a, ROI& roi);
+    
+    // Quality assessment
+    float assess_image_quality(const cv::Mat& image);
+    float score_image_quality(const cv::Mat& image, const cv::Mat& laplacian);
+    float assess_roi_quality(const ROI& roi);
+    
+    // Utility methods
+    bool is_point_valid(const CorePoint& point, int image_width, int image_height);
+    CorePoint select_best_core_point(const std::vector<CorePoint>& candidates);
+    void select_top_core_points(const std::vector<CorePoint>& candidates, size_t max_count,
+                                std::vector<CorePoint>& selected);
+    
+    // Packed batch processing (same-size images stacked into one tall tensor)
+    std::vector<std::vector<size_t>> plan_batch_units(const std::vector<cv::Mat>& images) const;
+    void detect_packed(const std::vector<cv::Mat>& images,
+                       const std::vector<std::string>& filenames,
+                       const std::vector<size_t>& indices,
+                       std::vector<DetectionResult>& results);
+    static void reflect_slot_padding(cv::Mat& tensor, int slot, int slot_rows, int pad);
+
+public:
+    CorePointDetector(const DetectionParams& detection_params = DetectionParams());
+    
+    // Main detection interface
+    DetectionResult detect_core_point(const cv::Mat& image, 
+                                     const std::string& filename = "",
+                                     int file_index = -1);
+    
+    // Same, into a caller-owned result that is cleared and reused. Once the thread's
+    // workspace and the result have grown to the image size, a call performs no heap
+    // allocation (secondary ROIs are rebuilt, so multi-core mode may still allocate)
+    void detect_core_point(const cv::Mat& image,
+                           DetectionResult& result,
+                           const std::string& filename = "",
+                           int file_index = -1);
+    
+    // Batch processing
+    std::vector<DetectionResult> detect_batch(const std::vector<cv::Mat>& images,
+                                             const std::vector<std::string>& filenames = {},
+                                             bool parallel = true);
+    
+    // Configuration
+    void set_parameters(const DetectionParams& new_params) { params = new_params; }
+    DetectionParams get_parameters() const { return params; }
+    
+    // Validation and testing
+    static bool validate_roi_size(const ROI& roi);
+    static bool validate_core_point(const CorePoint& point);
+    
+    // Statistics and debugging
+    struct ProcessingStats {
+        size_t total_images_processed;
+        size_t successful_detections;
+        size_t failed_detections;
+        double average_processing_time_us;
+        double average_confidence;
+        size_t simd_operations_used;
+        size_t workspace_reallocations;     // Scratch buffer growth events (0 in steady state)
+        
+        ProcessingStats() : total_images_processed(0), successful_detections(0), 
+                          failed_detections(0), average_processing_time_us(0),
+                          average_confidence(0), simd_operations_used(0),
+                          workspace_reallocations(0) {}
+    };
+    
+    // Safe to call while detect_batch workers are running
+    ProcessingStats get_processing_stats() const {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        return processing_stats;
+    }
+    void reset_processing_stats() {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        processing_stats = ProcessingStats();
+    }
+    
+    // System info
+    static bool is_simd_supported() { return check_simd_support(); }
+    static std::string get_system_info();
+
+private:
+    mutable std::mutex stats_mutex;         // detect_batch workers share one detector
+    ProcessingStats processing_stats;
+    
+    // Update statistics
+    void update_stats(const DetectionResult& result);
+    void add_workspace_stats(size_t reallocations, size_t simd_operations);
+};
@@ -1,2 +1,789 @@
-// FeatureExtractor.cpp - FeatureExtractor implementation 
-// Implementation placeholder 
+// FeatureExtractor.cpp - FeatureExtractor implementation 
+// Implementation placeholder 
+#include "FeatureExtractor.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef __AVX2__
+bool FeatureExtractor::simd_available = true;
+#else
+bool FeatureExtractor::simd_available = false;
+#endif
+
+namespace {
+
+constexpr uint64_t HIGH_WORD_MASK = (1ull << 37) - 1;   // Bits 64-100
+constexpr uint64_t HIGH_STEP_MASK = (1ull << 36) - 1;   // Bits 64-99: pairs (x, x+1) inside the row
+
+// 128-bit row shifts by one pixel; bits shifted past x=100 are dropped
+inline void shift_right(const uint64_t* in, uint64_t* out) {
+    out[0] = (in[0] >> 1) | (in[1] << 63);
+    out[1] = in[1] >> 1;
+}
+
+inline void shift_left(const uint64_t* in, uint64_t* out) {
+    out[1] = ((in[1] << 1) | (in[0] >> 63)) & HIGH_WORD_MASK;
+    out[0] = in[0] << 1;
+}
+
+inline uint64_t majority(uint64_t a, uint64_t b, uint64_t c) {
+    return (a & b) | (b & c) | (a & c);
+}
+
+inline int popcount2(uint64_t lo, uint64_t hi) {
+    return __builtin_popcountll(lo) + __builtin_popcountll(hi);
+}
+
+// Per-bit "how many of these words have the bit set" saturated at 2
+struct SaturatingCount {
+    uint64_t ones = 0;                      // At least one
+    uint64_t twos = 0;                      // At least two
+    
+    void add(uint64_t bits) {
+        twos |= ones & bits;
+        ones |= bits;
+    }
+    uint64_t exactly_one() const { return ones & ~twos; }
+};
+
+// Per-bit 3-bit counter (values 0-7), for crossing numbers up to 4
+struct BitSlicedCount {
+    uint64_t bit0 = 0, bit1 = 0, bit2 = 0;
+    
+    void add(uint64_t bits) {
+        uint64_t carry0 = bit0 & bits;
+        bit0 ^= bits;
+        uint64_t carry1 = bit1 & carry0;
+        bit1 ^= carry0;
+        bit2 |= carry1;
+    }
+    uint64_t equals(int value) const {
+        return ((value & 1) ? bit0 : ~bit0) & ((value & 2) ? bit1 : ~bit1) & ((value & 4) ? bit2 : ~bit2);
+    }
+};
+
+// Row words plus copies shifted so bit x holds the east (x+1) or west (x-1) neighbour.
+// One zero row of padding above and below removes the boundary checks.
+struct ShiftedRows {
+    uint64_t centre[FeatureExtractor::ROI_SIZE + 2][2];
+    uint64_t east[FeatureExtractor::ROI_SIZE + 2][2];
+    uint64_t west[FeatureExtractor::ROI_SIZE + 2][2];
+    
+    ShiftedRows() {
+        memset(centre, 0, sizeof(centre));
+        memset(east, 0, sizeof(east));
+        memset(west, 0, sizeof(west));
+    }
+    
+    void update(const FeatureExtractor::BinaryROI& binary) {
+        for (int y = 0; y < FeatureExtractor::ROI_SIZE; ++y) {
+            centre[y + 1][0] = binary.rows[y][0];
+            centre[y + 1][1] = binary.rows[y][1];
+            shift_right(binary.rows[y], east[y + 1]);
+            shift_left(binary.rows[y], west[y + 1]);
+        }
+    }
+    
+    // The 8 neighbours of the 64 pixels in word w of row y, as P2..P9 in Zhang-Suen order:
+    // P2 = N, P3 = NE, P4 = E, P5 = SE, P6 = S, P7 = SW, P8 = W, P9 = NW (0 outside the ROI)
+    void neighbours(int y, int w, uint64_t p[8]) const {
+        p[0] = centre[y][w];
+        p[1] = east[y][w];
+        p[2] = east[y + 1][w];
+        p[3] = east[y + 2][w];
+        p[4] = centre[y + 2][w];
+        p[5] = west[y + 2][w];
+        p[6] = west[y + 1][w];
+        p[7] = west[y][w];
+    }
+};
+
+// Zernike basis tabulated for the fixed 101x101 grid.
+// R_nm(rho) is radially symmetric and cos/sin(m theta) are even or odd under x and y
+// reflection, so each basis row is stored for one quadrant only (51x51, axis pixels
+// half weighted) and applied to the ROI folded into the matching reflection parity.
+struct ZernikeBasis {
+    static constexpr int HALF = FeatureExtractor::ROI_SIZE / 2;     // 50: centre pixel index
+    static constexpr int QUADRANT = HALF + 1;                        // 51 samples per axis
+    static constexpr int PIXELS = QUADRANT * QUADRANT;               // 2601
+    static constexpr int STRIDE = 2608;     // PIXELS rounded up to a multiple of 16 floats
+    static constexpr int COUNT = FeatureExtractor::ZernikeMoments::COUNT;
+    static constexpr int MAX_ORDER = FeatureExtractor::ZernikeMoments::MAX_ORDER;
+    
+    // Fold parity: bit 0 set = odd under x -> -x, bit 1 set = odd under y -> -y
+    int row_count;                          // 36 real + 30 imaginary (m > 0) rows
+    int real_row[COUNT];
+    int imag_row[COUNT];                    // -1 for m = 0
+    std::vector<int> row_parity;
+    std::vector<float> rows;                // row_count x STRIDE, zero padded
+    
+    // Batched layout: per parity class, the class's rows transposed to STRIDE x width
+    // (k-major, width padded to a multiple of 8) so a GEMM micro-kernel streams whole rows
+    int class_width[4];
+    std::vector<int> class_rows[4];         // Basis row behind each column
+    std::vector<float> packed[4];
+    
+    static_assert(STRIDE % 16 == 0 && STRIDE >= PIXELS, "basis rows are swept 16 floats at a time");
+    
+    ZernikeBasis() : row_count(0) {
+        // Pixel centres inside the disc of radius 50.5; each covers 1/r^2 of the unit disc
+        const double radius = FeatureExtractor::ROI_SIZE / 2.0;
+        const double pixel_area = 1.0 / (radius * radius);
+        
+        double factorial[MAX_ORDER + 1];
+        factorial[0] = 1.0;
+        for (int i = 1; i <= MAX_ORDER; ++i) factorial[i] = factorial[i - 1] * i;
+        
+        for (int n = 0; n <= MAX_ORDER; ++n) {
+            for (int m = n % 2; m <= n; m += 2) {
+                int k = FeatureExtractor::ZernikeMoments::index(n, m);
+                // cos(m theta): even in y, x parity (-1)^m; sin(m theta): odd in y, x parity -(-1)^m
+                real_row[k] = row_count++;
+                row_parity.push_back(m % 2);
+                imag_row[k] = -1;
+                if (m > 0) {
+                    imag_row[k] = row_count++;
+                    row_parity.push_back(2 | (1 - m % 2));
+                }
+            }
+        }
+        rows.assign(static_cast<size_t>(row_count) * STRIDE, 0.0f);
+        
+        for (int n = 0; n <= MAX_ORDER; ++n) {
+            for (int m = n % 2; m <= n; m += 2) {
+                int k = FeatureExtractor::ZernikeMoments::index(n, m);
+                float* real = &rows[static_cast<size_t>(real_row[k]) * STRIDE];
+                float* imag = imag_row[k] >= 0 ? &rows[static_cast<size_t>(imag_row[k]) * STRIDE] : nullptr;
+                const double scale = (n + 1) / M_PI * pixel_area;
+                
+                for (int qy = 0; qy < QUADRANT; ++qy) {
+                    for (int qx = 0; qx < QUADRANT; ++qx) {
+                        double dx = qx / radius;
+                        double dy = qy / radius;
+                        double rho = std::sqrt(dx * dx + dy * dy);
+                        if (rho > 1.0) continue;
+                        
+                        // Radial polynomial R_nm(rho)
+                        double radial = 0.0;
+                        for (int j = 0; j <= (n - m) / 2; ++j) {
+                            double term = factorial[n - j] / 
+                                (factorial[j] * factorial[(n + m) / 2 - j] * factorial[(n - m) / 2 - j]);
+                            radial += ((j % 2) ? -term : term) * std::pow(rho, n - 2 * j);
+                        }
+                        
+                        // Axis pixels appear twice in the fold (once per side)
+                        double weight = (qx == 0 ? 0.5 : 1.0) * (qy == 0 ? 0.5 : 1.0);
+                        
+                        // Z_nm = (n+1)/pi * sum f R_nm e^{-i m theta}
+                        double theta = std::atan2(dy, dx);
+                        int pixel = qy * QUADRANT + qx;
+                        real[pixel] = static_cast<float>(weight * scale * radial * std::cos(m * theta));
+                        if (imag) imag[pixel] = static_cast<float>(-weight * scale * radial * std::sin(m * theta));
+                    }
+                }
+            }
+        }
+        
+        for (int row = 0; row < row_count; ++row) {
+            class_rows[row_parity[row]].push_back(row);
+        }
+        for (int p = 0; p < 4; ++p) {
+            class_width[p] = (static_cast<int>(class_rows[p].size()) + 7) / 8 * 8;
+            packed[p].assign(static_cast<size_t>(STRIDE) * class_width[p], 0.0f);
+            for (size_t j = 0; j < class_rows[p].size(); ++j) {
+                const float* source = &rows[static_cast<size_t>(class_rows[p][j]) * STRIDE];
+                for (int k = 0; k < STRIDE; ++k) {
+                    packed[p][static_cast<size_t>(k) * class_width[p] + j] = source[k];
+                }
+            }
+        }
+    }
+    
+    // Fold the ROI (scaled to [0, 1]) into the four parity classes:
+    // folds[p][qy][qx] = sum over reflections of sign_p * f(HALF +- qx, HALF -+ qy)
+    static void fold(const FeatureExtractor::ROI& roi, float* const folds[4]) {
+        const float inv_255 = 1.0f / 255.0f;
+        for (int qy = 0; qy < QUADRANT; ++qy) {
+            const uint8_t* upper = roi.pixels[HALF - qy];       // +y is up
+            const uint8_t* lower = roi.pixels[HALF + qy];
+            for (int qx = 0; qx < QUADRANT; ++qx) {
+                float a = upper[HALF + qx] * inv_255;   // ( x,  y)
+                float b = upper[HALF - qx] * inv_255;   // (-x,  y)
+                float c = lower[HALF + qx] * inv_255;   // ( x, -y)
+                float d = lower[HALF - qx] * inv_255;   // (-x, -y)
+                int pixel = qy * QUADRANT + qx;
+                folds[0][pixel] = (a + b) + (c + d);
+                folds[1][pixel] = (a - b) + (c - d);
+                folds[2][pixel] = (a + b) - (c + d);
+                folds[3][pixel] = (a - b) - (c - d);
+            }
+        }
+        for (int p = 0; p < 4; ++p) {
+            for (int pixel = PIXELS; pixel < STRIDE; ++pixel) folds[p][pixel] = 0.0f;
+        }
+    }
+};
+
+#ifdef __AVX2__
+// C[ROWS x 8*VECTORS] += A[ROWS x kc] * B[kc x 8*VECTORS]; A rows are a_stride apart, B rows b_stride.
+// ROWS x VECTORS accumulators plus VECTORS basis registers fit the 16 ymm registers.
+template <int ROWS, int VECTORS>
+inline void zernike_gemm_kernel(const float* a, int a_stride, const float* b, int b_stride, int kc, 
+                                float* c, int c_stride) {
+    __m256 acc[ROWS][VECTORS];
+    for (int r = 0; r < ROWS; ++r) {
+        for (int v = 0; v < VECTORS; ++v) acc[r][v] = _mm256_loadu_ps(c + r * c_stride + v * 8);
+    }
+    
+    for (int k = 0; k < kc; ++k) {
+        __m256 basis[VECTORS];
+        for (int v = 0; v < VECTORS; ++v) basis[v] = _mm256_loadu_ps(b + k * b_stride + v * 8);
+        for (int r = 0; r < ROWS; ++r) {
+            __m256 value = _mm256_broadcast_ss(a + r * a_stride + k);
+            for (int v = 0; v < VECTORS; ++v) acc[r][v] = _mm256_fmadd_ps(value, basis[v], acc[r][v]);
+        }
+    }
+    
+    for (int r = 0; r < ROWS; ++r) {
+        for (int v = 0; v < VECTORS; ++v) _mm256_storeu_ps(c + r * c_stride + v * 8, acc[r][v]);
+    }
+}
+#endif
+
+const ZernikeBasis& zernike_basis() {
+    static const ZernikeBasis basis;
+    return basis;
+}
+
+} // namespace
+
+FeatureExtractor::FeatureExtractor(const ExtractionParams& extraction_params) 
+    : params(extraction_params) {
+    
+    if (params.use_simd && !simd_available) {
+        params.use_simd = false;
+        Logger::info("SIMD requested but not available, using scalar feature extraction");
+    }
+    
+    // Tabulate the Zernike basis now rather than on the first ROI
+    initialize_zernike_basis();
+}
+
+void FeatureExtractor::binarize(const ROI& roi, BinaryROI& binary) const {
+    if (params.use_simd && simd_available) {
+        binarize_simd(roi, binary);
+    } else {
+        binarize_scalar(roi, binary);
+    }
+}
+
+void FeatureExtractor::binarize_simd(const ROI& roi, BinaryROI& binary) const {
+#ifdef __AVX2__
+    const uint8_t* pixels = &roi.pixels[0][0];
+    constexpr int total = ROI_SIZE * ROI_SIZE;
+    
+    // Mean via SAD against zero: 32 pixels per instruction
+    __m256i zero = _mm256_setzero_si256();
+    __m256i sums = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= total; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i));
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(v, zero));
+    }
+    uint64_t sum = static_cast<uint64_t>(_mm256_extract_epi64(sums, 0)) + _mm256_extract_epi64(sums, 1) + 
+                   _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3);
+    for (; i < total; ++i) sum += pixels[i];
+    
+    binary.threshold = static_cast<uint8_t>((sum + total / 2) / total);
+    __m256i threshold = _mm256_set1_epi8(static_cast<char>(binary.threshold));
+    
+    // Ridge = pixel < threshold, i.e. max(pixel, threshold) != pixel.
+    // Each row is covered by loads at 0, 32, 64 and 69; the last load ends exactly at x=100,
+    // so the final row never reads past the ROI.
+    for (int y = 0; y < ROI_SIZE; ++y) {
+        const uint8_t* row = pixels + y * ROI_SIZE;
+        uint32_t masks[4];
+        const int offsets[4] = {0, 32, 64, 69};
+        for (int k = 0; k < 4; ++k) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + offsets[k]));
+            __m256i not_ridge = _mm256_cmpeq_epi8(_mm256_max_epu8(v, threshold), v);
+            masks[k] = ~static_cast<uint32_t>(_mm256_movemask_epi8(not_ridge));
+        }
+        binary.rows[y][0] = static_cast<uint64_t>(masks[0]) | (static_cast<uint64_t>(masks[1]) << 32);
+        binary.rows[y][1] = (static_cast<uint64_t>(masks[2]) | (static_cast<uint64_t>(masks[3] >> 27) << 32)) & 
+                            HIGH_WORD_MASK;
+    }
+#else
+    binarize_scalar(roi, binary);
+#endif
+}
+
+void FeatureExtractor::binarize_scalar(const ROI& roi, BinaryROI& binary) const {
+    uint64_t sum = 0;
+    for (int y = 0; y < ROI_SIZE; ++y) {
+        for (int x = 0; x < ROI_SIZE; ++x) {
+            sum += roi.pixels[y][x];
+        }
+    }
+    constexpr int total = ROI_SIZE * ROI_SIZE;
+    binary.threshold = static_cast<uint8_t>((sum + total / 2) / total);
+    
+    for (int y = 0; y < ROI_SIZE; ++y) {
+        binary.rows[y][0] = 0;
+        binary.rows[y][1] = 0;
+        for (int x = 0; x < ROI_SIZE; ++x) {
+            if (roi.pixels[y][x] < binary.threshold) {
+                binary.rows[y][x >> 6] |= 1ull << (x & 63);
+            }
+        }
+    }
+}
+
+FeatureExtractor::RidgeDensity FeatureExtractor::compute_ridge_density(const ROI& roi) const {
+    BinaryROI binary;
+    binarize(roi, binary);
+    return compute_ridge_density(binary);
+}
+
+FeatureExtractor::RidgeDensity FeatureExtractor::compute_ridge_density(const BinaryROI& binary) const {
+    RidgeDensity density;
+    
+    // Horizontal scanlines: one bit-parallel pass per row.
+    // A transition between x and x+1 is bit x of (row ^ row >> 1).
+    int horizontal_transitions = 0;
+    int ridge_pixels = 0;
+    for (int y = 0; y < ROI_SIZE; ++y) {
+        uint64_t row[2] = {binary.rows[y][0], binary.rows[y][1]};
+        ridge_pixels += popcount2(row[0], row[1]);
+        
+        if (params.denoise) {
+            // Drop 1-pixel specks and close 1-pixel gaps along the scanline
+            uint64_t left[2], right[2];
+            shift_left(row, left);
+            shift_right(row, right);
+            row[0] = majority(left[0], row[0], right[0]);
+            row[1] = majority(left[1], row[1], right[1]);
+        }
+        
+        uint64_t next[2];
+        shift_right(row, next);
+        horizontal_transitions += popcount2(row[0] ^ next[0], (row[1] ^ next[1]) & HIGH_STEP_MASK);
+    }
+    
+    // Vertical scanlines: all 101 columns at once, comparing consecutive row words
+    int vertical_transitions = 0;
+    uint64_t previous[2] = {0, 0};
+    for (int y = 0; y < ROI_SIZE; ++y) {
+        uint64_t current[2] = {binary.rows[y][0], binary.rows[y][1]};
+        
+        if (params.denoise && y > 0 && y < ROI_SIZE - 1) {
+            for (int w = 0; w < 2; ++w) {
+                current[w] = majority(binary.rows[y - 1][w], binary.rows[y][w], binary.rows[y + 1][w]);
+            }
+        }
+        
+        if (y > 0) {
+            vertical_transitions += popcount2(previous[0] ^ current[0], previous[1] ^ current[1]);
+        }
+        previous[0] = current[0];
+        previous[1] = current[1];
+    }
+    
+    // Each ridge crossed produces two transitions (enter and leave)
+    constexpr float scan_length = static_cast<float>(ROI_SIZE * (ROI_SIZE - 1));
+    density.horizontal_rate = horizontal_transitions * 0.5f / scan_length;
+    density.vertical_rate = vertical_transitions * 0.5f / scan_length;
+    
+    // For locally parallel ridges with unit normal n and frequency f, the row and column
+    // crossing rates are f|n.x| and f|n.y|, so f is orientation independent:
+    density.ridges_per_pixel = std::sqrt(density.horizontal_rate * density.horizontal_rate + 
+                                         density.vertical_rate * density.vertical_rate);
+    density.ridge_period = density.ridges_per_pixel > 0 ? 1.0f / density.ridges_per_pixel : 0.0f;
+    density.ridge_fraction = static_cast<float>(ridge_pixels) / (ROI_SIZE * ROI_SIZE);
+    
+    return density;
+}
+
+void FeatureExtractor::smooth(BinaryROI& binary) {
+    // Horizontal 3-tap majority per row, then vertical 3-tap majority across rows
+    uint64_t horizontal[ROI_SIZE][2];
+    for (int y = 0; y < ROI_SIZE; ++y) {
+        uint64_t left[2], right[2];
+        shift_left(binary.rows[y], left);
+        shift_right(binary.rows[y], right);
+        horizontal[y][0] = majority(left[0], binary.rows[y][0], right[0]);
+        horizontal[y][1] = majority(left[1], binary.rows[y][1], right[1]);
+    }
+    
+    for (int y = 0; y < ROI_SIZE; ++y) {
+        const uint64_t* up = horizontal[y > 0 ? y - 1 : y];
+        const uint64_t* down = horizontal[y < ROI_SIZE - 1 ? y + 1 : y];
+        binary.rows[y][0] = majority(up[0], horizontal[y][0], down[0]);
+        binary.rows[y][1] = majority(up[1], horizontal[y][1], down[1]);
+    }
+}
+
+int FeatureExtractor::thin(BinaryROI& binary) const {
+    ShiftedRows shifted;
+    uint64_t remove[ROI_SIZE][2];
+    
+    int passes = 0;
+    bool changed = true;
+    while (changed && passes < params.max_thinning_iterations) {
+        changed = false;
+        ++passes;
+        
+        for (int step = 0; step < 2; ++step) {
+            // Zhang-Suen rule evaluated for 64 pixels per word; decisions use the
+            // image as it was at the start of the subiteration
+            shifted.update(binary);
+            for (int y = 0; y < ROI_SIZE; ++y) {
+                for (int w = 0; w < 2; ++w) {
+                    uint64_t p[8];
+                    shifted.neighbours(y, w, p);
+                    
+                    SaturatingCount set, unset, transitions;
+                    for (int i = 0; i < 8; ++i) {
+                        set.add(p[i]);
+                        unset.add(~p[i]);
+                        transitions.add(~p[i] & p[(i + 1) & 7]);
+                    }
+                    
+                    // A(P) == 1 (implies B(P) >= 1), B(P) != 1, and at least two background neighbours (B(P) <= 6)
+                    uint64_t removable = binary.rows[y][w] & transitions.exactly_one() & 
+                                         ~set.exactly_one() & unset.twos;
+                    
+                    const uint64_t n = p[0], e = p[2], s = p[4], wst = p[6];
+                    if (step == 0) {
+                        removable &= ~(n & e & s) & ~(e & s & wst);
+                    } else {
+                        removable &= ~(n & e & wst) & ~(n & s & wst);
+                    }
+                    remove[y][w] = removable;
+                }
+            }
+            
+            for (int y = 0; y < ROI_SIZE; ++y) {
+                if (remove[y][0] | remove[y][1]) {
+                    binary.rows[y][0] &= ~remove[y][0];
+                    binary.rows[y][1] &= ~remove[y][1];
+                    changed = true;
+                }
+            }
+        }
+    }
+    
+    return passes;
+}
+
+FeatureExtractor::MinutiaeResult FeatureExtractor::extract_minutiae(const ROI& roi) const {
+    BinaryROI binary;
+    binarize(roi, binary);
+    return extract_minutiae(binary);
+}
+
+FeatureExtractor::MinutiaeResult FeatureExtractor::extract_minutiae(const BinaryROI& binary) const {
+    MinutiaeResult result;
+    
+    BinaryROI skeleton = binary;
+    if (params.denoise) {
+        smooth(skeleton);
+    }
+    result.thinning_iterations = thin(skeleton);
+    
+    const int border = std::max(1, std::min(params.minutiae_border, ROI_SIZE / 2 - 1));
+    ShiftedRows shifted;
+    shifted.update(skeleton);
+    
+    for (int y = 0; y < ROI_SIZE; ++y) {
+        for (int w = 0; w < 2; ++w) {
+            result.skeleton_pixels += __builtin_popcountll(skeleton.rows[y][w]);
+            if (y < border || y >= ROI_SIZE - border || skeleton.rows[y][w] == 0) continue;
+            
+            // Crossing number = 0->1 transitions around P2..P9,P2
+            uint64_t p[8];
+            shifted.neighbours(y, w, p);
+            BitSlicedCount crossings;
+            for (int i = 0; i < 8; ++i) {
+                crossings.add(~p[i] & p[(i + 1) & 7]);
+            }
+            
+            uint64_t endings = skeleton.rows[y][w] & crossings.equals(1);
+            uint64_t bifurcations = skeleton.rows[y][w] & crossings.equals(3);
+            uint64_t minutiae = endings | bifurcations;
+            while (minutiae) {
+                int bit = __builtin_ctzll(minutiae);
+                minutiae &= minutiae - 1;
+                
+                int x = w * 64 + bit;
+                if (x < border || x >= ROI_SIZE - border) continue;
+                
+                if ((endings >> bit) & 1u) {
+                    result.minutiae.emplace_back(x, y, MinutiaType::ENDING);
+                    ++result.endings;
+                } else {
+                    result.minutiae.emplace_back(x, y, MinutiaType::BIFURCATION);
+                    ++result.bifurcations;
+                }
+            }
+        }
+    }
+    
+    const int inner = ROI_SIZE - 2 * border;
+    result.density = 1000.0f * result.minutiae.size() / static_cast<float>(inner * inner);
+    
+    return result;
+}
+
+FeatureExtractor::PatternClassification FeatureExtractor::classify_pattern(const CorePointDetector::DetectionResult& result) {
+    PatternClassification classification;
+    const auto& blocks = result.orientation_blocks;
+    if (blocks.empty()) return classification;
+    
+    const CorePointDetector::SingularPoint* core = nullptr;
+    std::vector<const CorePointDetector::SingularPoint*> deltas;
+    for (const auto& point : result.singular_points) {
+        if (point.poincare_index > 0) {
+            classification.cores += point.poincare_index;
+            if (!core) core = &point;
+        } else {
+            classification.deltas += -point.poincare_index;
+            deltas.push_back(&point);
+        }
+    }
+    
+    // Orientation quality: coherence weighted by gradient energy, so background blocks barely count
+    double weighted_coherence = 0.0, total_energy = 0.0;
+    for (size_t i = 0; i < blocks.coherence.size(); ++i) {
+        weighted_coherence += blocks.coherence[i] * blocks.energy[i];
+        total_energy += blocks.energy[i];
+    }
+    const float quality = total_energy > 0 ? static_cast<float>(weighted_coherence / total_energy) : 0.0f;
+    
+    if (classification.cores == 0 && classification.deltas == 0) {
+        classification.type = PatternType::ARCH;
+        classification.confidence = quality;
+    } else if (classification.cores >= 2) {
+        // Complete whorls show two deltas; fewer usually means the deltas fell outside the print
+        classification.type = PatternType::WHORL;
+        classification.confidence = classification.deltas >= 2 ? quality : 0.75f * quality;
+    } else if (classification.cores == 1 && !deltas.empty()) {
+        // Loop side from the nearest delta: it lies opposite the side the ridges open to
+        const CorePointDetector::SingularPoint* delta = deltas[0];
+        float best_distance = std::hypot(delta->x - core->x, delta->y - core->y);
+        for (const auto* candidate : deltas) {
+            float distance = std::hypot(candidate->x - core->x, candidate->y - core->y);
+            if (distance < best_distance) {
+                best_distance = distance;
+                delta = candidate;
+            }
+        }
+        
+        float dx = delta->x - core->x;
+        if (std::abs(dx) < 0.25f * best_distance) {
+            classification.type = PatternType::TENTED_ARCH;
+        } else {
+            classification.type = dx > 0 ? PatternType::LEFT_LOOP : PatternType::RIGHT_LOOP;
+        }
+        classification.confidence = classification.deltas == 1 ? quality : 0.75f * quality;
+    }
+    // A lone core or lone deltas cannot be told apart without the missing point: UNKNOWN
+    
+    return classification;
+}
+
+const char* FeatureExtractor::pattern_name(PatternType type) {
+    switch (type) {
+        case PatternType::ARCH:         return "arch";
+        case PatternType::TENTED_ARCH:  return "tented_arch";
+        case PatternType::LEFT_LOOP:    return "left_loop";
+        case PatternType::RIGHT_LOOP:   return "right_loop";
+        case PatternType::WHORL:        return "whorl";
+        default:                        return "unknown";
+    }
+}
+
+void FeatureExtractor::initialize_zernike_basis() {
+    zernike_basis();
+}
+
+FeatureExtractor::ZernikeMoments FeatureExtractor::compute_zernike_moments(const ROI& roi) const {
+    const ZernikeBasis& basis = zernike_basis();
+    constexpr int stride = ZernikeBasis::STRIDE;
+    
+    alignas(32) float folds[4][stride];
+    float* const fold_rows[4] = {folds[0], folds[1], folds[2], folds[3]};
+    ZernikeBasis::fold(roi, fold_rows);
+    float dots[2 * ZernikeMoments::COUNT];
+    
+    if (params.use_simd && simd_available) {
+#ifdef __AVX2__
+        for (int row = 0; row < basis.row_count; row += 2) {
+            // Two basis rows per sweep (each against its own fold)
+            const int second = std::min(row + 1, basis.row_count - 1);
+            const float* r0 = &basis.rows[static_cast<size_t>(row) * stride];
+            const float* r1 = &basis.rows[static_cast<size_t>(second) * stride];
+            const float* f0 = folds[basis.row_parity[row]];
+            const float* f1 = folds[basis.row_parity[second]];
+            
+            __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+            __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+            for (int p = 0; p < stride; p += 16) {
+                acc0 = _mm256_fmadd_ps(_mm256_load_ps(f0 + p), _mm256_loadu_ps(r0 + p), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_load_ps(f1 + p), _mm256_loadu_ps(r1 + p), acc1);
+                acc2 = _mm256_fmadd_ps(_mm256_load_ps(f0 + p + 8), _mm256_loadu_ps(r0 + p + 8), acc2);
+                acc3 = _mm256_fmadd_ps(_mm256_load_ps(f1 + p + 8), _mm256_loadu_ps(r1 + p + 8), acc3);
+            }
+            
+            const __m256 acc[2] = {_mm256_add_ps(acc0, acc2), _mm256_add_ps(acc1, acc3)};
+            for (int g = 0; g < 2 && row + g < basis.row_count; ++g) {
+                __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc[g]), _mm256_extractf128_ps(acc[g], 1));
+                sum = _mm_hadd_ps(sum, sum);
+                sum = _mm_hadd_ps(sum, sum);
+                dots[row + g] = _mm_cvtss_f32(sum);
+            }
+        }
+#endif
+    } else {
+        for (int row = 0; row < basis.row_count; ++row) {
+            const float* r = &basis.rows[static_cast<size_t>(row) * stride];
+            const float* f = folds[basis.row_parity[row]];
+            float sum = 0.0f;
+            for (int p = 0; p < stride; ++p) sum += f[p] * r[p];
+            dots[row] = sum;
+        }
+    }
+    
+    ZernikeMoments moments;
+    for (int k = 0; k < ZernikeMoments::COUNT; ++k) {
+        moments.real[k] = dots[basis.real_row[k]];
+        moments.imag[k] = basis.imag_row[k] >= 0 ? dots[basis.imag_row[k]] : 0.0f;
+        moments.magnitude[k] = std::sqrt(moments.real[k] * moments.real[k] + moments.imag[k] * moments.imag[k]);
+    }
+    return moments;
+}
+
+void FeatureExtractor::compute_zernike_moments_batch(const ROI* rois, size_t count, ZernikeMoments* moments) const {
+#ifdef __AVX2__
+    if (params.use_simd && simd_available && count > 1) {
+        const ZernikeBasis& basis = zernike_basis();
+        constexpr int stride = ZernikeBasis::STRIDE;
+        constexpr int chunk = 64;           // ROIs per GEMM (4 x 64 x 2608 floats of folded input)
+        constexpr int k_block = 256;        // Basis block of k_block x 24 floats stays in L1
+        
+        // Folded batch [class][roi][k] and results [class][roi][column], reused across calls
+        thread_local std::vector<float> folded;
+        thread_local std::vector<float> products;
+        folded.resize(static_cast<size_t>(4) * chunk * stride);
+        
+        int total_width = 0;
+        int column_offset[4];
+        for (int p = 0; p < 4; ++p) {
+            column_offset[p] = total_width * chunk;
+            total_width += basis.class_width[p];
+        }
+        products.resize(static_cast<size_t>(total_width) * chunk);
+        
+        for (size_t start = 0; start < count; start += chunk) {
+            const int batch = static_cast<int>(std::min<size_t>(chunk, count - start));
+            const int padded = (batch + 3) / 4 * 4;
+            
+            // Lay the batch out contiguously, one row per ROI in each parity class
+            for (int i = 0; i < padded; ++i) {
+                float* rows[4];
+                for (int p = 0; p < 4; ++p) rows[p] = &folded[(static_cast<size_t>(p) * chunk + i) * stride];
+                if (i < batch) {
+                    ZernikeBasis::fold(rois[start + i], rows);
+                } else {
+                    for (int p = 0; p < 4; ++p) std::fill(rows[p], rows[p] + stride, 0.0f);
+                }
+            }
+            std::fill(products.begin(), products.end(), 0.0f);
+            
+            // Per class: [padded x stride] x [stride x width], blocked over k then 4-ROI row panels
+            for (int p = 0; p < 4; ++p) {
+                const int width = basis.class_width[p];
+                const float* a = &folded[static_cast<size_t>(p) * chunk * stride];
+                float* c = &products[column_offset[p]];
+                
+                for (int k0 = 0; k0 < stride; k0 += k_block) {
+                    const int kc = std::min(k_block, stride - k0);
+                    const float* b = &basis.packed[p][static_cast<size_t>(k0) * width];
+                    
+                    // 4-ROI row panels against the class's whole width (24 or 16 columns)
+                    for (int i = 0; i < padded; i += 4) {
+                        const float* a_panel = a + static_cast<size_t>(i) * stride + k0;
+                        float* c_panel = c + static_cast<size_t>(i) * width;
+                        for (int j = 0; j < width; ) {
+                            if (width - j >= 24) {
+                                zernike_gemm_kernel<4, 3>(a_panel, stride, b + j, width, kc, c_panel + j, width);
+                                j += 24;
+                            } else if (width - j >= 16) {
+                                zernike_gemm_kernel<4, 2>(a_panel, stride, b + j, width, kc, c_panel + j, width);
+                                j += 16;
+                            } else {
+                                zernike_gemm_kernel<4, 1>(a_panel, stride, b + j, width, kc, c_panel + j, width);
+                                j += 8;
+                            }
+                        }
+                    }
+                }
+            }
+            
+            for (int i = 0; i < batch; ++i) {
+                float dots[2 * ZernikeMoments::COUNT];
+                for (int p = 0; p < 4; ++p) {
+                    const float* c = &products[column_offset[p] + static_cast<size_t>(i) * basis.class_width[p]];
+                    for (size_t j = 0; j < basis.class_rows[p].size(); ++j) {
+                        dots[basis.class_rows[p][j]] = c[j];
+                    }
+                }
+                
+                ZernikeMoments& out = moments[start + i];
+                for (int k = 0; k < ZernikeMoments::COUNT; ++k) {
+                    out.real[k] = dots[basis.real_row[k]];
+                    out.imag[k] = basis.imag_row[k] >= 0 ? dots[basis.imag_row[k]] : 0.0f;
+                    out.magnitude[k] = std::sqrt(out.real[k] * out.real[k] + out.imag[k] * out.imag[k]);
+                }
+            }
+        }
+        return;
+    }
+#endif
+    
+    for (size_t i = 0; i < count; ++i) {
+        moments[i] = compute_zernike_moments(rois[i]);
+    }
+}
+
+std::vector<FeatureExtractor::ZernikeMoments> FeatureExtractor::compute_zernike_moments_batch(const std::vector<ROI>& rois) const {
+    std::vector<ZernikeMoments> moments(rois.size());
+    compute_zernike_moments_batch(rois.data(), rois.size(), moments.data());
+    return moments;
+}
+
+FeatureExtractor::FeatureVector FeatureExtractor::make_feature_vector(const RidgeDensity& ridge,
+                                                                     const MinutiaeResult& minutiae,
+                                                                     const ZernikeMoments& zernike) {
+    FeatureVector vector;
+    float* v = vector.values;
+    
+    // Ridge rates are around 0.1 per pixel, minutiae density a few per 1000 pixels
+    v[0] = ridge.ridges_per_pixel * 8.0f;
+    v[1] = ridge.horizontal_rate * 8.0f;
+    v[2] = ridge.vertical_rate * 8.0f;
+    v[3] = ridge.ridge_fraction;
+    v[4] = minutiae.density * 0.1f;
+    
+    int total = minutiae.endings + minutiae.bifurcations;
+    v[5] = total > 0 ? static_cast<float>(minutiae.bifurcations) / total : 0.0f;
+    
+    // |Z_nm| / |Z00| is invariant to rotation and to ROI brightness
+    const float z00 = zernike.magnitude[ZernikeMoments::index(0, 0)];
+    const float scale = z00 > 0 ? 1.0f / z00 : 0.0f;
+    for (int i = 1; i < ZernikeMoments::COUNT; ++i) {
+        v[5 + i] = zernike.magnitude[i] * scale;
+    }
+    return vector;
+}
@@ -1,2 +1,179 @@
-// FeatureExtractor.h - CPU-based feature extraction 
-// Implementation placeholder 
+// FeatureExtractor.h - CPU-based feature extraction 
+// Implementation placeholder 
+#pragma once
+
+#include "CorePointDetector.h"
+#include <cstdint>
+#include <vector>
+#include <immintrin.h> // For AVX2/SIMD instructions
+
+/**
+ * Feature extraction on 101x101 core ROIs
+ * Runs once per ingested print, so every kernel works on a bit-packed
+ * binarized ROI and stays in the single-digit microsecond range
+ */
+class FeatureExtractor {
+public:
+    using ROI = CorePointDetector::ROI;
+    
+    static constexpr int ROI_SIZE = 101;
+    
+    // Binarized ROI: bit x of row y is set where pixel (x, y) is ridge (darker than threshold)
+    struct BinaryROI {
+        uint64_t rows[101][2];              // Bits 0-63 in [0], bits 64-100 in [1]
+        uint8_t threshold;                  // Binarization threshold (ROI mean)
+        
+        BinaryROI() : threshold(0) {
+            memset(rows, 0, sizeof(rows));
+        }
+        
+        bool get(int x, int y) const { return (rows[y][x >> 6] >> (x & 63)) & 1u; }
+    };
+    
+    struct RidgeDensity {
+        float ridges_per_pixel;             // Ridge frequency normal to the ridges
+        float ridge_period;                 // Mean ridge-to-ridge distance (pixels, 0 if no ridges)
+        float horizontal_rate;              // Ridge crossings per pixel along rows
+        float vertical_rate;                // Ridge crossings per pixel along columns
+        float ridge_fraction;               // Share of ROI pixels classified as ridge
+        
+        RidgeDensity() : ridges_per_pixel(0), ridge_period(0), horizontal_rate(0), 
+                        vertical_rate(0), ridge_fraction(0) {}
+    };
+    
+    // Minutia type values equal the crossing number at the skeleton pixel
+    enum class MinutiaType : uint8_t {
+        ENDING = 1,
+        BIFURCATION = 3
+    };
+    
+    struct Minutia {
+        uint8_t x, y;                       // Position in the ROI
+        MinutiaType type;
+        
+        Minutia() : x(0), y(0), type(MinutiaType::ENDING) {}
+        Minutia(int x_, int y_, MinutiaType t) : x(static_cast<uint8_t>(x_)), y(static_cast<uint8_t>(y_)), type(t) {}
+    };
+    
+    struct MinutiaeResult {
+        std::vector<Minutia> minutiae;      // Row-major order
+        int endings;
+        int bifurcations;
+        int skeleton_pixels;                // Ridge pixels left after thinning
+        int thinning_iterations;
+        float density;                      // Minutiae per 1000 pixels of the area inside minutiae_border
+        
+        MinutiaeResult() : endings(0), bifurcations(0), skeleton_pixels(0), 
+                          thinning_iterations(0), density(0) {}
+    };
+    
+    // Henry pattern classes (loop side as seen in the image)
+    enum class PatternType : uint8_t {
+        UNKNOWN = 0,
+        ARCH,
+        TENTED_ARCH,
+        LEFT_LOOP,
+        RIGHT_LOOP,
+        WHORL
+    };
+    
+    struct PatternClassification {
+        PatternType type;
+        int cores;                          // Sum of positive Poincare indices (a whorl centre counts twice)
+        int deltas;
+        float confidence;                   // Energy-weighted orientation coherence, reduced for partial configurations
+        
+        PatternClassification() : type(PatternType::UNKNOWN), cores(0), deltas(0), confidence(0) {}
+    };
+    
+    // Zernike moments Z_nm for 0 <= m <= n <= MAX_ORDER, n - m even, over the disc inscribed in the ROI
+    struct ZernikeMoments {
+        static constexpr int MAX_ORDER = 10;
+        static constexpr int COUNT = 36;
+        
+        float magnitude[COUNT];             // |Z_nm|, rotation invariant (the feature vector)
+        float real[COUNT];
+        float imag[COUNT];
+        
+        ZernikeMoments() {
+            memset(magnitude, 0, sizeof(magnitude));
+            memset(real, 0, sizeof(real));
+            memset(imag, 0, sizeof(imag));
+        }
+        
+        // Position of (n, m) in the arrays: n ascending, then m ascending
+        static int index(int n, int m) { return (n / 2) * (n / 2 + 1) + (n % 2) * (n / 2 + 1) + m / 2; }
+    };
+    
+    // Fixed-length descriptor for similarity search: ridge and minutiae statistics plus
+    // Zernike magnitudes relative to |Z00|, each scaled to roughly unit range
+    struct FeatureVector {
+        static constexpr int DIM = 48;      // 41 features, zero padded to a multiple of 8 floats
+        
+        alignas(32) float values[DIM];
+        
+        FeatureVector() {
+            memset(values, 0, sizeof(values));
+        }
+    };
+    
+    struct ExtractionParams {
+        bool use_simd;                      // Enable SIMD optimizations
+        bool denoise;                       // 3-tap majority filter along each scanline before counting
+        int minutiae_border;                // Ignore minutiae this close to the ROI edge (pixels)
+        int max_thinning_iterations;        // Upper bound on Zhang-Suen passes
+        
+        ExtractionParams() : use_simd(true), denoise(true), minutiae_border(8), max_thinning_iterations(32) {}
+    };
+
+private:
+    ExtractionParams params;
+    
+    static bool simd_available;
+    
+    // Binarization against the ROI mean
+    void binarize_simd(const ROI& roi, BinaryROI& binary) const;
+    void binarize_scalar(const ROI& roi, BinaryROI& binary) const;
+    
+    // Separable 3x3 majority smoothing of the binary image
+    static void smooth(BinaryROI& binary);
+
+public:
+    FeatureExtractor(const ExtractionParams& extraction_params = ExtractionParams());
+    
+    void binarize(const ROI& roi, BinaryROI& binary) const;
+    
+    // Ridge density from crossing counts along rows and columns
+    RidgeDensity compute_ridge_density(const ROI& roi) const;
+    RidgeDensity compute_ridge_density(const BinaryROI& binary) const;
+    
+    // Zhang-Suen thinning in place; returns the number of passes
+    int thin(BinaryROI& binary) const;
+    
+    // Binarize, thin and detect minutiae by crossing number
+    MinutiaeResult extract_minutiae(const ROI& roi) const;
+    MinutiaeResult extract_minutiae(const BinaryROI& binary) const;
+    
+    // Pattern class from the detector's block orientation field and singular points
+    // (requires DetectionParams::export_orientation_blocks; no pass over the image)
+    static PatternClassification classify_pattern(const CorePointDetector::DetectionResult& result);
+    static const char* pattern_name(PatternType type);
+    
+    // Zernike moments as dot products against a basis tabulated once for the 101x101 grid
+    ZernikeMoments compute_zernike_moments(const ROI& roi) const;
+    static void initialize_zernike_basis();     // Optional: build the tables at startup instead of first use
+    
+    // Moments for many ROIs at once: the batch is folded into contiguous rows and multiplied
+    // by the basis with a cache-blocked SGEMM (same results as compute_zernike_moments)
+    std::vector<ZernikeMoments> compute_zernike_moments_batch(const std::vector<ROI>& rois) const;
+    void compute_zernike_moments_batch(const ROI* rois, size_t count, ZernikeMoments* moments) const;
+    
+    // Assemble the search descriptor from already extracted features
+    static FeatureVector make_feature_vector(const RidgeDensity& ridge,
+                                             const MinutiaeResult& minutiae,
+                                             const ZernikeMoments& zernike);
+    
+    // Configuration
+    void set_parameters(const ExtractionParams& new_params) { params = new_params; }
+    ExtractionParams get_parameters() const { return params; }
+};
@@ -1,133 +1,148 @@
-// FileManager.h - File I/O with intelligent caching 
-// Implementation placeholder 
-#pragma once
-
-#include <opencv2/opencv.hpp>
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <mutex>
-#include <memory>
-
-/**
- * File management utility for fingerprint processing
- * Optimized for Linux/GitHub Codespaces environment
- * Handles batch loading with caching for performance
- */
-class FileManager {
-public:
-    struct FileInfo {
-        std::string filepath;
-        std::string filename;
-        size_t file_size;
-        bool is_valid;
-        std::string error_message;
-    };
-
-    struct ImageCache {
-        cv::Mat image;
-        std::string filepath;
-        size_t memory_size;
-        std::chrono::time_point<std::chrono::steady_clock> last_accessed;
-    };
-
-private:
-    // Cache management
-    static std::unordered_map<std::string, ImageCache> image_cache;
-    static std::mutex cache_mutex;
-    static size_t max_cache_size_mb;
-    static size_t current_cache_size;
-    
-    // Supported file extensions
-    static const std::vector<std::string> supported_extensions;
-    
-    // Helper methods
-    static bool is_supported_extension(const std::string& filepath);
-    static std::string get_file_extension(const std::string& filepath);
-    static std::string get_filename_from_path(const std::string& filepath);
-    static size_t calculate_image_memory_size(const cv::Mat& image);
-    static void cleanup_cache_if_needed();
-    static void remove_oldest_cache_entry();
-
-public:
-    // Configuration
-    static void set_cache_size_mb(size_t size_mb) { max_cache_size_mb = size_mb; }
-    static size_t get_cache_size_mb() { return max_cache_size_mb; }
-    static size_t get_current_cache_usage_mb() { return current_cache_size / (1024 * 1024); }
-    
-    // Directory scanning
-    static std::vector<FileInfo> scan_directory(const std::string& directory_path, 
-                                              bool recursive = false);
-    
-    // Single file operations
-    static FileInfo get_file_info(const std::string& filepath);
-    static cv::Mat load_image(const std::string& filepath, bool use_cache = true);
-    static bool validate_image(const cv::Mat& image);
-    
-    // Batch operations
-    static std::vector<cv::Mat> load_images_batch(const std::vector<std::string>& filepaths,
-                                                bool use_cache = true,
-                                                std::vector<bool>* success_flags = nullptr);
-    
-    // Cache management
-    static void clear_cache();
-    static void remove_from_cache(const std::string& filepath);
-    static std::vector<std::string> get_cached_files();
-    
-    // Utility functions
-    static bool file_exists(const std::string& filepath);
-    static bool directory_exists(const std::string& directory_path);
-    static bool create_directory(const std::string& directory_path);
-    static size_t get_file_size(const std::string& filepath);
-    
-    // Image validation
-    static bool is_valid_fingerprint_image(const cv::Mat& image);
-    static std::string validate_image_for_processing(const cv::Mat& image);
-    
-    // File path utilities
-    static std::string normalize_path(const std::string& path);
-    static std::string get_directory_from_path(const std::string& filepath);
-    static std::string combine_paths(const std::string& dir, const std::string& filename);
-    
-    // Statistics
-    struct CacheStats {
-        size_t total_entries;
-        size_t total_memory_mb;
-        size_t cache_hits;
-        size_t cache_misses;
-        double hit_ratio;
-    };
-    
-    static CacheStats get_cache_statistics();
-    static void reset_cache_statistics();
-    
-    // Cleanup
-    static void shutdown() { clear_cache(); }
-};
-
-// Helper class for batch file processing
-class FileBatch {
-private:
-    std::vector<FileManager::FileInfo> files;
-    size_t current_index;
-    
-public:
-    explicit FileBatch(const std::string& directory_path, bool recursive = false);
-    explicit FileBatch(const std::vector<std::string>& filepaths);
-    
-    // Iterator-like interface
-    bool has_next() const { return current_index < files.size(); }
-    FileManager::FileInfo next();
-    void reset() { current_index = 0; }
-    
-    // Batch info
-    size_t size() const { return files.size(); }
-    size_t remaining() const { return files.size() - current_index; }
-    double progress() const { 
-        return files.empty() ? 1.0 : static_cast<double>(current_index) / files.size(); 
-    }
-    
-    // Access
-    const std::vector<FileManager::FileInfo>& get_files() const { return files; }
-    const FileManager::FileInfo& get_file(size_t index) const { return files.at(index); }
-};
+// FileManager.h - File I/O with intelligent caching 
+// Implementation placeholder 
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+/**
+ * File management utility for fingerprint processing
+ * Optimized for Linux/GitHub Codespaces environment
+ * Handles batch loading with caching for performance
+ * Files are read whole and hashed (XXH64, see ContentHasher) while being read,
+ * then decoded from memory; callers that skip known content check the hash
+ * between read_file() and decode_image()
+ */
+class FileManager {
+public:
+    struct FileInfo {
+        std::string filepath;
+        std::string filename;
+        size_t file_size;
+        bool is_valid;
+        std::string error_message;
+        uint64_t content_hash;              // XXH64 of the file bytes (0 = not hashed)
+        
+        FileInfo() : file_size(0), is_valid(false), content_hash(0) {}
+    };
+
+    struct ImageCache {
+        cv::Mat image;
+        std::string filepath;
+        uint64_t content_hash;              // XXH64 of the bytes the image was decoded from
+        size_t memory_size;
+        std::chrono::time_point<std::chrono::steady_clock> last_accessed;
+    };
+
+private:
+    // Cache management
+    static std::unordered_map<std::string, ImageCache> image_cache;
+    static std::mutex cache_mutex;
+    static size_t max_cache_size_mb;
+    static size_t current_cache_size;
+    
+    // Supported file extensions
+    static const std::vector<std::string> supported_extensions;
+    
+    // Helper methods
+    static bool is_supported_extension(const std::string& filepath);
+    static std::string get_file_extension(const std::string& filepath);
+    static std::string get_filename_from_path(const std::string& filepath);
+    static size_t calculate_image_memory_size(const cv::Mat& image);
+    static void cleanup_cache_if_needed();
+    static void remove_oldest_cache_entry();
+
+public:
+    // Configuration
+    static void set_cache_size_mb(size_t size_mb) { max_cache_size_mb = size_mb; }
+    static size_t get_cache_size_mb() { return max_cache_size_mb; }
+    static size_t get_current_cache_usage_mb() { return current_cache_size / (1024 * 1024); }
+    
+    // Directory scanning (file metadata only; contents are not read)
+    static std::vector<FileInfo> scan_directory(const std::string& directory_path, 
+                                              bool recursive = false);
+    
+    // Single file operations
+    static FileInfo get_file_info(const std::string& filepath, bool hash_contents = false);
+    static cv::Mat load_image(const std::string& filepath, bool use_cache = true, 
+                              uint64_t* content_hash = nullptr);
+    static uint64_t hash_file(const std::string& filepath);     // 0 if unreadable
+    
+    // load_image in two steps: read a whole file, hashing the bytes chunk by chunk as
+    // they arrive, then decode those bytes (empty Mat on failure)
+    static bool read_file(const std::string& filepath, std::vector<uint8_t>& bytes, uint64_t& content_hash);
+    static cv::Mat decode_image(const std::vector<uint8_t>& bytes, const std::string& filepath);
+    static bool validate_image(const cv::Mat& image);
+    
+    // Batch operations
+    static std::vector<cv::Mat> load_images_batch(const std::vector<std::string>& filepaths,
+                                                bool use_cache = true,
+                                                std::vector<bool>* success_flags = nullptr);
+    
+    // Cache management
+    static void clear_cache();
+    static void remove_from_cache(const std::string& filepath);
+    static std::vector<std::string> get_cached_files();
+    
+    // Utility functions
+    static bool file_exists(const std::string& filepath);
+    static bool directory_exists(const std::string& directory_path);
+    static bool create_directory(const std::string& directory_path);
+    static size_t get_file_size(const std::string& filepath);
+    
+    // Image validation
+    static bool is_valid_fingerprint_image(const cv::Mat& image);
+    static std::string validate_image_for_processing(const cv::Mat& image);
+    
+    // File path utilities
+    static std::string normalize_path(const std::string& path);
+    static std::string get_directory_from_path(const std::string& filepath);
+    static std::string combine_paths(const std::string& dir, const std::string& filename);
+    
+    // Statistics
+    struct CacheStats {
+        size_t total_entries;
+        size_t total_memory_mb;
+        size_t cache_hits;
+        size_t cache_misses;
+        double hit_ratio;
+    };
+    
+    static CacheStats get_cache_statistics();
+    static void reset_cache_statistics();
+    
+    // Cleanup
+    static void shutdown() { clear_cache(); }
+};
+
+// Helper class for batch file processing
+class FileBatch {
+private:
+    std::vector<FileManager::FileInfo> files;
+    size_t current_index;
+    
+public:
+    explicit FileBatch(const std::string& directory_path, bool recursive = false);
+    explicit FileBatch(const std::vector<std::string>& filepaths);
+    
+    // Iterator-like interface
+    bool has_next() const { return current_index < files.size(); }
+    FileManager::FileInfo next();
+    void reset() { current_index = 0; }
+    
+    // Batch info
+    size_t size() const { return files.size(); }
+    size_t remaining() const { return files.size() - current_index; }
+    double progress() const { 
+        return files.empty() ? 1.0 : static_cast<double>(current_index) / files.size(); 
+    }
+    
+    // Access
+    const std::vector<FileManager::FileInfo>& get_files() const { return files; }
+    const FileManager::FileInfo& get_file(size_t index) const { return files.at(index); }
+};
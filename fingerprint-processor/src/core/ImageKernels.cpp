@@ -0,0 +1,251 @@
+// ImageKernels.cpp - ImageKernels implementation 
+#include "ImageKernels.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// BORDER_REFLECT_101: gfedcb|abcdefgh|gfedcba
+inline int reflect_101(int i, int n) {
+    if (n == 1) return 0;
+    while (i < 0 || i >= n) {
+        i = i < 0 ? -i : 2 * n - 2 - i;
+    }
+    return i;
+}
+
+inline uint8_t saturate_u8(float value) {
+    return static_cast<uint8_t>(std::clamp(std::lrint(value), 0L, 255L));
+}
+
+// cv::GaussianBlur's bit-exact 8-bit kernel: getGaussianKernel's coefficients in
+// Q8 fixed point, rounded with error diffusion from the tails so they sum to 256
+void gaussian_coefficients(int ksize, double sigma, int* coefficients) {
+    static const double small_kernels[4][7] = {
+        {1.0},
+        {0.25, 0.5, 0.25},
+        {0.0625, 0.25, 0.375, 0.25, 0.0625},
+        {0.03125, 0.109375, 0.21875, 0.28125, 0.21875, 0.109375, 0.03125}
+    };
+    
+    double kernel[ImageKernels::MAX_GAUSSIAN_KERNEL];
+    const int half = ksize / 2;
+    if (sigma <= 0 && ksize <= 7) {
+        std::copy(small_kernels[half], small_kernels[half] + ksize, kernel);
+    } else {
+        double sigma_x = sigma > 0 ? sigma : ((ksize - 1) * 0.5 - 1) * 0.3 + 0.8;
+        double scale_2x = -0.5 / (sigma_x * sigma_x);
+        double sum = 0;
+        for (int i = 0; i < ksize; ++i) {
+            double x = i - half;
+            kernel[i] = std::exp(scale_2x * x * x);
+            sum += kernel[i];
+        }
+        for (int i = 0; i < ksize; ++i) kernel[i] /= sum;
+    }
+    
+    double error = 0;
+    int total = 0;
+    for (int i = 0; i < half; ++i) {
+        double value = kernel[i] * 256.0 + error;
+        int rounded = static_cast<int>(std::lrint(value));
+        error = value - rounded;
+        coefficients[i] = coefficients[ksize - 1 - i] = rounded;
+        total += 2 * rounded;
+    }
+    coefficients[half] = 256 - total;
+}
+
+} // namespace
+
+bool ImageKernels::gaussian_blur(const cv::Mat& src, cv::Mat& dst, int ksize, double sigma, cv::Mat& scratch) {
+    if (ksize < 1 || ksize % 2 == 0 || ksize > MAX_GAUSSIAN_KERNEL) {
+        return false;
+    }
+    
+    int coefficients[MAX_GAUSSIAN_KERNEL];
+    gaussian_coefficients(ksize, sigma, coefficients);
+    const int radius = ksize / 2;
+    const int rows = src.rows;
+    const int cols = src.cols;
+    
+    // Horizontal pass into scratch rows 0..rows-1 (Q8)
+    for (int y = 0; y < rows; ++y) {
+        const uint8_t* in = src.ptr<uint8_t>(y);
+        int32_t* out = scratch.ptr<int32_t>(y);
+        
+        for (int x = 0; x < cols; ++x) {
+            int32_t sum = 0;
+            if (x >= radius && x + radius < cols) {
+                const uint8_t* tap = in + x - radius;
+                for (int k = 0; k < ksize; ++k) sum += coefficients[k] * tap[k];
+            } else {
+                for (int k = 0; k < ksize; ++k) sum += coefficients[k] * in[reflect_101(x + k - radius, cols)];
+            }
+            out[x] = sum;
+        }
+    }
+    
+    // Vertical pass (Q16), accumulated a row at a time in scratch row `rows`
+    int32_t* accumulator = scratch.ptr<int32_t>(rows);
+    for (int y = 0; y < rows; ++y) {
+        std::fill(accumulator, accumulator + cols, 0);
+        for (int k = 0; k < ksize; ++k) {
+            const int32_t* in = scratch.ptr<int32_t>(reflect_101(y + k - radius, rows));
+            const int32_t c = coefficients[k];
+            for (int x = 0; x < cols; ++x) accumulator[x] += c * in[x];
+        }
+        
+        uint8_t* out = dst.ptr<uint8_t>(y);
+        for (int x = 0; x < cols; ++x) out[x] = static_cast<uint8_t>((accumulator[x] + (1 << 15)) >> 16);
+    }
+    
+    return true;
+}
+
+void ImageKernels::normalize_min_max(cv::Mat& image) {
+    if (image.empty()) return;
+    
+    int low = 255, high = 0;
+    for (int y = 0; y < image.rows; ++y) {
+        const uint8_t* row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < image.cols; ++x) {
+            low = std::min(low, static_cast<int>(row[x]));
+            high = std::max(high, static_cast<int>(row[x]));
+        }
+    }
+    
+    // Same scale/shift as cv::normalize; 8-bit convertTo applies them in float
+    const double range = static_cast<double>(high - low);
+    const double scale = 255.0 * (range > DBL_EPSILON ? 1.0 / range : 0.0);
+    const double shift = -low * scale;
+    const float scale_f = static_cast<float>(scale);
+    const float shift_f = static_cast<float>(shift);
+    
+    uint8_t lut[256];
+    for (int v = 0; v < 256; ++v) lut[v] = saturate_u8(v * scale_f + shift_f);
+    
+    for (int y = 0; y < image.rows; ++y) {
+        uint8_t* row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < image.cols; ++x) row[x] = lut[row[x]];
+    }
+}
+
+void ImageKernels::equalize_hist(cv::Mat& image) {
+    if (image.empty()) return;
+    
+    int hist[256] = {0};
+    for (int y = 0; y < image.rows; ++y) {
+        const uint8_t* row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < image.cols; ++x) hist[row[x]]++;
+    }
+    
+    const int total = image.rows * image.cols;
+    int first = 0;
+    while (!hist[first]) ++first;
+    
+    uint8_t lut[256] = {0};
+    if (hist[first] == total) {
+        std::fill(lut, lut + 256, static_cast<uint8_t>(first));
+    } else {
+        const float scale = 255.0f / (total - hist[first]);
+        int sum = 0;
+        for (int i = first + 1; i < 256; ++i) {
+            sum += hist[i];
+            lut[i] = saturate_u8(sum * scale);
+        }
+    }
+    
+    for (int y = 0; y < image.rows; ++y) {
+        uint8_t* row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < image.cols; ++x) row[x] = lut[row[x]];
+    }
+}
+
+void ImageKernels::sobel_3x3(const cv::Mat& src, cv::Mat& grad_x, cv::Mat& grad_y) {
+    const int rows = src.rows;
+    const int cols = src.cols;
+    
+    for (int y = 0; y < rows; ++y) {
+        const uint8_t* prev = src.ptr<uint8_t>(reflect_101(y - 1, rows));
+        const uint8_t* curr = src.ptr<uint8_t>(y);
+        const uint8_t* next = src.ptr<uint8_t>(reflect_101(y + 1, rows));
+        float* gx = grad_x.ptr<float>(y);
+        float* gy = grad_y.ptr<float>(y);
+        
+        auto at = [&](int x, int left, int right) {
+            gx[x] = static_cast<float>((prev[right] - prev[left]) + 2 * (curr[right] - curr[left]) + (next[right] - next[left]));
+            gy[x] = static_cast<float>((next[left] + 2 * next[x] + next[right]) - (prev[left] + 2 * prev[x] + prev[right]));
+        };
+        
+        at(0, reflect_101(-1, cols), reflect_101(1, cols));
+        for (int x = 1; x < cols - 1; ++x) at(x, x - 1, x + 1);
+        if (cols > 1) at(cols - 1, cols - 2, reflect_101(cols, cols));
+    }
+}
+
+void ImageKernels::laplacian(const cv::Mat& src, cv::Mat& dst) {
+    const int rows = src.rows;
+    const int cols = src.cols;
+    
+    for (int y = 0; y < rows; ++y) {
+        const uint8_t* prev = src.ptr<uint8_t>(reflect_101(y - 1, rows));
+        const uint8_t* curr = src.ptr<uint8_t>(y);
+        const uint8_t* next = src.ptr<uint8_t>(reflect_101(y + 1, rows));
+        double* out = dst.ptr<double>(y);
+        
+        auto at = [&](int x, int left, int right) {
+            out[x] = static_cast<double>(prev[x] + next[x] + curr[left] + curr[right] - 4 * curr[x]);
+        };
+        
+        at(0, reflect_101(-1, cols), reflect_101(1, cols));
+        for (int x = 1; x < cols - 1; ++x) at(x, x - 1, x + 1);
+        if (cols > 1) at(cols - 1, cols - 2, reflect_101(cols, cols));
+    }
+}
+
+void ImageKernels::mean_stddev(const cv::Mat& image, double& mean, double& stddev) {
+    mean = stddev = 0.0;
+    if (image.empty()) return;
+    
+    double sum = 0.0, square_sum = 0.0;
+    if (image.type() == CV_8U) {
+        uint64_t int_sum = 0, int_square_sum = 0;
+        for (int y = 0; y < image.rows; ++y) {
+            const uint8_t* row = image.ptr<uint8_t>(y);
+            for (int x = 0; x < image.cols; ++x) {
+                int_sum += row[x];
+                int_square_sum += static_cast<uint32_t>(row[x]) * row[x];
+            }
+        }
+        sum = static_cast<double>(int_sum);
+        square_sum = static_cast<double>(int_square_sum);
+    } else if (image.type() == CV_64F) {
+        for (int y = 0; y < image.rows; ++y) {
+            const double* row = image.ptr<double>(y);
+            for (int x = 0; x < image.cols; ++x) {
+                sum += row[x];
+                square_sum += row[x] * row[x];
+            }
+        }
+    } else {
+        cv::Scalar m, s;
+        cv::meanStdDev(image, m, s);
+        mean = m[0];
+        stddev = s[0];
+        return;
+    }
+    
+    const double scale = 1.0 / (static_cast<double>(image.rows) * image.cols);
+    mean = sum * scale;
+    stddev = std::sqrt(std::max(square_sum * scale - mean * mean, 0.0));
+}
+
+void ImageKernels::zero(cv::Mat& image) {
+    const size_t row_bytes = image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; ++y) {
+        std::memset(image.ptr(y), 0, row_bytes);
+    }
+}
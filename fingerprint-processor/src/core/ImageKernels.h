@@ -0,0 +1,41 @@
+// ImageKernels.h - Allocation-free image filters for the detection hot path 
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * In-place and caller-buffered versions of the OpenCV filters used per image
+ * by CorePointDetector. OpenCV allocates row buffers and filter engines inside
+ * every GaussianBlur/Sobel/Laplacian/equalizeHist call; these kernels work on
+ * the caller's Mats only, so a warm detection never touches the heap.
+ *
+ * All kernels use BORDER_REFLECT_101 (OpenCV's default) and reproduce OpenCV's
+ * output exactly, including the Gaussian blur's fixed-point 8-bit arithmetic.
+ */
+class ImageKernels {
+public:
+    static constexpr int MAX_GAUSSIAN_KERNEL = 31;
+    
+    // Separable Gaussian blur, CV_8U -> CV_8U (src and dst must not overlap).
+    // scratch is a CV_32S buffer of at least (src.rows + 1) x src.cols.
+    // Returns false (nothing written) for kernels wider than MAX_GAUSSIAN_KERNEL
+    static bool gaussian_blur(const cv::Mat& src, cv::Mat& dst, int ksize, double sigma, cv::Mat& scratch);
+    
+    // cv::normalize(image, image, 0, 255, NORM_MINMAX) on CV_8U, in place
+    static void normalize_min_max(cv::Mat& image);
+    
+    // cv::equalizeHist on CV_8U, in place
+    static void equalize_hist(cv::Mat& image);
+    
+    // 3x3 Sobel derivatives (dx and dy) of a CV_8U image into CV_32F
+    static void sobel_3x3(const cv::Mat& src, cv::Mat& grad_x, cv::Mat& grad_y);
+    
+    // cv::Laplacian with ksize 1 of a CV_8U image into CV_64F
+    static void laplacian(const cv::Mat& src, cv::Mat& dst);
+    
+    // cv::meanStdDev of a single-channel CV_8U or CV_64F image
+    static void mean_stddev(const cv::Mat& image, double& mean, double& stddev);
+    
+    // setTo(0) without going through OpenCV's scalar conversion
+    static void zero(cv::Mat& image);
+};
@@ -0,0 +1,124 @@
+// RoiHasher.cpp - RoiHasher implementation 
+#include "RoiHasher.h"
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+
+namespace {
+
+constexpr int REDUCED_SIZE = 32;            // Box-filtered image side (3x3 blocks of the centre 96x96)
+constexpr int REDUCED_OFFSET = 2;           // (101 - 96) / 2
+constexpr int FREQUENCIES = 16;             // DCT frequencies 0-15 per axis cover the 128 zig-zag AC terms
+constexpr float MIN_COEFFICIENT = 32.0f;    // Below this every AC term is rounding noise (flat ROI)
+
+struct DctTables {
+    alignas(32) float basis[REDUCED_SIZE][FREQUENCIES];             // cos(pi * (2n + 1) * k / 64)
+    alignas(32) float basis_transposed[FREQUENCIES][REDUCED_SIZE];
+    uint8_t zigzag[RoiHasher::HASH_BITS][2];    // (u, v) of the hashed coefficients, lowest frequency first
+    
+    DctTables() {
+        for (int n = 0; n < REDUCED_SIZE; ++n) {
+            for (int k = 0; k < FREQUENCIES; ++k) {
+                basis[n][k] = static_cast<float>(std::cos(M_PI * (2 * n + 1) * k / (2.0 * REDUCED_SIZE)));
+                basis_transposed[k][n] = basis[n][k];
+            }
+        }
+        
+        // Anti-diagonals u + v = 1, 2, ... until HASH_BITS AC coefficients are collected
+        int count = 0;
+        for (int diagonal = 1; count < RoiHasher::HASH_BITS; ++diagonal) {
+            for (int u = 0; u <= diagonal && count < RoiHasher::HASH_BITS; ++u) {
+                zigzag[count][0] = static_cast<uint8_t>(u);
+                zigzag[count][1] = static_cast<uint8_t>(diagonal - u);
+                ++count;
+            }
+        }
+    }
+};
+
+const DctTables& dct_tables() {
+    static const DctTables tables;
+    return tables;
+}
+
+// c[rows x 16] = a[rows x 32] * b[32 x 16], all row-major, rows even. Both DCT passes have this shape
+void multiply_32x16(const float* a, int rows, const float* b, float* c) {
+#ifdef __AVX2__
+    // Two rows at a time: four independent FMA chains hide the FMA latency
+    for (int i = 0; i < rows; i += 2) {
+        const float* a0 = a + i * REDUCED_SIZE;
+        const float* a1 = a0 + REDUCED_SIZE;
+        __m256 low0 = _mm256_setzero_ps(), high0 = _mm256_setzero_ps();
+        __m256 low1 = _mm256_setzero_ps(), high1 = _mm256_setzero_ps();
+        for (int j = 0; j < REDUCED_SIZE; ++j) {
+            __m256 b_low = _mm256_load_ps(b + j * FREQUENCIES);
+            __m256 b_high = _mm256_load_ps(b + j * FREQUENCIES + 8);
+            __m256 value0 = _mm256_broadcast_ss(a0 + j);
+            __m256 value1 = _mm256_broadcast_ss(a1 + j);
+            low0 = _mm256_fmadd_ps(value0, b_low, low0);
+            high0 = _mm256_fmadd_ps(value0, b_high, high0);
+            low1 = _mm256_fmadd_ps(value1, b_low, low1);
+            high1 = _mm256_fmadd_ps(value1, b_high, high1);
+        }
+        _mm256_store_ps(c + i * FREQUENCIES, low0);
+        _mm256_store_ps(c + i * FREQUENCIES + 8, high0);
+        _mm256_store_ps(c + (i + 1) * FREQUENCIES, low1);
+        _mm256_store_ps(c + (i + 1) * FREQUENCIES + 8, high1);
+    }
+#else
+    for (int i = 0; i < rows; ++i) {
+        for (int k = 0; k < FREQUENCIES; ++k) {
+            float sum = 0;
+            for (int j = 0; j < REDUCED_SIZE; ++j) sum += a[i * REDUCED_SIZE + j] * b[j * FREQUENCIES + k];
+            c[i * FREQUENCIES + k] = sum;
+        }
+    }
+#endif
+}
+
+} // namespace
+
+RoiHasher::Hash RoiHasher::compute(const uint8_t (&pixels)[101][101]) {
+    const DctTables& tables = dct_tables();
+    
+    // 3x3 box filter and decimation: suppresses pixel noise and sub-pixel shifts
+    alignas(32) float reduced[REDUCED_SIZE][REDUCED_SIZE];
+    for (int y = 0; y < REDUCED_SIZE; ++y) {
+        const uint8_t* row0 = pixels[REDUCED_OFFSET + 3 * y];
+        const uint8_t* row1 = pixels[REDUCED_OFFSET + 3 * y + 1];
+        const uint8_t* row2 = pixels[REDUCED_OFFSET + 3 * y + 2];
+        for (int x = 0; x < REDUCED_SIZE; ++x) {
+            int sx = REDUCED_OFFSET + 3 * x;
+            int sum = row0[sx] + row0[sx + 1] + row0[sx + 2] +
+                      row1[sx] + row1[sx + 1] + row1[sx + 2] +
+                      row2[sx] + row2[sx + 1] + row2[sx + 2];
+            reduced[y][x] = static_cast<float>(sum);
+        }
+    }
+    
+    // Separable DCT restricted to the low frequencies: rows, then columns
+    alignas(32) float row_dct[REDUCED_SIZE][FREQUENCIES];
+    alignas(32) float dct[FREQUENCIES][FREQUENCIES];
+    multiply_32x16(&reduced[0][0], REDUCED_SIZE, &tables.basis[0][0], &row_dct[0][0]);
+    multiply_32x16(&tables.basis_transposed[0][0], FREQUENCIES, &row_dct[0][0], &dct[0][0]);
+    
+    float coefficients[HASH_BITS];
+    float largest = 0;
+    for (int i = 0; i < HASH_BITS; ++i) {
+        coefficients[i] = dct[tables.zigzag[i][0]][tables.zigzag[i][1]];
+        largest = std::max(largest, std::fabs(coefficients[i]));
+    }
+    if (largest < MIN_COEFFICIENT) return Hash();
+    
+    // Median split: invariant to brightness and contrast changes
+    float sorted[HASH_BITS];
+    std::copy(coefficients, coefficients + HASH_BITS, sorted);
+    std::nth_element(sorted, sorted + HASH_BITS / 2, sorted + HASH_BITS);
+    const float median = sorted[HASH_BITS / 2];
+    
+    Hash hash;
+    for (int i = 0; i < HASH_BITS; ++i) {
+        if (coefficients[i] > median) hash.bits[i >> 6] |= 1ull << (i & 63);
+    }
+    return hash;
+}
@@ -0,0 +1,30 @@
+// RoiHasher.h - Perceptual hashes of core ROIs 
+#pragma once
+
+#include "CorePointDetector.h"
+#include <cstdint>
+
+/**
+ * 128-bit DCT perceptual hash of a 101x101 ROI
+ * The ROI is box-filtered to 32x32, and each bit records whether one of the 128
+ * lowest-frequency AC coefficients of its 2-D DCT lies above their median.
+ * Re-encoded, re-exposed or slightly shifted captures of the same finger land
+ * within a few bits of each other, so duplicates are found by Hamming distance
+ * (HammingIndex) instead of pixel comparisons
+ */
+class RoiHasher {
+public:
+    using ROI = CorePointDetector::ROI;
+    using Hash = CorePointDetector::RoiHash;
+    
+    static constexpr int HASH_BITS = 128;
+    static constexpr int DUPLICATE_DISTANCE = 15;   // Bits that may differ between captures treated as duplicates
+    
+    // A flat ROI (no AC content) hashes to all zero, i.e. "no hash"
+    static Hash compute(const ROI& roi) { return compute(roi.pixels); }
+    static Hash compute(const uint8_t (&pixels)[101][101]);
+    
+    static int distance(const Hash& a, const Hash& b) {
+        return __builtin_popcountll(a.bits[0] ^ b.bits[0]) + __builtin_popcountll(a.bits[1] ^ b.bits[1]);
+    }
+};
@@ -0,0 +1,127 @@
+// SpoolWatcher.cpp - SpoolWatcher implementation 
+#include "SpoolWatcher.h"
+#include "FileManager.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+bool SpoolWatcher::start(const std::string& spool_directory, std::vector<std::string>* existing) {
+    stop();
+    
+    if (!FileManager::directory_exists(spool_directory)) {
+        Logger::error("Spool directory does not exist: " + spool_directory);
+        return false;
+    }
+    
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        Logger::error("inotify_init1 failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    
+    // Watch before scanning so nothing arriving in between is missed (it may be reported twice)
+    watch_descriptor = inotify_add_watch(inotify_fd, spool_directory.c_str(),
+                                         IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+    if (watch_descriptor < 0) {
+        Logger::error("Cannot watch " + spool_directory + ": " + strerror(errno));
+        stop();
+        return false;
+    }
+    
+    directory = FileManager::normalize_path(spool_directory);
+    event_buffer.resize(64 * 1024);
+    
+    if (existing) {
+        scan(*existing);
+    }
+    
+    Logger::info("Watching spool directory " + directory);
+    return true;
+}
+
+void SpoolWatcher::stop() {
+    if (inotify_fd >= 0) {
+        close(inotify_fd);    // Also removes the watch
+        inotify_fd = -1;
+    }
+    watch_descriptor = -1;
+}
+
+void SpoolWatcher::scan(std::vector<std::string>& ready) const {
+    std::vector<FileManager::FileInfo> files = FileManager::scan_directory(directory);
+    std::vector<std::string> paths;
+    paths.reserve(files.size());
+    for (const auto& file : files) {
+        if (file.is_valid) paths.push_back(file.filepath);
+    }
+    
+    std::sort(paths.begin(), paths.end());
+    ready.insert(ready.end(), paths.begin(), paths.end());
+}
+
+bool SpoolWatcher::wait(std::vector<std::string>& ready, int timeout_ms) {
+    if (inotify_fd < 0) return false;
+    
+    struct pollfd descriptor;
+    descriptor.fd = inotify_fd;
+    descriptor.events = POLLIN;
+    descriptor.revents = 0;
+    
+    int result = poll(&descriptor, 1, timeout_ms);
+    if (result < 0) {
+        if (errno == EINTR) return true;
+        Logger::error("Spool watcher poll failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    if (result == 0) return true;
+    
+    // Drain everything queued so a burst of arrivals is handed over (and committed) together
+    std::vector<std::string> arrived;
+    bool overflow = false;
+    while (true) {
+        ssize_t length = read(inotify_fd, event_buffer.data(), event_buffer.size());
+        if (length < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            Logger::error("Spool watcher read failed: " + std::string(strerror(errno)));
+            return false;
+        }
+        
+        for (ssize_t offset = 0; offset < length; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(&event_buffer[offset]);
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+            
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflow = true;
+            } else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                Logger::error("Spool directory " + directory + " was removed or moved");
+                return false;
+            } else if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+                std::string path = (fs::path(directory) / event->name).string();
+                if (FileManager::get_file_info(path).is_valid) {
+                    arrived.push_back(path);
+                }
+            }
+        }
+    }
+    
+    if (overflow) {
+        // Events were lost; everything still in the spool is unprocessed
+        Logger::warning("Spool watcher event queue overflowed, rescanning " + directory);
+        arrived.clear();
+        scan(arrived);
+    }
+    
+    // A file rewritten while queued is reported more than once
+    std::sort(arrived.begin(), arrived.end());
+    arrived.erase(std::unique(arrived.begin(), arrived.end()), arrived.end());
+    ready.insert(ready.end(), arrived.begin(), arrived.end());
+    return true;
+}
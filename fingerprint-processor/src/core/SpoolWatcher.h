@@ -0,0 +1,42 @@
+// SpoolWatcher.h - inotify watcher for a spool directory of incoming images 
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * Reports image files as they arrive in a spool directory (Linux inotify)
+ * A file is ready once it is closed after writing (IN_CLOSE_WRITE) or moved in
+ * (IN_MOVED_TO); producers should write elsewhere and rename into the spool so
+ * a partially written file is never picked up. Only the top level is watched.
+ * If the kernel event queue overflows, the directory is rescanned, so callers
+ * are expected to move processed files out of the spool.
+ */
+class SpoolWatcher {
+private:
+    std::string directory;
+    int inotify_fd;
+    int watch_descriptor;
+    std::vector<char> event_buffer;
+    
+    // Supported image files currently in the spool, in path order
+    void scan(std::vector<std::string>& ready) const;
+
+public:
+    SpoolWatcher() : inotify_fd(-1), watch_descriptor(-1) {}
+    ~SpoolWatcher() { stop(); }
+    
+    SpoolWatcher(const SpoolWatcher&) = delete;
+    SpoolWatcher& operator=(const SpoolWatcher&) = delete;
+    
+    // Start watching; files already present are appended to existing
+    bool start(const std::string& spool_directory, std::vector<std::string>* existing = nullptr);
+    void stop();
+    bool is_running() const { return inotify_fd >= 0; }
+    
+    // Wait up to timeout_ms (-1 = indefinitely) and append the files that became ready.
+    // Returns false only on a watcher error; a signal ends the wait early with no files.
+    bool wait(std::vector<std::string>& ready, int timeout_ms);
+    
+    const std::string& get_directory() const { return directory; }
+};
@@ -0,0 +1,81 @@
+// AddressIndex.cpp - AddressIndex implementation 
+#include "AddressIndex.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <cstring>
+
+bool AddressIndex::open(const std::string& database_path) {
+    close();
+    
+    if (!db.open(database_path)) return false;
+    
+    // Keyed range scans in address order; the index covers the ORDER BY
+    bool prepared = 
+        db.prepare(range_statement, 
+                   "SELECT id, filename, core_rank, address FROM rois "
+                   "WHERE address_key BETWEEN ?1 AND ?2 ORDER BY address_key LIMIT ?3;") &&
+        db.prepare(count_statement, 
+                   "SELECT COUNT(*) FROM rois WHERE address_key BETWEEN ?1 AND ?2;");
+    
+    if (!prepared) {
+        Logger::error("AddressIndex: " + database_path + " has no address columns: " + db.last_error());
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AddressIndex::close() {
+    range_statement.finalize();
+    count_statement.finalize();
+    db.close();
+}
+
+bool AddressIndex::find_prefix(const std::string& prefix, std::vector<Match>& matches, size_t limit) {
+    matches.clear();
+    
+    uint64_t low = 0, high = 0;
+    if (!is_open() || !AddressGenerator::prefix_range(prefix.c_str(), low, high)) {
+        Logger::error("AddressIndex: invalid address prefix '" + prefix + "'");
+        return false;
+    }
+    
+    range_statement.reset();
+    range_statement.bind_int64(1, static_cast<int64_t>(low));
+    range_statement.bind_int64(2, static_cast<int64_t>(high));
+    range_statement.bind_int64(3, limit == 0 ? -1 : static_cast<int64_t>(limit));   // LIMIT -1 = no limit
+    
+    int rc;
+    while ((rc = range_statement.step()) == SQLITE_ROW) {
+        Match match;
+        match.row_id = range_statement.column_int64(0);
+        match.filename = range_statement.column_text(1);
+        match.core_rank = range_statement.column_int(2);
+        
+        std::string address = range_statement.column_text(3);
+        memcpy(match.address.text, address.data(), 
+               std::min(address.size(), sizeof(match.address.text) - 1));
+        
+        matches.push_back(std::move(match));
+    }
+    range_statement.reset();
+    
+    if (rc != SQLITE_DONE) {
+        Logger::error("AddressIndex: prefix query failed: " + db.last_error());
+        return false;
+    }
+    return true;
+}
+
+int64_t AddressIndex::count_prefix(const std::string& prefix) {
+    uint64_t low = 0, high = 0;
+    if (!is_open() || !AddressGenerator::prefix_range(prefix.c_str(), low, high)) return -1;
+    
+    count_statement.reset();
+    count_statement.bind_int64(1, static_cast<int64_t>(low));
+    count_statement.bind_int64(2, static_cast<int64_t>(high));
+    
+    int64_t count = count_statement.step() == SQLITE_ROW ? count_statement.column_int64(0) : -1;
+    count_statement.reset();
+    return count;
+}
@@ -0,0 +1,47 @@
+// AddressIndex.h - Address-prefix lookups over stored biological addresses 
+#pragma once
+
+#include "SQLiteAdapter.h"
+#include "../core/AddressGenerator.h"
+#include <string>
+#include <vector>
+
+/**
+ * Candidate lookup by biological address prefix
+ * Prefixes are turned into an inclusive range of order-preserving address keys
+ * and answered by a range scan on idx_rois_address_key (no LIKE string scans)
+ */
+class AddressIndex {
+public:
+    struct Match {
+        int64_t row_id;
+        std::string filename;
+        int32_t core_rank;
+        AddressGenerator::Address address;
+        
+        Match() : row_id(0), core_rank(0) {}
+    };
+
+private:
+    SQLiteAdapter db;
+    SQLiteStatement range_statement;
+    SQLiteStatement count_statement;
+
+public:
+    AddressIndex() = default;
+    ~AddressIndex() { close(); }
+    
+    AddressIndex(const AddressIndex&) = delete;
+    AddressIndex& operator=(const AddressIndex&) = delete;
+    
+    // Open a database written by DatabaseWriter
+    bool open(const std::string& database_path);
+    void close();
+    bool is_open() const { return db.is_open(); }
+    
+    // Rows whose address starts with prefix, in address order (limit 0 = all)
+    bool find_prefix(const std::string& prefix, std::vector<Match>& matches, size_t limit = 0);
+    
+    // Number of rows whose address starts with prefix (-1 on error)
+    int64_t count_prefix(const std::string& prefix);
+};
@@ -0,0 +1,324 @@
+// AsyncDatabaseWriter.cpp - AsyncDatabaseWriter implementation 
+#include "AsyncDatabaseWriter.h"
+#include "../utils/Logger.h"
+#include "../utils/Timer.h"
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+bool AsyncDatabaseWriter::start(const Config& writer_config) {
+    if (running) {
+        Logger::warning("AsyncDatabaseWriter already running");
+        return true;
+    }
+    
+    config = writer_config;
+    if (config.commit_rows == 0) config.commit_rows = 1;
+    if (config.commit_interval_ms <= 0) config.commit_interval_ms = 1;
+    
+    if (!writer.open(config.database)) {
+        return false;
+    }
+    
+    queue = std::make_unique<ThreadSafeQueue<Entry>>(config.queue_capacity);
+    {
+        std::lock_guard<std::mutex> lock(metrics_mutex);
+        metrics = Metrics();
+        flushes_requested = 0;
+        flushes_completed = 0;
+        unreported_failed_rows = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(content_mutex);
+        queued_content.clear();
+    }
+    progress_failed = false;
+    
+    running = true;
+    writer_thread = std::thread(&AsyncDatabaseWriter::writer_loop, this);
+    
+    Logger::info("AsyncDatabaseWriter started (queue " + std::to_string(config.queue_capacity) + 
+                " results, group commit " + std::to_string(config.commit_rows) + " rows / " +
+                std::to_string(config.commit_interval_ms) + "ms)");
+    return true;
+}
+
+void AsyncDatabaseWriter::stop() {
+    if (!running) return;
+    
+    // Closing the queue lets the writer drain the remaining rows and exit
+    running = false;
+    queue->close();
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+    writer.close();
+    
+    Logger::info("AsyncDatabaseWriter stopped: " + format_metrics());
+}
+
+bool AsyncDatabaseWriter::submit(const CorePointDetector::DetectionResult& result) {
+    // ROI encoding and description happen here on the producer thread, off the single writer thread
+    Unit rows = writer.to_records(result);
+    if (rows.empty()) return queue != nullptr && !queue->closed();
+    return submit(std::move(rows));
+}
+
+bool AsyncDatabaseWriter::submit(const CorePointDetector::DetectionResult& result,
+                                 const DatabaseWriter::RunProgress& progress) {
+    Entry entry;
+    entry.rows = writer.to_records(result);
+    entry.progress = progress;
+    return enqueue(std::move(entry));
+}
+
+bool AsyncDatabaseWriter::submit(Unit&& rows) {
+    Entry entry;
+    entry.rows = std::move(rows);
+    return enqueue(std::move(entry));
+}
+
+bool AsyncDatabaseWriter::submit(DatabaseWriter::Record&& record) {
+    Unit rows;
+    rows.push_back(std::move(record));
+    return submit(std::move(rows));
+}
+
+bool AsyncDatabaseWriter::try_submit(DatabaseWriter::Record&& record) {
+    if (!queue) return false;
+    Entry entry;
+    entry.rows.push_back(std::move(record));
+    
+    track_content(entry.rows, true);
+    if (queue->try_push(std::move(entry))) return true;
+    track_content(entry.rows, false);       // A rejected entry is left as it was
+    return false;
+}
+
+bool AsyncDatabaseWriter::enqueue(Entry&& entry) {
+    if (!queue) return false;
+    
+    // Counted before the push, so contains_content() never misses a unit in flight;
+    // a rejected entry is left as it was
+    track_content(entry.rows, true);
+    
+    // Fast path: room in the queue
+    if (queue->try_push(std::move(entry))) return true;
+    
+    bool accepted = false;
+    if (!queue->closed()) {
+        // Queue full: block until the writer catches up (backpressure)
+        Timer wait_timer;
+        wait_timer.start();
+        accepted = queue->push(std::move(entry));
+        double waited_us = wait_timer.stop();
+        
+        std::lock_guard<std::mutex> lock(metrics_mutex);
+        metrics.producer_wait_us += waited_us;
+    }
+    if (!accepted) track_content(entry.rows, false);
+    return accepted;
+}
+
+void AsyncDatabaseWriter::track_content(const Unit& rows, bool queued) {
+    std::lock_guard<std::mutex> lock(content_mutex);
+    for (const auto& record : rows) {
+        if (record.content_hash == 0) continue;
+        if (queued) {
+            queued_content[record.content_hash]++;
+        } else {
+            auto it = queued_content.find(record.content_hash);
+            if (it != queued_content.end() && --it->second == 0) queued_content.erase(it);
+        }
+    }
+}
+
+bool AsyncDatabaseWriter::contains_content(uint64_t content_hash) {
+    if (content_hash == 0) return false;
+    {
+        std::lock_guard<std::mutex> lock(content_mutex);
+        if (queued_content.count(content_hash)) return true;
+    }
+    return writer.contains_content(content_hash);
+}
+
+bool AsyncDatabaseWriter::load_progress(const std::string& run_key, DatabaseWriter::RunProgress& progress) {
+    return writer.load_progress(run_key, progress);
+}
+
+bool AsyncDatabaseWriter::finish_bulk_load() {
+    // The writer thread is idle once flush() returns; the index rebuild runs here
+    return flush() && writer.finish_bulk_load();
+}
+
+bool AsyncDatabaseWriter::flush() {
+    if (!queue) return false;
+    
+    // Every unit submitted before this ticket sits ahead of its marker in the queue
+    uint64_t ticket = ++flushes_requested;
+    Entry marker;
+    marker.flush_marker = true;
+    if (!queue->push(std::move(marker))) return false;
+    
+    std::unique_lock<std::mutex> lock(metrics_mutex);
+    flush_done.wait(lock, [this, ticket] { return flushes_completed >= ticket; });
+    bool clean = unreported_failed_rows == 0;
+    unreported_failed_rows = 0;
+    return clean;
+}
+
+void AsyncDatabaseWriter::writer_loop() {
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::milliseconds(config.commit_interval_ms);
+    
+    std::vector<Entry> units;
+    size_t batch_rows = 0;
+    size_t markers = 0;
+    auto deadline = Clock::now() + interval;
+    
+    while (true) {
+        size_t first_new = units.size();
+        queue->pop_batch(units, config.commit_rows - std::min(batch_rows, config.commit_rows - 1), deadline);
+        for (size_t i = first_new; i < units.size(); ++i) {
+            batch_rows += units[i].rows.size();
+            if (units[i].flush_marker) markers++;
+        }
+        
+        bool drained = queue->drained();
+        bool size_reached = batch_rows >= config.commit_rows;
+        bool time_reached = Clock::now() >= deadline;
+        
+        if (!units.empty() && (size_reached || time_reached || drained || markers > 0)) {
+            commit_units(units, size_reached);
+            batch_rows = 0;
+            
+            // Everything ahead of the markers is now committed or counted as failed
+            if (markers > 0) {
+                {
+                    std::lock_guard<std::mutex> lock(metrics_mutex);
+                    flushes_completed += markers;
+                }
+                markers = 0;
+                flush_done.notify_all();
+            }
+        }
+        
+        if (size_reached || time_reached) {
+            deadline = Clock::now() + interval;
+        }
+        
+        if (drained && units.empty()) break;
+    }
+}
+
+void AsyncDatabaseWriter::commit_units(std::vector<Entry>& units, bool size_triggered) {
+    std::vector<DatabaseWriter::Record> rows;
+    const DatabaseWriter::RunProgress* progress = nullptr;
+    for (auto& unit : units) {
+        std::move(unit.rows.begin(), unit.rows.end(), std::back_inserter(rows));
+        if (!unit.progress.run_key.empty()) progress = &unit.progress;
+    }
+    
+    bool committed = (rows.empty() && !progress) ||
+                     commit_with_retries(rows, progress_failed ? nullptr : progress, size_triggered);
+    
+    // Each unit kept its size after its rows were moved out, so it still marks its range
+    size_t offset = 0;
+    for (auto& unit : units) {
+        std::move(rows.begin() + offset, rows.begin() + offset + unit.rows.size(), unit.rows.begin());
+        offset += unit.rows.size();
+    }
+    
+    // A group that still fails is split so one bad result cannot take the others with it;
+    // each unit keeps its own mark, and none are stored after the first dropped unit
+    if (!committed) {
+        size_t result_count = std::count_if(units.begin(), units.end(),
+                                            [](const Entry& unit) { return !unit.flush_marker; });
+        size_t dropped = 0;
+        for (const auto& unit : units) {
+            if (unit.flush_marker) continue;
+            const DatabaseWriter::RunProgress* unit_progress = 
+                unit.progress.run_key.empty() || progress_failed ? nullptr : &unit.progress;
+            if (unit.rows.empty() && !unit_progress) continue;
+            if (result_count > 1 && commit_with_retries(unit.rows, unit_progress, size_triggered)) continue;
+            
+            progress_failed = true;
+            if (unit.rows.empty()) continue;    // Only a mark was lost
+            dropped += unit.rows.size();
+            Logger::error("AsyncDatabaseWriter: dropping " + std::to_string(unit.rows.size()) + 
+                         " rows of " + unit.rows.front().filename + " after " + 
+                         std::to_string(config.commit_retries) + " retries");
+        }
+        
+        std::lock_guard<std::mutex> lock(metrics_mutex);
+        metrics.failed_rows += dropped;
+        unreported_failed_rows += dropped;
+    }
+    
+    // Committed or dropped, these rows are no longer queued
+    for (const auto& unit : units) {
+        track_content(unit.rows, false);
+    }
+    units.clear();
+}
+
+bool AsyncDatabaseWriter::commit_with_retries(const std::vector<DatabaseWriter::Record>& rows,
+                                              const DatabaseWriter::RunProgress* progress, bool size_triggered) {
+    int backoff_ms = config.retry_backoff_ms;
+    for (int attempt = 0; ; ++attempt) {
+        Timer commit_timer;
+        commit_timer.start();
+        bool committed = writer.commit(rows, progress);
+        double latency_us = commit_timer.stop();
+        
+        Timer::profile_add("db_group_commit", latency_us);
+        
+        {
+            std::lock_guard<std::mutex> lock(metrics_mutex);
+            if (committed) {
+                metrics.commits++;
+                metrics.rows_committed += rows.size();
+                (size_triggered ? metrics.size_triggered_commits : metrics.time_triggered_commits)++;
+                metrics.last_commit_latency_us = latency_us;
+                metrics.max_commit_latency_us = std::max(metrics.max_commit_latency_us, latency_us);
+                metrics.average_commit_latency_us += 
+                    (latency_us - metrics.average_commit_latency_us) / metrics.commits;
+            } else {
+                metrics.failed_commits++;
+            }
+        }
+        
+        if (committed) return true;
+        if (attempt >= config.commit_retries) return false;
+        
+        // Busy or I/O errors are often transient; producers are held back meanwhile
+        Logger::warning("AsyncDatabaseWriter: commit of " + std::to_string(rows.size()) + 
+                       " rows failed, retrying in " + std::to_string(backoff_ms) + "ms");
+        std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+        backoff_ms *= 2;
+    }
+}
+
+AsyncDatabaseWriter::Metrics AsyncDatabaseWriter::get_metrics() const {
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+    Metrics snapshot = metrics;
+    if (queue) {
+        snapshot.queue_depth = queue->size();
+        snapshot.peak_queue_depth = queue->peak();
+    }
+    return snapshot;
+}
+
+std::string AsyncDatabaseWriter::format_metrics() const {
+    Metrics m = get_metrics();
+    std::ostringstream ss;
+    ss << m.rows_committed << " rows in " << m.commits << " commits"
+       << " (" << m.size_triggered_commits << " by size, " << m.time_triggered_commits << " by time, "
+       << m.failed_commits << " failed)"
+       << ", " << m.failed_rows << " rows dropped"
+       << ", commit latency avg " << Timer::format_time(m.average_commit_latency_us)
+       << " max " << Timer::format_time(m.max_commit_latency_us)
+       << ", queue depth " << m.queue_depth << " (peak " << m.peak_queue_depth << ")"
+       << ", producer wait " << Timer::format_time(m.producer_wait_us);
+    return ss.str();
+}
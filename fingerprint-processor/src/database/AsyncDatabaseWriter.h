@@ -0,0 +1,154 @@
+// AsyncDatabaseWriter.h - Dedicated database writer thread 
+#pragma once
+
+#include "DatabaseWriter.h"
+#include "../utils/ThreadSafeQueue.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * Single SQLite writer thread fed by a bounded queue
+ * Detector threads only enqueue; the writer group-commits whenever
+ * commit_rows rows are queued or commit_interval_ms has passed,
+ * and producers block (backpressure) when the queue is full
+ *
+ * The queue holds units: all rows of one detection result, which always land
+ * in the same transaction. A failed group commit is retried, then split into
+ * one transaction per unit so only the results that keep failing are lost;
+ * those are counted in Metrics::failed_rows and reported by flush().
+ *
+ * This is the only writer thread: DatabaseWriter itself is synchronous and is
+ * only called from here. A unit can carry a batch run's RunProgress, which is
+ * committed in the transaction holding that unit's rows; once rows have been
+ * dropped no further marks are stored, so a resumed run retries from before them.
+ */
+class AsyncDatabaseWriter {
+public:
+    struct Config {
+        DatabaseWriter::Config database;    // Connection settings (batch_size is unused here)
+        size_t queue_capacity;              // Max queued results before producers block
+        size_t commit_rows;                 // Group-commit size threshold
+        int commit_interval_ms;             // Group-commit time threshold
+        int commit_retries;                 // Retries of a failed group commit before splitting it
+        int retry_backoff_ms;               // Wait before the first retry, doubled each time
+        
+        Config() 
+            : queue_capacity(4096)
+            , commit_rows(1000)
+            , commit_interval_ms(200)
+            , commit_retries(3)
+            , retry_backoff_ms(50) {}
+    };
+    
+    // Exported writer metrics
+    struct Metrics {
+        size_t queue_depth;                 // Results currently queued
+        size_t peak_queue_depth;            // Highest queue depth seen
+        size_t rows_committed;
+        size_t commits;
+        size_t failed_commits;              // Transactions that failed (each retry counts)
+        size_t failed_rows;                 // Rows dropped after every retry failed
+        size_t size_triggered_commits;      // Commits started by the row threshold
+        size_t time_triggered_commits;      // Commits started by the interval
+        double last_commit_latency_us;
+        double average_commit_latency_us;
+        double max_commit_latency_us;
+        double producer_wait_us;            // Total time producers spent blocked on a full queue
+        
+        Metrics() : queue_depth(0), peak_queue_depth(0), rows_committed(0), commits(0),
+                    failed_commits(0), failed_rows(0), size_triggered_commits(0), time_triggered_commits(0),
+                    last_commit_latency_us(0), average_commit_latency_us(0),
+                    max_commit_latency_us(0), producer_wait_us(0) {}
+    };
+    
+    // The rows of one result
+    using Unit = std::vector<DatabaseWriter::Record>;
+
+private:
+    // One queued unit, its run's mark (run_key empty = none), or a flush() marker
+    struct Entry {
+        Unit rows;
+        DatabaseWriter::RunProgress progress;
+        bool flush_marker;
+        
+        Entry() : flush_marker(false) {}
+    };
+    
+    Config config;
+    DatabaseWriter writer;
+    std::unique_ptr<ThreadSafeQueue<Entry>> queue;
+    std::thread writer_thread;
+    std::atomic<bool> running;
+    
+    mutable std::mutex metrics_mutex;
+    Metrics metrics;
+    
+    // flush() tickets: a flush is done once the writer has passed that many markers
+    std::atomic<uint64_t> flushes_requested;
+    uint64_t flushes_completed;             // Guarded by metrics_mutex
+    size_t unreported_failed_rows;          // Guarded by metrics_mutex; reset by flush()
+    std::condition_variable flush_done;
+    
+    // Content hashes of rows submitted but not yet committed or dropped (counted, since
+    // a hash can be queued more than once)
+    std::mutex content_mutex;
+    std::unordered_map<uint64_t, size_t> queued_content;
+    
+    bool progress_failed;                   // Writer thread only: rows were dropped, marks are no longer stored
+    
+    bool enqueue(Entry&& entry);
+    void track_content(const Unit& rows, bool queued);
+    void writer_loop();
+    void commit_units(std::vector<Entry>& units, bool size_triggered);
+    bool commit_with_retries(const std::vector<DatabaseWriter::Record>& rows,
+                             const DatabaseWriter::RunProgress* progress, bool size_triggered);
+
+public:
+    AsyncDatabaseWriter() : running(false), flushes_requested(0), flushes_completed(0), unreported_failed_rows(0),
+                            progress_failed(false) {}
+    ~AsyncDatabaseWriter() { stop(); }
+    
+    AsyncDatabaseWriter(const AsyncDatabaseWriter&) = delete;
+    AsyncDatabaseWriter& operator=(const AsyncDatabaseWriter&) = delete;
+    
+    // Open the database and start the writer thread
+    bool start(const Config& writer_config = Config());
+    
+    // Stop accepting rows, commit everything queued and close the database
+    void stop();
+    bool is_running() const { return running; }
+    
+    // Enqueue all rows of a result (or the given rows) as one unit; blocks while
+    // the queue is full. Returns false after stop().
+    bool submit(const CorePointDetector::DetectionResult& result);
+    bool submit(Unit&& rows);
+    
+    // Enqueue an input's rows (none for a failed detection) with the run's progress mark
+    bool submit(const CorePointDetector::DetectionResult& result, const DatabaseWriter::RunProgress& progress);
+    bool submit(DatabaseWriter::Record&& record);
+    
+    // Non-blocking variant; returns false if the queue is full or stopped
+    bool try_submit(DatabaseWriter::Record&& record);
+    
+    // Commit everything submitted so far. False if rows were dropped since the
+    // previous flush() (see Metrics::failed_rows) or the writer is stopped.
+    bool flush();
+    
+    // A file with this content hash is stored or still queued
+    bool contains_content(uint64_t content_hash);
+    
+    // Progress committed for run_key by an earlier run (false if none)
+    bool load_progress(const std::string& run_key, DatabaseWriter::RunProgress& progress);
+    
+    // Commit everything submitted, then end a bulk load (DatabaseWriter::finish_bulk_load)
+    bool finish_bulk_load();
+    
+    const Config& get_config() const { return config; }
+    
+    Metrics get_metrics() const;
+    std::string format_metrics() const;
+};
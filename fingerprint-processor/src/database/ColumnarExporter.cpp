@@ -0,0 +1,344 @@
+// ColumnarExporter.cpp - ColumnarExporter implementation 
+#include "ColumnarExporter.h"
+#include "../utils/Logger.h"
+#include "../utils/Timer.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const size_t FEATURE_DIM = FeatureExtractor::FeatureVector::DIM;
+
+// Column order of the file (must match the chunks listed in write_row_group())
+const struct {
+    const char* name;
+    ColumnarExporter::ColumnType type;
+    uint16_t width;
+} COLUMNS[] = {
+    { "filename",           ColumnarExporter::ColumnType::STRING,  1 },
+    { "file_index",         ColumnarExporter::ColumnType::INT32,   1 },
+    { "core_rank",          ColumnarExporter::ColumnType::INT32,   1 },
+    { "core_x",             ColumnarExporter::ColumnType::FLOAT32, 1 },
+    { "core_y",             ColumnarExporter::ColumnType::FLOAT32, 1 },
+    { "confidence",         ColumnarExporter::ColumnType::FLOAT32, 1 },
+    { "quality",            ColumnarExporter::ColumnType::FLOAT32, 1 },
+    { "rotation",           ColumnarExporter::ColumnType::FLOAT32, 1 },
+    { "processing_time_us", ColumnarExporter::ColumnType::UINT64,  1 },
+    { "address_key",        ColumnarExporter::ColumnType::UINT64,  1 },
+    { "content_hash",       ColumnarExporter::ColumnType::UINT64,  1 },
+    { "roi_hash",           ColumnarExporter::ColumnType::UINT64,  2 },
+    { "feature_vector",     ColumnarExporter::ColumnType::FLOAT32, static_cast<uint16_t>(FEATURE_DIM) }
+};
+
+const size_t COLUMN_COUNT = sizeof(COLUMNS) / sizeof(COLUMNS[0]);
+
+void put_u16(uint8_t* dst, uint16_t value) {
+    dst[0] = static_cast<uint8_t>(value);
+    dst[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void put_u32(uint8_t* dst, uint32_t value) {
+    for (int i = 0; i < 4; ++i) dst[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void put_u64(uint8_t* dst, uint64_t value) {
+    for (int i = 0; i < 8; ++i) dst[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+size_t aligned(size_t size) {
+    return (size + ColumnarExporter::ALIGNMENT - 1) / ColumnarExporter::ALIGNMENT * ColumnarExporter::ALIGNMENT;
+}
+
+} // namespace
+
+void ColumnarExporter::Columns::clear() {
+    filename_offsets.assign(1, 0);
+    filename_bytes.clear();
+    file_index.clear();
+    core_rank.clear();
+    core_x.clear();
+    core_y.clear();
+    confidence.clear();
+    quality.clear();
+    rotation.clear();
+    processing_time_us.clear();
+    address_key.clear();
+    content_hash.clear();
+    roi_hash.clear();
+    features.clear();
+}
+
+bool ColumnarExporter::open(const Config& exporter_config) {
+    std::lock_guard<std::mutex> lock(mutex);
+    config = exporter_config;
+    
+    if (config.row_group_rows == 0) {
+        config.row_group_rows = 1;
+        Logger::warning("ColumnarExporter row group size must be positive, adjusted to 1");
+    }
+    
+    file.open(config.output_path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        Logger::error("ColumnarExporter: cannot create " + config.output_path);
+        return false;
+    }
+    
+    file_offset = 0;
+    row_groups.clear();
+    stats = ExportStats();
+    columns.clear();
+    
+    if (!write_header()) {
+        file.close();
+        return false;
+    }
+    
+    Logger::info("ColumnarExporter writing " + config.output_path + " (" +
+                std::to_string(config.row_group_rows) + " rows per row group)");
+    return true;
+}
+
+void ColumnarExporter::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open()) return;
+    
+    bool complete = (columns.rows() == 0 || write_row_group()) && write_footer();
+    file.close();
+    
+    if (complete) {
+        Logger::info("ColumnarExporter closed " + config.output_path + " (" + std::to_string(stats.rows_written) +
+                    " rows in " + std::to_string(stats.row_groups_written) + " row groups)");
+    } else {
+        Logger::error("ColumnarExporter: " + config.output_path + " is incomplete");
+    }
+}
+
+bool ColumnarExporter::write_bytes(const void* data, size_t size) {
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    if (!file) {
+        Logger::error("ColumnarExporter: write failed for " + config.output_path);
+        return false;
+    }
+    file_offset += size;
+    stats.bytes_written += size;
+    return true;
+}
+
+bool ColumnarExporter::write_padding() {
+    static const uint8_t zeros[ALIGNMENT] = {};
+    size_t padding = aligned(static_cast<size_t>(file_offset)) - static_cast<size_t>(file_offset);
+    return padding == 0 || write_bytes(zeros, padding);
+}
+
+bool ColumnarExporter::write_header() {
+    std::vector<uint8_t> header(64 + 32 * COLUMN_COUNT, 0);
+    put_u32(&header[0], MAGIC);
+    put_u16(&header[4], VERSION);
+    put_u16(&header[6], static_cast<uint16_t>(COLUMN_COUNT));
+    put_u32(&header[8], static_cast<uint32_t>(std::min<size_t>(config.row_group_rows, UINT32_MAX)));
+    
+    for (size_t i = 0; i < COLUMN_COUNT; ++i) {
+        uint8_t* descriptor = &header[64 + 32 * i];
+        descriptor[0] = static_cast<uint8_t>(COLUMNS[i].type);
+        put_u16(&descriptor[2], COLUMNS[i].width);
+        strncpy(reinterpret_cast<char*>(&descriptor[4]), COLUMNS[i].name, 27);
+    }
+    
+    return write_bytes(header.data(), header.size()) && write_padding();
+}
+
+void ColumnarExporter::append_row(const std::string& filename, int32_t file_index, int32_t core_rank,
+                                  float core_x, float core_y, float confidence, float quality, float rotation,
+                                  uint64_t processing_time_us, uint64_t address_key, uint64_t content_hash,
+                                  const CorePointDetector::RoiHash& roi_hash, const float* features,
+                                  size_t feature_count) {
+    columns.filename_bytes.insert(columns.filename_bytes.end(), filename.begin(), filename.end());
+    columns.filename_offsets.push_back(static_cast<uint32_t>(columns.filename_bytes.size()));
+    columns.file_index.push_back(file_index);
+    columns.core_rank.push_back(core_rank);
+    columns.core_x.push_back(core_x);
+    columns.core_y.push_back(core_y);
+    columns.confidence.push_back(confidence);
+    columns.quality.push_back(quality);
+    columns.rotation.push_back(rotation);
+    columns.processing_time_us.push_back(processing_time_us);
+    columns.address_key.push_back(address_key);
+    columns.content_hash.push_back(content_hash);
+    columns.roi_hash.push_back(roi_hash.bits[0]);
+    columns.roi_hash.push_back(roi_hash.bits[1]);
+    
+    // Vectors of another length are not valid FeatureVectors; store them as missing
+    size_t start = columns.features.size();
+    if (features && feature_count == FEATURE_DIM) {
+        columns.features.insert(columns.features.end(), features, features + FEATURE_DIM);
+    } else {
+        columns.features.resize(start + FEATURE_DIM, std::numeric_limits<float>::quiet_NaN());
+    }
+}
+
+bool ColumnarExporter::write(const std::vector<DatabaseWriter::Record>& records) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open()) {
+        Logger::error("ColumnarExporter: write attempted on closed file");
+        return false;
+    }
+    
+    for (const auto& record : records) {
+        uint64_t address_key = 0;
+        if (record.address.text[0] != '\0') {
+            AddressGenerator::address_key(record.address.c_str(), address_key);
+        }
+        
+        append_row(record.filename, record.file_index, record.core_rank, record.core_x, record.core_y,
+                   record.confidence, record.quality, record.rotation, record.processing_time_us,
+                   address_key, record.content_hash, record.roi_hash,
+                   record.feature_vector.data(), record.feature_vector.size());
+        
+        if (columns.rows() >= config.row_group_rows && !write_row_group()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ColumnarExporter::write(const CorePointDetector::DetectionResult& result) {
+    if (!result.success) return true; // Same rows as DatabaseWriter: failed detections have none
+    
+    // Describe the ROIs before taking the lock, so callers on several threads overlap here
+    const size_t cores = result.core_points.size();
+    const bool describe = config.describe_rois;
+    std::vector<uint64_t> address_keys(cores, 0);
+    std::vector<FeatureExtractor::FeatureVector> features(describe ? cores : 0);
+    if (describe) {
+        FeatureExtractor::PatternClassification pattern = FeatureExtractor::classify_pattern(result);
+        for (size_t i = 0; i < cores; ++i) {
+            const CorePointDetector::ROI& roi = (i == 0) ? result.extracted_roi : result.secondary_rois.at(i - 1);
+            AddressGenerator::Address address;
+            DatabaseWriter::describe_roi(roi, pattern, extractor, address, features[i]);
+            AddressGenerator::address_key(address.c_str(), address_keys[i]);
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open()) {
+        Logger::error("ColumnarExporter: write attempted on closed file");
+        return false;
+    }
+    
+    for (size_t i = 0; i < cores; ++i) {
+        const CorePointDetector::ROI& roi = (i == 0) ? result.extracted_roi : result.secondary_rois.at(i - 1);
+        const CorePointDetector::CorePoint& core = result.core_points[i];
+        
+        append_row(roi.filename, roi.file_index, static_cast<int32_t>(i), core.x, core.y, core.confidence,
+                   result.overall_quality, roi.rotation, result.processing_time_us,
+                   address_keys[i], result.content_hash, roi.hash,
+                   describe ? features[i].values : nullptr, FEATURE_DIM);
+        
+        if (columns.rows() >= config.row_group_rows && !write_row_group()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ColumnarExporter::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open()) return false;
+    if (columns.rows() > 0 && !write_row_group()) return false;
+    
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+bool ColumnarExporter::write_row_group() {
+    Timer write_timer;
+    write_timer.start();
+    
+    size_t rows = columns.rows();
+    
+    // Chunks in COLUMNS order; the string column is its offsets followed by its bytes
+    struct Chunk {
+        const void* data;
+        size_t size;
+        const void* extra_data;
+        size_t extra_size;
+    };
+    const Chunk chunks[COLUMN_COUNT] = {
+        { columns.filename_offsets.data(), columns.filename_offsets.size() * sizeof(uint32_t),
+          columns.filename_bytes.data(), columns.filename_bytes.size() },
+        { columns.file_index.data(), rows * sizeof(int32_t), nullptr, 0 },
+        { columns.core_rank.data(), rows * sizeof(int32_t), nullptr, 0 },
+        { columns.core_x.data(), rows * sizeof(float), nullptr, 0 },
+        { columns.core_y.data(), rows * sizeof(float), nullptr, 0 },
+        { columns.confidence.data(), rows * sizeof(float), nullptr, 0 },
+        { columns.quality.data(), rows * sizeof(float), nullptr, 0 },
+        { columns.rotation.data(), rows * sizeof(float), nullptr, 0 },
+        { columns.processing_time_us.data(), rows * sizeof(uint64_t), nullptr, 0 },
+        { columns.address_key.data(), rows * sizeof(uint64_t), nullptr, 0 },
+        { columns.content_hash.data(), rows * sizeof(uint64_t), nullptr, 0 },
+        { columns.roi_hash.data(), rows * 2 * sizeof(uint64_t), nullptr, 0 },
+        { columns.features.data(), rows * FEATURE_DIM * sizeof(float), nullptr, 0 }
+    };
+    
+    if (columns.filename_bytes.size() > UINT32_MAX) {
+        Logger::error("ColumnarExporter: filename column exceeds 4 GiB in one row group; lower row_group_rows");
+        return false;
+    }
+    
+    RowGroupEntry entry;
+    entry.offset = file_offset;
+    entry.rows = static_cast<uint32_t>(rows);
+    
+    std::vector<uint8_t> header(16 + 16 * COLUMN_COUNT, 0);
+    put_u32(&header[0], ROW_GROUP_MAGIC);
+    put_u32(&header[4], entry.rows);
+    for (size_t i = 0; i < COLUMN_COUNT; ++i) {
+        uint32_t crc = RoiCodec::crc32c(chunks[i].data, chunks[i].size);
+        crc = RoiCodec::crc32c(chunks[i].extra_data, chunks[i].extra_size, crc);
+        put_u64(&header[16 + 16 * i], chunks[i].size + chunks[i].extra_size);
+        put_u32(&header[16 + 16 * i + 8], crc);
+    }
+    
+    if (!write_bytes(header.data(), header.size()) || !write_padding()) return false;
+    
+    for (const Chunk& chunk : chunks) {
+        if (!write_bytes(chunk.data, chunk.size)) return false;
+        if (chunk.extra_size > 0 && !write_bytes(chunk.extra_data, chunk.extra_size)) return false;
+        if (!write_padding()) return false;
+    }
+    
+    row_groups.push_back(entry);
+    columns.clear();
+    
+    double elapsed_us = write_timer.stop();
+    stats.rows_written += rows;
+    stats.row_groups_written++;
+    stats.total_write_time_us += elapsed_us;
+    Timer::profile_add("columnar_row_group", elapsed_us);
+    return true;
+}
+
+bool ColumnarExporter::write_footer() {
+    std::vector<uint8_t> footer(16 * row_groups.size() + TRAILER_SIZE, 0);
+    for (size_t i = 0; i < row_groups.size(); ++i) {
+        put_u64(&footer[16 * i], row_groups[i].offset);
+        put_u32(&footer[16 * i + 8], row_groups[i].rows);
+    }
+    
+    uint8_t* trailer = &footer[16 * row_groups.size()];
+    put_u64(&trailer[0], stats.rows_written);
+    put_u32(&trailer[8], static_cast<uint32_t>(row_groups.size()));
+    put_u32(&trailer[12], RoiCodec::crc32c(footer.data(), 16 * row_groups.size()));
+    put_u32(&trailer[16], VERSION);
+    put_u32(&trailer[20], MAGIC);
+    
+    if (!write_bytes(footer.data(), footer.size())) return false;
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+ColumnarExporter::ExportStats ColumnarExporter::get_stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,152 @@
+// ColumnarExporter.h - Column-oriented binary export of detection results 
+#pragma once
+
+#include "DatabaseWriter.h"
+#include "../core/FeatureExtractor.h"
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Export sink writing one row per detected core (the rows of the rois table,
+ * without the ROI pixels) to a column-oriented binary file for analytics
+ * Values are appended straight into per-column buffers and written as large
+ * row groups; no per-row strings or objects are built. The buffers grow with the
+ * first row group and keep their capacity for the following ones.
+ *
+ * File layout (little-endian; every block starts on a 64-byte boundary):
+ *   File header, 64 bytes + 32 per column, zero padded
+ *     0  uint32  magic          'FCOL'
+ *     4  uint16  version        1
+ *     6  uint16  column_count
+ *     8  uint32  row_group_rows configured rows per row group (the last may be shorter)
+ *    64  column descriptors, 32 bytes each:
+ *          uint8 type (ColumnType), uint8 0, uint16 width (values per row), char name[28] (NUL padded)
+ *   Row groups
+ *     0  uint32  magic          'FRGP'
+ *     4  uint32  row_count
+ *     8  uint64  0
+ *    16  chunk directory, 16 bytes per column: uint64 byte_size, uint32 CRC32C, uint32 0
+ *        then one chunk per column, each padded to 64 bytes:
+ *          INT32/UINT64/FLOAT32: row_count x width values
+ *          STRING: (row_count + 1) uint32 offsets into the bytes that follow (not NUL terminated)
+ *   Footer
+ *        one 16-byte entry per row group: uint64 file offset, uint32 row_count, uint32 0
+ *   Trailer, last 24 bytes
+ *     0  uint64  total_rows
+ *     8  uint32  row_group_count
+ *    12  uint32  CRC32C of the footer entries
+ *    16  uint32  version
+ *    20  uint32  magic          'FCOL'
+ *
+ * Readers locate the footer from the trailer and can then read or memory-map
+ * any column of any row group directly. The footer is written by close(), so a
+ * file without a valid trailer is incomplete (the run did not finish).
+ */
+class ColumnarExporter {
+public:
+    enum class ColumnType : uint8_t {
+        INT32 = 1,
+        UINT64 = 2,
+        FLOAT32 = 3,
+        STRING = 4
+    };
+    
+    static constexpr uint32_t MAGIC = 0x4C4F4346;          // "FCOL"
+    static constexpr uint32_t ROW_GROUP_MAGIC = 0x50475246; // "FRGP"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t TRAILER_SIZE = 24;
+    
+    struct Config {
+        std::string output_path;            // Created or truncated by open()
+        size_t row_group_rows;              // Rows buffered per row group (~270 bytes each)
+        bool describe_rois;                 // write(result): compute address and feature vector per ROI
+        
+        Config()
+            : output_path("fingerprints.fcol")
+            , row_group_rows(1 << 16)
+            , describe_rois(true) {}
+    };
+    
+    struct ExportStats {
+        size_t rows_written;
+        size_t row_groups_written;
+        uint64_t bytes_written;
+        double total_write_time_us;
+        
+        ExportStats() : rows_written(0), row_groups_written(0), bytes_written(0), total_write_time_us(0) {}
+    };
+
+private:
+    // Row-group buffers, one per column (feature vectors are NaN when not extracted)
+    struct Columns {
+        std::vector<uint32_t> filename_offsets;
+        std::vector<char> filename_bytes;
+        std::vector<int32_t> file_index;
+        std::vector<int32_t> core_rank;
+        std::vector<float> core_x;
+        std::vector<float> core_y;
+        std::vector<float> confidence;
+        std::vector<float> quality;
+        std::vector<float> rotation;
+        std::vector<uint64_t> processing_time_us;
+        std::vector<uint64_t> address_key;  // 0 = no address
+        std::vector<uint64_t> content_hash; // 0 = unknown
+        std::vector<uint64_t> roi_hash;     // 2 words per row, 0 = not computed
+        std::vector<float> features;        // FeatureVector::DIM floats per row
+        
+        size_t rows() const { return file_index.size(); }
+        void clear();
+    };
+    
+    struct RowGroupEntry {
+        uint64_t offset;
+        uint32_t rows;
+    };
+    
+    Config config;
+    std::ofstream file;
+    uint64_t file_offset;
+    Columns columns;
+    std::vector<RowGroupEntry> row_groups;
+    ExportStats stats;
+    FeatureExtractor extractor;
+    std::mutex mutex;
+    
+    void append_row(const std::string& filename, int32_t file_index, int32_t core_rank,
+                    float core_x, float core_y, float confidence, float quality, float rotation,
+                    uint64_t processing_time_us, uint64_t address_key, uint64_t content_hash,
+                    const CorePointDetector::RoiHash& roi_hash, const float* features, size_t feature_count);
+    
+    bool write_bytes(const void* data, size_t size);
+    bool write_padding();                   // Zero-fill up to the next ALIGNMENT boundary
+    bool write_header();
+    bool write_row_group();                 // Writes and clears the buffered rows
+    bool write_footer();
+
+public:
+    ColumnarExporter() : file_offset(0) {}
+    ~ColumnarExporter() { close(); }
+    
+    ColumnarExporter(const ColumnarExporter&) = delete;
+    ColumnarExporter& operator=(const ColumnarExporter&) = delete;
+    
+    bool open(const Config& exporter_config = Config());
+    void close();                           // Writes the last row group and the footer
+    bool is_open() const { return file.is_open(); }
+    
+    // Append one row per core; a row group is written whenever row_group_rows are buffered.
+    // Records carry their own address and feature vector (see DatabaseWriter::make_records
+    // with an extractor); results are described here when Config::describe_rois is set
+    bool write(const std::vector<DatabaseWriter::Record>& records);
+    bool write(const CorePointDetector::DetectionResult& result);
+    
+    // Write the buffered rows as a (short) row group now
+    bool flush();
+    
+    ExportStats get_stats();
+    const Config& get_config() const { return config; }
+};
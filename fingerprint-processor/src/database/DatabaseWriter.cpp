@@ -1,2 +1,600 @@
-// DatabaseWriter.cpp - DatabaseWriter implementation 
-// Implementation placeholder 
+// DatabaseWriter.cpp - DatabaseWriter implementation 
+// Implementation placeholder 
+#include "DatabaseWriter.h"
+#include "../utils/Logger.h"
+#include "../utils/Timer.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <tuple>
+
+static const char* const ROI_TABLE_SCHEMA = R"SQL(
+CREATE TABLE IF NOT EXISTS rois (
+    id                 INTEGER PRIMARY KEY,
+    filename           TEXT    NOT NULL,
+    file_index         INTEGER NOT NULL,
+    core_rank          INTEGER NOT NULL,
+    core_x             REAL    NOT NULL,
+    core_y             REAL    NOT NULL,
+    confidence         REAL    NOT NULL,
+    quality            REAL    NOT NULL,
+    rotation           REAL    NOT NULL,
+    processing_time_us INTEGER NOT NULL,
+    roi                BLOB    NOT NULL,
+    address            TEXT,
+    address_key        INTEGER,
+    feature_vector     BLOB,
+    roi_hash           BLOB,
+    content_hash       INTEGER
+);
+CREATE TABLE IF NOT EXISTS run_progress (
+    run_key          TEXT    PRIMARY KEY,
+    last_input       TEXT    NOT NULL,
+    inputs_committed INTEGER NOT NULL,
+    last_row_id      INTEGER NOT NULL DEFAULT 0
+);
+)SQL";
+
+// Secondary indexes (deferred until finish_bulk_load() in bulk-load mode)
+static const char* const ROI_INDEX_SCHEMA = R"SQL(
+CREATE INDEX IF NOT EXISTS idx_rois_filename ON rois(filename);
+CREATE INDEX IF NOT EXISTS idx_rois_address_key ON rois(address_key);
+CREATE INDEX IF NOT EXISTS idx_rois_content_hash ON rois(content_hash);
+)SQL";
+
+static const char* const ROI_INDEX_DROP = R"SQL(
+DROP INDEX IF EXISTS idx_rois_filename;
+DROP INDEX IF EXISTS idx_rois_address_key;
+DROP INDEX IF EXISTS idx_rois_content_hash;
+)SQL";
+
+static const char* const ROI_INSERT_SQL = 
+    "INSERT INTO rois (filename, file_index, core_rank, core_x, core_y, confidence, "
+    "quality, rotation, processing_time_us, roi, address, address_key, feature_vector, roi_hash, "
+    "content_hash) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14, ?15);";
+
+// Columns added after the first schema version, in the order they were introduced
+static const struct {
+    const char* table;
+    const char* name;
+    const char* type;
+} ADDED_COLUMNS[] = {
+    { "rois",         "address",        "TEXT" },
+    { "rois",         "address_key",    "INTEGER" },
+    { "rois",         "feature_vector", "BLOB" },
+    { "rois",         "roi_hash",       "BLOB" },
+    { "rois",         "content_hash",   "INTEGER" },
+    { "run_progress", "last_row_id",    "INTEGER NOT NULL DEFAULT 0" }
+};
+
+// Mark stored by bulk transactions that were queued without one
+static const char* const ANONYMOUS_RUN_KEY = "";
+
+bool DatabaseWriter::open(const Config& writer_config) {
+    if (is_open()) {
+        close();
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    config = writer_config;
+    
+    if (config.batch_size == 0) {
+        config.batch_size = 1;
+        Logger::warning("DatabaseWriter batch size must be positive, adjusted to 1");
+    }
+    
+    if (!db.open(config.database_path)) {
+        return false;
+    }
+    
+    bulk_resumed = false;
+    bulk_failed = false;
+    progress_failed = false;
+    pending.clear();
+    pending_progress = RunProgress();
+    bulk_content.clear();
+    
+    if (!create_schema() || !configure_connection()) {
+        db.close();
+        return false;
+    }
+    
+    SQLiteStatement last_row;
+    if (!db.prepare(last_row, "SELECT COALESCE(MAX(id), 0) FROM rois;") || last_row.step() != SQLITE_ROW) {
+        db.close();
+        return false;
+    }
+    committed_row_id = last_row.column_int64(0);
+    last_row.finalize();
+    
+    bool ready = config.bulk_load ? begin_bulk_load() : create_indexes();
+    if (!ready || !prepare_statements()) {
+        db.close();
+        return false;
+    }
+    
+    Logger::info("DatabaseWriter opened " + config.database_path + 
+                " (batch size " + std::to_string(config.batch_size) + 
+                ", ROI encoding " + RoiCodec::compression_name(config.roi_compression) + ")");
+    return true;
+}
+
+void DatabaseWriter::close() {
+    if (!db.is_open()) return;
+    
+    flush();
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    insert_statement.finalize();
+    content_statement.finalize();
+    begin_statement.finalize();
+    commit_statement.finalize();
+    rollback_statement.finalize();
+    progress_statement.finalize();
+    db.close();
+    
+    Logger::info("DatabaseWriter closed (" + std::to_string(stats.rows_written) + " rows in " +
+                std::to_string(stats.transactions_committed) + " transactions)");
+}
+
+bool DatabaseWriter::create_schema() {
+    return db.exec(ROI_TABLE_SCHEMA) && migrate_schema();
+}
+
+bool DatabaseWriter::migrate_schema() {
+    // Databases created by older versions lack the columns added since
+    SQLiteStatement columns;
+    if (!db.prepare(columns, "SELECT 1 FROM pragma_table_info(?1) WHERE name = ?2;")) {
+        return false;
+    }
+    
+    for (const auto& column : ADDED_COLUMNS) {
+        columns.reset();
+        columns.bind_text(1, column.table, strlen(column.table));
+        columns.bind_text(2, column.name, strlen(column.name));
+        if (columns.step() == SQLITE_ROW) continue;
+        
+        Logger::info(std::string("Adding column ") + column.table + "." + column.name + " to " + config.database_path);
+        if (!db.exec(std::string("ALTER TABLE ") + column.table + " ADD COLUMN " + column.name + " " + column.type + ";")) {
+            return false;
+        }
+    }
+    
+    // Bulk-load checkpoints now live in run_progress
+    return db.exec("DROP TABLE IF EXISTS bulk_load_state;");
+}
+
+bool DatabaseWriter::create_indexes() {
+    return db.exec(ROI_INDEX_SCHEMA);
+}
+
+bool DatabaseWriter::configure_connection() {
+    if (config.bulk_load) {
+        // No rollback journal and no fsync; crash recovery relies on the stored marks
+        db.pragma("journal_mode", "OFF");
+        db.pragma("synchronous", "OFF");
+        db.pragma("cache_size", std::to_string(-config.bulk_cache_size_kb)); // Negative = KiB
+    } else {
+        if (config.wal_mode && db.pragma("journal_mode", "WAL") != "wal") {
+            Logger::warning("WAL journal mode not available for " + config.database_path);
+        }
+        db.pragma("synchronous", config.synchronous_normal ? "NORMAL" : "FULL");
+        db.pragma("cache_size", std::to_string(-config.cache_size_kb)); // Negative = KiB
+    }
+    db.pragma("temp_store", "MEMORY");
+    return true;
+}
+
+bool DatabaseWriter::begin_bulk_load() {
+    // Only a bulk load leaves the secondary indexes missing (every other open and
+    // finish_bulk_load() create them); with a stored mark, that load is unfinished
+    SQLiteStatement state;
+    if (!db.prepare(state, "SELECT (SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND "
+                           "name = 'idx_rois_content_hash'), COUNT(*), COALESCE(MAX(last_row_id), 0) "
+                           "FROM run_progress;") ||
+        state.step() != SQLITE_ROW) {
+        return false;
+    }
+    bulk_resumed = state.column_int(0) == 0 && state.column_int64(1) > 0;
+    int64_t last_row_id = state.column_int64(2);
+    state.finalize();
+    
+    if (bulk_resumed) {
+        // Without a journal a crash can leave torn pages; refuse to build on them
+        SQLiteStatement check;
+        if (!db.prepare(check, "PRAGMA quick_check;") || check.step() != SQLITE_ROW || 
+            check.column_text(0) != "ok") {
+            Logger::error("Bulk load cannot resume: " + config.database_path + 
+                         " failed integrity check, restart the load from scratch");
+            return false;
+        }
+        check.finalize();
+        
+        // Drop rows from the transaction that was in flight when the previous run died
+        if (!db.exec("DELETE FROM rois WHERE id > " + std::to_string(last_row_id) + ";")) {
+            return false;
+        }
+        committed_row_id = last_row_id;
+        
+        Logger::info("Resuming bulk load of " + config.database_path + " after row " + std::to_string(last_row_id));
+    } else {
+        // Fresh load: mark the rows already present before their indexes go
+        SQLiteStatement watermark;
+        if (!db.prepare(watermark, "INSERT OR REPLACE INTO run_progress (run_key, last_input, inputs_committed, "
+                                   "last_row_id) VALUES (?1, '', 0, ?2);") ||
+            !watermark.bind_text(1, ANONYMOUS_RUN_KEY) || !watermark.bind_int64(2, committed_row_id) ||
+            !watermark.execute()) {
+            return false;
+        }
+    }
+    
+    // contains_content() answers from memory until idx_rois_content_hash is rebuilt
+    SQLiteStatement hashes;
+    if (!db.prepare(hashes, "SELECT content_hash FROM rois WHERE content_hash IS NOT NULL;")) {
+        return false;
+    }
+    int rc;
+    while ((rc = hashes.step()) == SQLITE_ROW) {
+        bulk_content.insert(static_cast<uint64_t>(hashes.column_int64(0)));
+    }
+    if (rc != SQLITE_DONE) return false;
+    hashes.finalize();
+    
+    return db.exec(ROI_INDEX_DROP);
+}
+
+bool DatabaseWriter::store_progress(const RunProgress& progress, int64_t last_row_id) {
+    progress_statement.bind_text(1, progress.run_key);
+    progress_statement.bind_text(2, progress.last_input);
+    progress_statement.bind_int64(3, progress.inputs_committed);
+    progress_statement.bind_int64(4, last_row_id);
+    return progress_statement.execute();
+}
+
+bool DatabaseWriter::finish_bulk_load() {
+    if (!config.bulk_load) return true;
+    
+    if (!flush()) return false;
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (bulk_failed) {
+        Logger::error("Bulk load had failed transactions; not finalizing " + config.database_path);
+        return false;
+    }
+    
+    Timer index_timer;
+    index_timer.start();
+    
+    // The indexes mark the load complete; the anonymous mark is no longer needed
+    if (!create_indexes() || !db.exec("ANALYZE;") ||
+        !db.exec(std::string("DELETE FROM run_progress WHERE run_key = '") + ANONYMOUS_RUN_KEY + "';")) {
+        return false;
+    }
+    
+    Logger::info("Bulk load finished at row " + std::to_string(committed_row_id) + 
+                ", indexes rebuilt and analyzed in " + Timer::format_time(index_timer.stop()));
+    
+    // Back to the normal, crash-safe settings for any further writes
+    config.bulk_load = false;
+    bulk_content = std::unordered_set<uint64_t>();
+    configure_connection();
+    return true;
+}
+
+bool DatabaseWriter::prepare_statements() {
+    return db.prepare(insert_statement, ROI_INSERT_SQL) &&
+           db.prepare(content_statement, "SELECT 1 FROM rois WHERE content_hash = ?1 LIMIT 1;") &&
+           db.prepare(begin_statement, "BEGIN IMMEDIATE;") &&
+           db.prepare(commit_statement, "COMMIT;") &&
+           db.prepare(rollback_statement, "ROLLBACK;") &&
+           db.prepare(progress_statement,
+                      "INSERT OR REPLACE INTO run_progress (run_key, last_input, inputs_committed, last_row_id) "
+                      "VALUES (?1, ?2, ?3, ?4);");
+}
+
+void DatabaseWriter::describe_roi(const CorePointDetector::ROI& roi,
+                                  const FeatureExtractor::PatternClassification& pattern,
+                                  const FeatureExtractor& extractor,
+                                  AddressGenerator::Address& address,
+                                  FeatureExtractor::FeatureVector& features) {
+    FeatureExtractor::BinaryROI binary;
+    extractor.binarize(roi, binary);
+    FeatureExtractor::RidgeDensity ridge = extractor.compute_ridge_density(binary);
+    FeatureExtractor::MinutiaeResult minutiae = extractor.extract_minutiae(binary);
+    FeatureExtractor::ZernikeMoments zernike = extractor.compute_zernike_moments(roi);
+    
+    address = AddressGenerator::generate(AddressGenerator::make_features(pattern, ridge, minutiae, zernike));
+    features = FeatureExtractor::make_feature_vector(ridge, minutiae, zernike);
+}
+
+std::vector<DatabaseWriter::Record> DatabaseWriter::make_records(
+    const CorePointDetector::DetectionResult& result,
+    RoiCodec::Compression compression,
+    const FeatureExtractor* extractor) {
+    
+    std::vector<Record> records;
+    if (!result.success) return records;
+    
+    // One classification per print: every core of it shares the pattern class
+    FeatureExtractor::PatternClassification pattern;
+    if (extractor) pattern = FeatureExtractor::classify_pattern(result);
+    
+    records.reserve(result.core_points.size());
+    for (size_t i = 0; i < result.core_points.size(); ++i) {
+        const CorePointDetector::ROI& roi = (i == 0) ? result.extracted_roi : result.secondary_rois.at(i - 1);
+        const CorePointDetector::CorePoint& core = result.core_points[i];
+        
+        Record record;
+        record.filename = roi.filename;
+        record.file_index = roi.file_index;
+        record.core_rank = static_cast<int32_t>(i);
+        record.core_x = core.x;
+        record.core_y = core.y;
+        record.confidence = core.confidence;
+        record.quality = result.overall_quality;
+        record.rotation = roi.rotation;
+        record.processing_time_us = result.processing_time_us;
+        record.roi_hash = roi.hash;
+        record.content_hash = result.content_hash;
+        RoiCodec::encode(roi.pixels, record.roi_blob, compression);
+        
+        if (extractor) {
+            FeatureExtractor::FeatureVector features;
+            describe_roi(roi, pattern, *extractor, record.address, features);
+            record.feature_vector.assign(features.values, features.values + FeatureExtractor::FeatureVector::DIM);
+        }
+        
+        records.push_back(std::move(record));
+    }
+    
+    return records;
+}
+
+std::vector<DatabaseWriter::Record> DatabaseWriter::to_records(const CorePointDetector::DetectionResult& result) const {
+    return make_records(result, config.roi_compression, config.describe_rois ? &extractor : nullptr);
+}
+
+bool DatabaseWriter::write(const CorePointDetector::DetectionResult& result) {
+    if (!result.success) return true; // Nothing to persist for failed detections
+    return write(to_records(result));
+}
+
+bool DatabaseWriter::write(const Record& record) {
+    std::vector<Record> records;
+    records.push_back(record);
+    return write(std::move(records));
+}
+
+bool DatabaseWriter::write(std::vector<Record>&& records) {
+    return queue(std::move(records), nullptr);
+}
+
+bool DatabaseWriter::write(const CorePointDetector::DetectionResult& result, const RunProgress& progress) {
+    return queue(to_records(result), &progress);
+}
+
+bool DatabaseWriter::queue(std::vector<Record>&& records, const RunProgress* progress) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!db.is_open()) {
+        Logger::error("DatabaseWriter: write attempted on closed database");
+        return false;
+    }
+    
+    for (auto& record : records) {
+        pending.push_back(std::move(record));
+    }
+    if (progress) {
+        pending_progress = *progress;
+    }
+    
+    if (pending.size() < config.batch_size) {
+        return true;
+    }
+    return commit_pending();
+}
+
+bool DatabaseWriter::commit_pending() {
+    // Rows of a failed transaction are not retried, so later marks would skip past
+    // them; progress stays at the last mark committed before the failure
+    const RunProgress* progress = pending_progress.run_key.empty() || progress_failed ? nullptr : &pending_progress;
+    bool committed = write_transaction(pending, progress);
+    if (!committed) {
+        progress_failed = true;
+    }
+    
+    pending.clear();
+    pending_progress = RunProgress();
+    return committed;
+}
+
+bool DatabaseWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    // A mark alone (trailing inputs without rows) is still worth a transaction
+    if (!db.is_open() || (pending.empty() && pending_progress.run_key.empty())) {
+        return true;
+    }
+    return commit_pending();
+}
+
+bool DatabaseWriter::load_progress(const std::string& run_key, RunProgress& progress) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!db.is_open()) return false;
+    
+    SQLiteStatement select;
+    if (!db.prepare(select, "SELECT last_input, inputs_committed FROM run_progress WHERE run_key = ?1;")) {
+        return false;
+    }
+    select.bind_text(1, run_key);
+    if (select.step() != SQLITE_ROW) return false;
+    
+    progress.run_key = run_key;
+    progress.last_input = select.column_text(0);
+    progress.inputs_committed = select.column_int64(1);
+    return true;
+}
+
+bool DatabaseWriter::commit(const std::vector<Record>& records, const RunProgress* progress) {
+    if (records.empty() && !progress) return true;
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    return write_transaction(records, progress);
+}
+
+bool DatabaseWriter::insert_record(const Record& record) {
+    insert_statement.bind_text(1, record.filename);
+    insert_statement.bind_int(2, record.file_index);
+    insert_statement.bind_int(3, record.core_rank);
+    insert_statement.bind_double(4, record.core_x);
+    insert_statement.bind_double(5, record.core_y);
+    insert_statement.bind_double(6, record.confidence);
+    insert_statement.bind_double(7, record.quality);
+    insert_statement.bind_double(8, record.rotation);
+    insert_statement.bind_int64(9, static_cast<int64_t>(record.processing_time_us));
+    insert_statement.bind_blob(10, record.roi_blob.data(), record.roi_blob.size());
+    
+    uint64_t address_key = 0;
+    if (record.address.text[0] != '\0' && AddressGenerator::address_key(record.address.c_str(), address_key)) {
+        insert_statement.bind_text(11, record.address.text, AddressGenerator::ADDRESS_LENGTH);
+        insert_statement.bind_int64(12, static_cast<int64_t>(address_key));
+    } else {
+        insert_statement.bind_null(11);
+        insert_statement.bind_null(12);
+    }
+    
+    if (!record.feature_vector.empty()) {
+        insert_statement.bind_blob(13, record.feature_vector.data(), record.feature_vector.size() * sizeof(float));
+    } else {
+        insert_statement.bind_null(13);
+    }
+    
+    if (!record.roi_hash.empty()) {
+        insert_statement.bind_blob(14, record.roi_hash.bits, sizeof(record.roi_hash.bits));
+    } else {
+        insert_statement.bind_null(14);
+    }
+    
+    // Stored as the signed 64-bit pattern (SQLite integers are signed)
+    if (record.content_hash != 0) {
+        insert_statement.bind_int64(15, static_cast<int64_t>(record.content_hash));
+    } else {
+        insert_statement.bind_null(15);
+    }
+    
+    return insert_statement.execute();
+}
+
+bool DatabaseWriter::write_transaction(const std::vector<Record>& records, const RunProgress* progress) {
+    if (!db.is_open()) {
+        Logger::error("DatabaseWriter: write attempted on closed database");
+        return false;
+    }
+    
+    Timer commit_timer;
+    commit_timer.start();
+    
+    if (config.bulk_load && bulk_failed) {
+        Logger::error("DatabaseWriter: bulk load stopped after a failed transaction; reopen to resume");
+        return false;
+    }
+    
+    // ROLLBACK is unreliable with journal_mode=OFF; a failed bulk transaction is
+    // instead discarded on the next open by trimming rows past the last mark
+    auto abort_transaction = [this]() {
+        if (config.bulk_load) {
+            bulk_failed = true;
+        } else {
+            rollback_statement.execute();
+        }
+        stats.failed_transactions++;
+        return false;
+    };
+    
+    if (!begin_statement.execute()) {
+        stats.failed_transactions++;
+        return false;
+    }
+    
+    if (config.bulk_load) {
+        // Insert in key order so the table and the (later) index are built by appends
+        std::vector<size_t> order(records.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&records](size_t a, size_t b) {
+            return std::tie(records[a].filename, records[a].core_rank) < 
+                   std::tie(records[b].filename, records[b].core_rank);
+        });
+        
+        for (size_t i : order) {
+            if (!insert_record(records[i])) {
+                Logger::error("DatabaseWriter: insert failed for " + records[i].filename + ": " + db.last_error());
+                return abort_transaction();
+            }
+        }
+    } else {
+        for (const auto& record : records) {
+            if (!insert_record(record)) {
+                Logger::error("DatabaseWriter: insert failed for " + record.filename + ": " + db.last_error());
+                return abort_transaction();
+            }
+        }
+    }
+    
+    // Every bulk transaction stores a mark, so a restart knows which rows are whole
+    int64_t last_row_id = records.empty() ? committed_row_id : db.last_insert_rowid();
+    RunProgress anonymous;
+    anonymous.run_key = ANONYMOUS_RUN_KEY;
+    if (!progress && config.bulk_load) {
+        progress = &anonymous;
+    }
+    if (progress && !store_progress(*progress, last_row_id)) {
+        return abort_transaction();
+    }
+    
+    if (!commit_statement.execute()) {
+        return abort_transaction();
+    }
+    
+    committed_row_id = last_row_id;
+    if (config.bulk_load) {
+        for (const auto& record : records) {
+            if (record.content_hash != 0) bulk_content.insert(record.content_hash);
+        }
+    }
+    
+    double elapsed_us = commit_timer.stop();
+    stats.rows_written += records.size();
+    stats.transactions_committed++;
+    stats.total_commit_time_us += elapsed_us;
+    Timer::profile_add("db_transaction", elapsed_us);
+    
+    return true;
+}
+
+DatabaseWriter::WriterStats DatabaseWriter::get_stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool DatabaseWriter::contains_content(uint64_t content_hash) {
+    if (content_hash == 0) return false;
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& record : pending) {
+        if (record.content_hash == content_hash) return true;
+    }
+    if (config.bulk_load) {
+        return bulk_content.count(content_hash) > 0;
+    }
+    if (!content_statement.is_prepared()) return false;
+    
+    content_statement.reset();
+    content_statement.bind_int64(1, static_cast<int64_t>(content_hash));
+    bool found = content_statement.step() == SQLITE_ROW;
+    content_statement.reset();
+    return found;
+}
+
+size_t DatabaseWriter::pending_count() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
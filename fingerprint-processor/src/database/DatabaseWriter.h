@@ -1,2 +1,211 @@
-// DatabaseWriter.h - Batch database operations 
-// Implementation placeholder 
+// DatabaseWriter.h - Batch database operations 
+// Implementation placeholder 
+#pragma once
+
+#include "SQLiteAdapter.h"
+#include "RoiCodec.h"
+#include "../core/CorePointDetector.h"
+#include "../core/AddressGenerator.h"
+#include "../core/FeatureExtractor.h"
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+
+/**
+ * Batched SQLite writer for detection results
+ * One row per detected core: core point, quality, timings and the 101x101 ROI
+ * (stored as a RoiCodec BLOB: versioned header, optionally compressed, checksummed)
+ * Biological addresses are stored with their order-preserving integer key, indexed
+ * so that prefix lookups (AddressIndex) are range scans; feature vectors are stored
+ * as raw float BLOBs for bulk loading into the in-memory VectorIndex, ROI hashes
+ * as 16-byte BLOBs for the HammingIndex, and the source file's content hash
+ * (indexed) so byte-identical files can be skipped before they are processed
+ * Rows are buffered and committed in multi-row transactions through reused
+ * prepared statements, with WAL journaling and synchronous=NORMAL
+ * Synchronous: the write that fills a batch commits it on the calling thread, under
+ * the same lock as every other write, so batches commit in the order rows arrived.
+ * AsyncDatabaseWriter puts a writer thread in front of this for detector threads.
+ * Batch runs can queue a RunProgress with each input's rows; it is stored in the
+ * run_progress table by the same transaction, so a stored mark never covers rows
+ * that have not been committed. Each mark also records the highest committed row
+ * id, which is all a crashed bulk load needs to discard its torn transaction
+ */
+class DatabaseWriter {
+public:
+    struct Config {
+        std::string database_path;          // SQLite file to create or append to
+        size_t batch_size;                  // Rows per transaction
+        bool wal_mode;                      // journal_mode=WAL (readers never block the writer)
+        bool synchronous_normal;            // synchronous=NORMAL (fsync only at WAL checkpoints)
+        int cache_size_kb;                  // Page cache size for this connection
+        RoiCodec::Compression roi_compression; // ROI BLOB compression (raw if not built in)
+        bool describe_rois;                 // Store each result ROI's address and feature vector
+        
+        // Bulk-load mode for initial ingestion: secondary indexes are dropped and rebuilt
+        // by finish_bulk_load(), journaling and fsync are off, each transaction's rows are
+        // inserted in key order, and every transaction stores a run_progress mark
+        // (an anonymous one if none was queued) with its last row id
+        bool bulk_load;
+        int bulk_cache_size_kb;             // Page cache size while bulk loading
+        
+        Config() 
+            : database_path("fingerprints.db")
+            , batch_size(1000)
+            , wal_mode(true)
+            , synchronous_normal(true)
+            , cache_size_kb(64 * 1024)
+            , roi_compression(RoiCodec::best_available())
+            , describe_rois(true)
+            , bulk_load(false)
+            , bulk_cache_size_kb(1024 * 1024) {}
+    };
+    
+    // One database row (a single core point and its ROI)
+    struct Record {
+        std::string filename;
+        int32_t file_index;
+        int32_t core_rank;                  // 0 = primary core, 1.. = secondary cores
+        float core_x, core_y;
+        float confidence;
+        float quality;
+        float rotation;                     // ROI normalization angle (radians)
+        uint64_t processing_time_us;
+        std::vector<uint8_t> roi_blob;      // RoiCodec-encoded ROI pixels
+        AddressGenerator::Address address;  // Biological address (empty = not generated)
+        std::vector<float> feature_vector;  // Similarity-search descriptor (empty = not extracted)
+        CorePointDetector::RoiHash roi_hash;    // Perceptual hash for duplicate screening (empty = none)
+        uint64_t content_hash;              // Hash of the source file bytes (0 = unknown)
+        
+        Record() : file_index(-1), core_rank(0), core_x(0), core_y(0), confidence(0),
+                   quality(0), rotation(0), processing_time_us(0), content_hash(0) {}
+    };
+    
+    // High-water mark of a batch run over inputs processed in a fixed order
+    struct RunProgress {
+        std::string run_key;                // Identifies the run (e.g. the normalized input directory)
+        std::string last_input;             // Last input whose rows are queued with this mark
+        int64_t inputs_committed;           // Inputs up to and including last_input
+        
+        RunProgress() : inputs_committed(0) {}
+    };
+    
+    struct WriterStats {
+        size_t rows_written;
+        size_t transactions_committed;
+        size_t failed_transactions;
+        double total_commit_time_us;
+        
+        WriterStats() : rows_written(0), transactions_committed(0), 
+                        failed_transactions(0), total_commit_time_us(0) {}
+    };
+
+private:
+    Config config;
+    SQLiteAdapter db;
+    FeatureExtractor extractor;             // Addresses and feature vectors (describe_rois)
+    
+    // Statements prepared once at open and reused for every row/transaction (all under mutex)
+    SQLiteStatement insert_statement;
+    SQLiteStatement content_statement;
+    SQLiteStatement begin_statement;
+    SQLiteStatement commit_statement;
+    SQLiteStatement rollback_statement;
+    SQLiteStatement progress_statement;
+    
+    int64_t committed_row_id;               // Highest row id committed (stored with every mark)
+    bool bulk_resumed;                      // open() found an unfinished bulk load
+    bool bulk_failed;                       // A bulk transaction failed (no rollback with journal off)
+    
+    // Content hashes committed while bulk loading, when idx_rois_content_hash is dropped
+    std::unordered_set<uint64_t> bulk_content;
+    
+    std::vector<Record> pending;
+    RunProgress pending_progress;           // Latest mark queued with pending (run_key empty = none)
+    bool progress_failed;                   // Pending rows were lost; marks are no longer stored
+    std::mutex mutex;
+    
+    WriterStats stats;
+    
+    bool create_schema();
+    bool migrate_schema();
+    bool create_indexes();
+    bool prepare_statements();
+    bool configure_connection();
+    bool begin_bulk_load();
+    bool store_progress(const RunProgress& progress, int64_t last_row_id);
+    bool queue(std::vector<Record>&& records, const RunProgress* progress);
+    bool commit_pending();                  // Caller holds mutex
+    bool write_transaction(const std::vector<Record>& records, const RunProgress* progress = nullptr);
+    bool insert_record(const Record& record);
+
+public:
+    DatabaseWriter() : committed_row_id(0), bulk_resumed(false), bulk_failed(false), progress_failed(false) {}
+    ~DatabaseWriter() { close(); }
+    
+    DatabaseWriter(const DatabaseWriter&) = delete;
+    DatabaseWriter& operator=(const DatabaseWriter&) = delete;
+    
+    // Connection management
+    bool open(const Config& writer_config = Config());
+    void close();                           // Flushes pending rows first
+    bool is_open() const { return db.is_open(); }
+    
+    // Queue rows; the write that brings batch_size rows pending commits them as one
+    // transaction. False if the writer is not open or that transaction failed (its
+    // rows are lost, and progress marks are no longer stored)
+    bool write(const CorePointDetector::DetectionResult& result);
+    bool write(const Record& record);
+    bool write(std::vector<Record>&& records);
+    
+    // Queue an input's rows (none for a failed detection) together with the run's
+    // progress mark; the mark is committed in the same transaction as those rows
+    bool write(const CorePointDetector::DetectionResult& result, const RunProgress& progress);
+    
+    // Progress committed for run_key by an earlier run (false if none)
+    bool load_progress(const std::string& run_key, RunProgress& progress);
+    
+    // Commit everything pending now (a mark alone is committed too)
+    bool flush();
+    
+    // Write the given rows, and the mark if given, as one transaction immediately
+    // (bypasses the pending buffer; the caller decides what a failure means for its marks)
+    bool commit(const std::vector<Record>& records, const RunProgress* progress = nullptr);
+    
+    // Bulk-load mode: rebuild deferred indexes, run ANALYZE and switch the connection
+    // back to the normal journal settings
+    bool finish_bulk_load();
+    bool is_bulk_loading() const { return config.bulk_load; }
+    
+    // open() continued an unfinished bulk load (rows past the last mark were discarded);
+    // callers skip committed inputs with load_progress() or contains_content()
+    bool resumed_bulk_load() const { return bulk_resumed; }
+    
+    // Convert a successful detection into one record per core. ROIs are encoded
+    // here, on the calling (detector) thread, so the writer only binds bytes.
+    // With an extractor, each record also gets its address and feature vector
+    static std::vector<Record> make_records(const CorePointDetector::DetectionResult& result,
+                                            RoiCodec::Compression compression = RoiCodec::best_available(),
+                                            const FeatureExtractor* extractor = nullptr);
+    
+    // make_records with this writer's compression, and its extractor when describe_rois
+    // is set; safe to call from any thread while the writer is open
+    std::vector<Record> to_records(const CorePointDetector::DetectionResult& result) const;
+    
+    // Biological address and similarity-search descriptor of one ROI (the ROI is
+    // binarized once for both ridge density and minutiae)
+    static void describe_roi(const CorePointDetector::ROI& roi,
+                             const FeatureExtractor::PatternClassification& pattern,
+                             const FeatureExtractor& extractor,
+                             AddressGenerator::Address& address,
+                             FeatureExtractor::FeatureVector& features);
+    
+    // Exact-duplicate check: a file with this content hash is already stored or
+    // pending (an index lookup; while bulk loading, a lookup in the committed hashes)
+    bool contains_content(uint64_t content_hash);
+    
+    // Statistics
+    WriterStats get_stats();
+    size_t pending_count();
+    const Config& get_config() const { return config; }
+};
@@ -0,0 +1,151 @@
+// HammingIndex.cpp - HammingIndex implementation 
+#include "HammingIndex.h"
+#include "SQLiteAdapter.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+HammingIndex::HammingIndex() {
+    for (auto& table : tables) table.resize(1u << CHUNK_BITS);
+}
+
+void HammingIndex::insert_locked(int64_t id, const Hash& hash) {
+    uint32_t position = static_cast<uint32_t>(hashes.size());
+    hashes.push_back(hash);
+    ids.push_back(id);
+    for (int c = 0; c < CHUNKS; ++c) {
+        tables[c][chunk(hash, c)].push_back(position);
+    }
+}
+
+template<typename Visitor>
+void HammingIndex::visit_candidates(const Hash& hash, int max_distance, Visitor&& visit) const {
+    if (max_distance > MAX_INDEXED_DISTANCE) {
+        for (uint32_t position = 0; position < hashes.size(); ++position) visit(position);
+        return;
+    }
+    
+    // Pigeonhole: some chunk differs in at most max_distance / CHUNKS bits
+    const int chunk_radius = max_distance / CHUNKS;
+    for (int c = 0; c < CHUNKS; ++c) {
+        const std::vector<std::vector<uint32_t>>& table = tables[c];
+        const uint32_t value = chunk(hash, c);
+        
+        auto visit_bucket = [&](uint32_t key) {
+            for (uint32_t position : table[key]) visit(position);
+        };
+        
+        visit_bucket(value);
+        for (int i = 0; chunk_radius >= 1 && i < CHUNK_BITS; ++i) {
+            const uint32_t one = value ^ (1u << i);
+            visit_bucket(one);
+            for (int j = i + 1; chunk_radius >= 2 && j < CHUNK_BITS; ++j) {
+                visit_bucket(one ^ (1u << j));
+            }
+        }
+    }
+}
+
+bool HammingIndex::load_from_database(const std::string& database_path) {
+    SQLiteAdapter db;
+    SQLiteStatement select;
+    if (!db.open(database_path) ||
+        !db.prepare(select, "SELECT id, roi_hash FROM rois WHERE roi_hash IS NOT NULL ORDER BY id;")) {
+        Logger::error("HammingIndex: cannot read ROI hashes from " + database_path);
+        return false;
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    
+    size_t loaded = 0;
+    int rc;
+    while ((rc = select.step()) == SQLITE_ROW) {
+        if (select.column_bytes(1) != sizeof(Hash::bits)) continue;
+        
+        Hash hash;
+        memcpy(hash.bits, select.column_blob(1), sizeof(hash.bits));
+        insert_locked(select.column_int64(0), hash);
+        ++loaded;
+    }
+    if (rc != SQLITE_DONE) {
+        Logger::error("HammingIndex: reading " + database_path + " failed: " + db.last_error());
+        return false;
+    }
+    
+    Logger::info("HammingIndex loaded " + std::to_string(loaded) + " ROI hashes from " + database_path);
+    return true;
+}
+
+void HammingIndex::add(int64_t id, const Hash& hash) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    insert_locked(id, hash);
+}
+
+bool HammingIndex::find_nearest_locked(const Hash& hash, int max_distance, Match& match) const {
+    int best_distance = max_distance + 1;
+    uint32_t best = 0;
+    
+    visit_candidates(hash, max_distance, [&](uint32_t position) {
+        int d = RoiHasher::distance(hash, hashes[position]);
+        if (d < best_distance) {
+            best_distance = d;
+            best = position;
+        }
+    });
+    
+    if (best_distance > max_distance) return false;
+    match.id = ids[best];
+    match.hash = hashes[best];
+    match.distance = best_distance;
+    return true;
+}
+
+bool HammingIndex::find_nearest(const Hash& hash, int max_distance, Match& match) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return find_nearest_locked(hash, max_distance, match);
+}
+
+std::vector<HammingIndex::Match> HammingIndex::find_within(const Hash& hash, int max_distance) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    
+    std::vector<std::pair<int, uint32_t>> found;
+    visit_candidates(hash, max_distance, [&](uint32_t position) {
+        int d = RoiHasher::distance(hash, hashes[position]);
+        if (d <= max_distance) found.emplace_back(d, position);
+    });
+    
+    // An entry matching on several chunks is visited once per chunk
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    
+    std::vector<Match> matches(found.size());
+    for (size_t i = 0; i < found.size(); ++i) {
+        matches[i].id = ids[found[i].second];
+        matches[i].hash = hashes[found[i].second];
+        matches[i].distance = found[i].first;
+    }
+    return matches;
+}
+
+bool HammingIndex::check_and_add(int64_t id, const Hash& hash, Match& duplicate, int max_distance) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (find_nearest_locked(hash, max_distance, duplicate)) return true;
+    
+    insert_locked(id, hash);
+    return false;
+}
+
+size_t HammingIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return hashes.size();
+}
+
+void HammingIndex::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    hashes.clear();
+    ids.clear();
+    for (auto& table : tables) {
+        for (auto& bucket : table) std::vector<uint32_t>().swap(bucket);
+    }
+}
@@ -0,0 +1,78 @@
+// HammingIndex.h - Near-duplicate lookup over ROI perceptual hashes 
+#pragma once
+
+#include "../core/RoiHasher.h"
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Multi-index hashing over 128-bit RoiHasher hashes
+ * Each hash is split into 8 chunks of 16 bits, each with its own table of
+ * chunk value -> entries. Two hashes within distance r agree to within r / 8 bits
+ * on at least one chunk, so a query only verifies (popcount) the entries in the
+ * buckets within that radius of its own chunks instead of scanning every entry
+ * Used to flag duplicate captures before feature extraction and storage
+ */
+class HammingIndex {
+public:
+    using Hash = RoiHasher::Hash;
+    
+    static constexpr int CHUNKS = 8;
+    static constexpr int CHUNK_BITS = 16;
+    static constexpr int MAX_INDEXED_DISTANCE = 3 * CHUNKS - 1;    // Larger radii fall back to a linear scan
+    
+    struct Match {
+        int64_t id;                         // rois row id (or the id given to add())
+        Hash hash;
+        int distance;
+        
+        Match() : id(0), distance(0) {}
+    };
+
+private:
+    std::vector<Hash> hashes;
+    std::vector<int64_t> ids;
+    std::vector<std::vector<uint32_t>> tables[CHUNKS];     // Chunk value -> positions in hashes
+    
+    mutable std::shared_mutex mutex;
+    
+    static uint32_t chunk(const Hash& hash, int index) {
+        return static_cast<uint32_t>(hash.bits[index >> 2] >> ((index & 3) * CHUNK_BITS)) & 0xFFFFu;
+    }
+    
+    void insert_locked(int64_t id, const Hash& hash);
+    
+    // Call visit(position) for every entry that can be within max_distance of hash
+    // (entries may be visited more than once)
+    template<typename Visitor>
+    void visit_candidates(const Hash& hash, int max_distance, Visitor&& visit) const;
+    
+    bool find_nearest_locked(const Hash& hash, int max_distance, Match& match) const;
+
+public:
+    HammingIndex();
+    
+    HammingIndex(const HammingIndex&) = delete;
+    HammingIndex& operator=(const HammingIndex&) = delete;
+    
+    // Bulk load the roi_hash column of a DatabaseWriter database
+    bool load_from_database(const std::string& database_path);
+    
+    void add(int64_t id, const Hash& hash);
+    
+    // Closest entry within max_distance (false if none)
+    bool find_nearest(const Hash& hash, int max_distance, Match& match) const;
+    
+    // All entries within max_distance, closest first
+    std::vector<Match> find_within(const Hash& hash, int max_distance) const;
+    
+    // Duplicate screening in one step: report the closest entry within max_distance,
+    // or add (id, hash) when there is none. Returns true if a duplicate was found
+    bool check_and_add(int64_t id, const Hash& hash, Match& duplicate,
+                       int max_distance = RoiHasher::DUPLICATE_DISTANCE);
+    
+    size_t size() const;
+    void clear();
+};
@@ -0,0 +1,353 @@
+// RoiArchive.cpp - RoiArchive writer and reader implementation 
+#include "RoiArchive.h"
+#include "RoiCodec.h"
+#include "../utils/Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void put_u32(uint8_t* dst, uint32_t value) {
+    for (int i = 0; i < 4; ++i) dst[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint32_t get_u32(const uint8_t* src) {
+    return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+           (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+}
+
+uint64_t get_u64(const uint8_t* src) {
+    return static_cast<uint64_t>(get_u32(src)) | (static_cast<uint64_t>(get_u32(src + 4)) << 32);
+}
+
+// write(2) until everything is written; false on the first error
+bool write_all(int fd, const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, p, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        p += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool read_prefix(const std::string& path, uint8_t* buffer, size_t size) {
+    std::ifstream file(path, std::ios::binary);
+    return file.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size)) &&
+           static_cast<size_t>(file.gcount()) == size;
+}
+
+// Walk index entries until one is incomplete or the callback returns false;
+// returns the byte length of the entries accepted
+template <typename Callback>
+size_t parse_index(const uint8_t* data, size_t size, Callback callback) {
+    size_t offset = RoiArchive::INDEX_HEADER_SIZE;
+    while (offset + 16 <= size) {
+        uint64_t first_record = get_u64(data + offset);
+        uint32_t record_count = get_u32(data + offset + 8);
+        uint32_t name_length = get_u32(data + offset + 12);
+        if (offset + 16 + name_length > size) break;
+        
+        if (!callback(first_record, record_count, reinterpret_cast<const char*>(data + offset + 16), name_length)) {
+            break;
+        }
+        offset += 16 + name_length;
+    }
+    return offset;
+}
+
+} // namespace
+
+bool RoiArchiveWriter::recover(const std::string& archive_path) {
+    std::error_code error;
+    std::string idx_path = RoiArchive::index_path(archive_path);
+    
+    uint64_t archive_size = fs::exists(archive_path) ? fs::file_size(archive_path, error) : 0;
+    if (archive_size > 0) {
+        uint8_t header[RoiArchive::HEADER_SIZE];
+        if (archive_size < RoiArchive::HEADER_SIZE || !read_prefix(archive_path, header, sizeof(header)) ||
+            get_u32(header) != RoiArchive::MAGIC || get_u32(header + 8) != RoiArchive::RECORD_SIZE) {
+            Logger::error("RoiArchive: " + archive_path + " is not a ROI archive");
+            return false;
+        }
+        
+        uint64_t complete = (archive_size - RoiArchive::HEADER_SIZE) / RoiArchive::RECORD_SIZE;
+        uint64_t expected = RoiArchive::HEADER_SIZE + complete * RoiArchive::RECORD_SIZE;
+        if (expected != archive_size) {
+            Logger::warning("RoiArchive: dropping a partial record at the end of " + archive_path);
+            fs::resize_file(archive_path, expected, error);
+            if (error) return false;
+        }
+        stats.records = complete;
+    }
+    
+    uint64_t index_size = fs::exists(idx_path) ? fs::file_size(idx_path, error) : 0;
+    if (index_size > 0) {
+        std::vector<uint8_t> data(static_cast<size_t>(index_size));
+        if (index_size < RoiArchive::INDEX_HEADER_SIZE || !read_prefix(idx_path, data.data(), data.size()) ||
+            get_u32(data.data()) != RoiArchive::INDEX_MAGIC) {
+            Logger::error("RoiArchive: " + idx_path + " is not a ROI archive index");
+            return false;
+        }
+        
+        // Entries are in record order; drop the tail that is torn or refers to records
+        // lost with the archive tail, so those record numbers are not reused under old names
+        uint64_t records = stats.records;
+        size_t complete = parse_index(data.data(), data.size(), 
+                                      [records](uint64_t first, uint32_t count, const char*, uint32_t) {
+            return first + count <= records;
+        });
+        if (complete != data.size()) {
+            Logger::warning("RoiArchive: dropping incomplete entries at the end of " + idx_path);
+            fs::resize_file(idx_path, complete, error);
+            if (error) return false;
+        }
+    }
+    
+    return true;
+}
+
+bool RoiArchiveWriter::open(const std::string& archive_path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    close_files();
+    stats = WriterStats();
+    
+    if (!recover(archive_path)) {
+        return false;
+    }
+    
+    std::string idx_path = RoiArchive::index_path(archive_path);
+    archive_fd = ::open(archive_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    index_fd = ::open(idx_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    struct stat archive_info, index_info;
+    if (archive_fd < 0 || index_fd < 0 || fstat(archive_fd, &archive_info) != 0 || fstat(index_fd, &index_info) != 0) {
+        Logger::error("RoiArchive: cannot open " + archive_path + " for appending: " + strerror(errno));
+        close_files();
+        return false;
+    }
+    
+    bool written = true;
+    if (archive_info.st_size == 0) {
+        uint8_t header[RoiArchive::HEADER_SIZE] = {};
+        put_u32(header, RoiArchive::MAGIC);
+        put_u32(header + 4, RoiArchive::VERSION);
+        put_u32(header + 8, RoiArchive::RECORD_SIZE);
+        put_u32(header + 12, 101);
+        written = write_all(archive_fd, header, sizeof(header));
+    }
+    index_size = static_cast<uint64_t>(index_info.st_size);
+    if (written && index_size == 0) {
+        uint8_t header[RoiArchive::INDEX_HEADER_SIZE] = {};
+        put_u32(header, RoiArchive::INDEX_MAGIC);
+        put_u32(header + 4, RoiArchive::VERSION);
+        written = write_all(index_fd, header, sizeof(header));
+        index_size = sizeof(header);
+    }
+    if (!written) {
+        Logger::error("RoiArchive: cannot write the headers of " + archive_path + ": " + strerror(errno));
+        close_files();
+        return false;
+    }
+    
+    path = archive_path;
+    Logger::info("RoiArchive appending to " + path + " (" + std::to_string(stats.records) + " records)");
+    return true;
+}
+
+void RoiArchiveWriter::close_files() {
+    if (archive_fd >= 0) ::close(archive_fd);
+    if (index_fd >= 0) ::close(index_fd);
+    archive_fd = index_fd = -1;
+}
+
+void RoiArchiveWriter::close() {
+    if (!is_open()) return;
+    
+    flush();
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    close_files();
+    Logger::info("RoiArchive closed " + path + " (" + std::to_string(stats.records_appended) +
+                " records appended, " + std::to_string(stats.records) + " total)");
+}
+
+void RoiArchiveWriter::roll_back() {
+    off_t archive_end = static_cast<off_t>(RoiArchive::HEADER_SIZE + stats.records * RoiArchive::RECORD_SIZE);
+    if (ftruncate(archive_fd, archive_end) != 0 || ftruncate(index_fd, static_cast<off_t>(index_size)) != 0) {
+        // The next open() trims what is left of the failed append
+        Logger::error("RoiArchive: cannot roll back a failed append to " + path + "; closing the archive");
+        close_files();
+    }
+}
+
+bool RoiArchiveWriter::append(const CorePointDetector::DetectionResult& result) {
+    if (!result.success || result.core_points.empty()) return true;
+    
+    // Build the records and the index entry outside the lock; only the file writes are serialized
+    std::vector<RoiArchive::Record> records(result.core_points.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        const CorePointDetector::ROI& roi = (i == 0) ? result.extracted_roi : result.secondary_rois.at(i - 1);
+        const CorePointDetector::CorePoint& core = result.core_points[i];
+        RoiArchive::Record& record = records[i];
+        
+        memset(&record, 0, sizeof(record));
+        memcpy(record.pixels, roi.pixels, sizeof(record.pixels));
+        record.core_rank = static_cast<uint8_t>(i);
+        record.file_index = roi.file_index;
+        record.core_x = core.x;
+        record.core_y = core.y;
+        record.confidence = core.confidence;
+        record.quality = result.overall_quality;
+        record.rotation = roi.rotation;
+        record.checksum = RoiCodec::crc32c(record.pixels, sizeof(record.pixels));
+        record.content_hash = result.content_hash;
+    }
+    
+    const std::string& filename = result.extracted_roi.filename;
+    std::vector<uint8_t> entry(16 + filename.size());
+    put_u32(&entry[8], static_cast<uint32_t>(records.size()));
+    put_u32(&entry[12], static_cast<uint32_t>(filename.size()));
+    memcpy(entry.data() + 16, filename.data(), filename.size());
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!is_open()) {
+        Logger::error("RoiArchive: append attempted on closed archive");
+        return false;
+    }
+    
+    put_u32(&entry[0], static_cast<uint32_t>(stats.records));
+    put_u32(&entry[4], static_cast<uint32_t>(stats.records >> 32));
+    
+    if (!write_all(archive_fd, records.data(), records.size() * sizeof(RoiArchive::Record)) ||
+        !write_all(index_fd, entry.data(), entry.size())) {
+        Logger::error("RoiArchive: write failed for " + path + ": " + strerror(errno));
+        roll_back();
+        return false;
+    }
+    
+    index_size += entry.size();
+    stats.records += records.size();
+    stats.records_appended += records.size();
+    stats.files_appended++;
+    return true;
+}
+
+bool RoiArchiveWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!is_open()) return false;
+    
+    if (fdatasync(archive_fd) != 0 || fdatasync(index_fd) != 0) {
+        Logger::error("RoiArchive: sync failed for " + path + ": " + strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+RoiArchiveWriter::WriterStats RoiArchiveWriter::get_stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool RoiArchiveReader::open(const std::string& archive_path) {
+    close();
+    
+    fd = ::open(archive_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        Logger::error("RoiArchive: cannot open " + archive_path);
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < RoiArchive::HEADER_SIZE) {
+        Logger::error("RoiArchive: " + archive_path + " is not a ROI archive");
+        close();
+        return false;
+    }
+    
+    mapping_size = static_cast<size_t>(info.st_size);
+    void* address = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        Logger::error("RoiArchive: mmap failed for " + archive_path);
+        close();
+        return false;
+    }
+    mapping = static_cast<const uint8_t*>(address);
+    
+    if (get_u32(mapping) != RoiArchive::MAGIC || get_u32(mapping + 8) != RoiArchive::RECORD_SIZE) {
+        Logger::error("RoiArchive: " + archive_path + " is not a ROI archive");
+        close();
+        return false;
+    }
+    
+    // A record still being written by a concurrent writer is not counted
+    record_count = (mapping_size - RoiArchive::HEADER_SIZE) / RoiArchive::RECORD_SIZE;
+    
+    std::string idx_path = RoiArchive::index_path(archive_path);
+    std::error_code error;
+    uint64_t index_size = fs::exists(idx_path) ? fs::file_size(idx_path, error) : 0;
+    std::vector<uint8_t> data(static_cast<size_t>(index_size));
+    if (index_size >= RoiArchive::INDEX_HEADER_SIZE && read_prefix(idx_path, data.data(), data.size()) &&
+        get_u32(data.data()) == RoiArchive::INDEX_MAGIC) {
+        size_t count = record_count;
+        parse_index(data.data(), data.size(),
+                    [this, count](uint64_t first, uint32_t records, const char* name, uint32_t length) {
+            if (first + records > count) return false;
+            FileRange range;
+            range.first_record = first;
+            range.record_count = records;
+            files[std::string(name, length)] = range; // A re-processed file maps to its latest records
+            return true;
+        });
+    } else {
+        Logger::warning("RoiArchive: no usable index for " + archive_path + ", lookups by filename disabled");
+    }
+    
+    Logger::info("RoiArchive mapped " + archive_path + " (" + std::to_string(record_count) + " records, " +
+                std::to_string(files.size()) + " files)");
+    return true;
+}
+
+void RoiArchiveReader::close() {
+    if (mapping) {
+        munmap(const_cast<uint8_t*>(mapping), mapping_size);
+        mapping = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    mapping_size = 0;
+    record_count = 0;
+    files.clear();
+}
+
+RoiArchiveReader::FileRange RoiArchiveReader::find(const std::string& filename) const {
+    auto it = files.find(filename);
+    if (it != files.end()) return it->second;
+    
+    FileRange none;
+    none.first_record = 0;
+    none.record_count = 0;
+    return none;
+}
+
+bool RoiArchiveReader::verify(size_t index) const {
+    if (index >= record_count) return false;
+    const RoiArchive::Record& entry = record(index);
+    return RoiCodec::crc32c(entry.pixels, sizeof(entry.pixels)) == entry.checksum;
+}
+
+void RoiArchiveReader::advise_sequential(bool sequential) const {
+    if (!mapping) return;
+    madvise(const_cast<uint8_t*>(mapping), mapping_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+}
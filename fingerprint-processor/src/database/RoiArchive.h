@@ -0,0 +1,154 @@
+// RoiArchive.h - Append-only memory-mappable ROI archive 
+#pragma once
+
+#include "../core/CorePointDetector.h"
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Fixed-stride ROI archive for batch jobs that scan or sample ROIs in bulk
+ *
+ * Archive file (little-endian):
+ *   0      64-byte header: uint32 magic 'FRAR', uint32 version 1, uint32 record_size 10240,
+ *          uint32 roi_size 101, zero padded
+ *   64     records, RECORD_SIZE bytes each (see Record), record i at 64 + i * RECORD_SIZE
+ *
+ * Sidecar index "<archive>.idx": 16-byte header (uint32 magic 'FRAI', uint32 version,
+ * 8 zero bytes), then one entry per source file: uint64 first_record, uint32 record_count,
+ * uint32 name_length, name bytes. A file's cores are always consecutive records.
+ *
+ * Both files are only ever appended to. A record or index entry cut short by a
+ * crash, and index entries for records lost with it, are dropped when the archive
+ * is next opened for writing; readers ignore entries past the last complete record.
+ * An append that fails part way is truncated off both files before append() returns.
+ */
+class RoiArchive {
+public:
+    static constexpr uint32_t MAGIC = 0x52415246;          // "FRAR"
+    static constexpr uint32_t INDEX_MAGIC = 0x49415246;    // "FRAI"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t INDEX_HEADER_SIZE = 16;
+    static constexpr size_t RECORD_SIZE = 10240;
+    
+    // One ROI; pixels come first so every ROI starts on a 64-byte boundary
+    struct alignas(64) Record {
+        uint8_t pixels[101][101];
+        uint8_t core_rank;                  // 0 = primary core
+        uint8_t reserved[2];
+        int32_t file_index;
+        float core_x, core_y;
+        float confidence;
+        float quality;
+        float rotation;
+        uint32_t checksum;                  // CRC32C of pixels
+        uint64_t content_hash;              // Source file hash (0 = unknown)
+    };
+    
+    static std::string index_path(const std::string& archive_path) { return archive_path + ".idx"; }
+};
+
+static_assert(sizeof(RoiArchive::Record) == RoiArchive::RECORD_SIZE, "ROI archive record must be 10240 bytes");
+
+/**
+ * Appends detection results to an archive (created if missing)
+ * Thread-safe; each result's cores are appended together, with one write(2) to
+ * each file, so stats always match the bytes on disk
+ */
+class RoiArchiveWriter {
+public:
+    struct WriterStats {
+        uint64_t records;                   // Records in the archive, including earlier runs
+        uint64_t records_appended;          // Records appended by this writer
+        uint64_t files_appended;
+        
+        WriterStats() : records(0), records_appended(0), files_appended(0) {}
+    };
+
+private:
+    std::string path;
+    int archive_fd;
+    int index_fd;
+    uint64_t index_size;                    // Bytes of the index covered by appended entries
+    WriterStats stats;
+    std::mutex mutex;
+    
+    // Trim a torn trailing record or index entry and validate the headers
+    bool recover(const std::string& archive_path);
+    
+    // Cut both files back to the last complete append; closes the writer if that fails
+    void roll_back();
+    void close_files();
+
+public:
+    RoiArchiveWriter() : archive_fd(-1), index_fd(-1), index_size(0) {}
+    ~RoiArchiveWriter() { close(); }
+    
+    RoiArchiveWriter(const RoiArchiveWriter&) = delete;
+    RoiArchiveWriter& operator=(const RoiArchiveWriter&) = delete;
+    
+    bool open(const std::string& archive_path);
+    void close();
+    bool is_open() const { return archive_fd >= 0; }
+    
+    // False (with nothing appended) if either file could not be written
+    bool append(const CorePointDetector::DetectionResult& result);
+    
+    // Make appended records durable; records are synced before the index, so index
+    // entries never lead the data after a crash
+    bool flush();
+    
+    WriterStats get_stats();
+};
+
+/**
+ * Read-only view of an archive through mmap: records are used in place,
+ * record(i) is O(1) and a sequential scan runs at memory bandwidth
+ */
+class RoiArchiveReader {
+public:
+    struct FileRange {
+        uint64_t first_record;
+        uint32_t record_count;
+    };
+
+private:
+    int fd;
+    const uint8_t* mapping;
+    size_t mapping_size;
+    size_t record_count;
+    std::unordered_map<std::string, FileRange> files;
+
+public:
+    RoiArchiveReader() : fd(-1), mapping(nullptr), mapping_size(0), record_count(0) {}
+    ~RoiArchiveReader() { close(); }
+    
+    RoiArchiveReader(const RoiArchiveReader&) = delete;
+    RoiArchiveReader& operator=(const RoiArchiveReader&) = delete;
+    
+    // Maps the archive and loads the sidecar index (without one, only find() is unavailable)
+    bool open(const std::string& archive_path);
+    void close();
+    bool is_open() const { return mapping != nullptr; }
+    
+    size_t size() const { return record_count; }
+    const RoiArchive::Record& record(size_t index) const {
+        return reinterpret_cast<const RoiArchive::Record*>(mapping + RoiArchive::HEADER_SIZE)[index];
+    }
+    const RoiArchive::Record* begin() const { return &record(0); }
+    const RoiArchive::Record* end() const { return begin() + record_count; }
+    
+    // Records of a source file (record_count 0 if unknown)
+    FileRange find(const std::string& filename) const;
+    size_t file_count() const { return files.size(); }
+    
+    // Recompute the pixel checksum of a record
+    bool verify(size_t index) const;
+    
+    // Kernel read-ahead hint for full scans (MADV_SEQUENTIAL) or sampling (MADV_RANDOM)
+    void advise_sequential(bool sequential) const;
+};
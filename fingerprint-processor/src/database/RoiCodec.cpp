@@ -0,0 +1,232 @@
+// RoiCodec.cpp - RoiCodec implementation 
+#include "RoiCodec.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <immintrin.h>
+
+#ifdef FP_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef FP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+void write_u32(uint8_t* dst, uint32_t value) {
+    dst[0] = static_cast<uint8_t>(value);
+    dst[1] = static_cast<uint8_t>(value >> 8);
+    dst[2] = static_cast<uint8_t>(value >> 16);
+    dst[3] = static_cast<uint8_t>(value >> 24);
+}
+
+uint32_t read_u32(const uint8_t* src) {
+    return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+           (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+}
+
+bool fail(std::string* error, const char* message) {
+    if (error) *error = message;
+    return false;
+}
+
+#ifndef __SSE4_2__
+// Software CRC32C table (reflected polynomial 0x82F63B78)
+const std::array<uint32_t, 256> crc32c_table = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+#endif
+
+} // namespace
+
+uint32_t RoiCodec::crc32c(const void* data, size_t size, uint32_t previous) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint32_t crc = previous ^ 0xFFFFFFFFu;
+    
+    #ifdef __SSE4_2__
+    uint64_t crc64 = crc;
+    while (size >= 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, bytes, 8);
+        crc64 = _mm_crc32_u64(crc64, chunk);
+        bytes += 8;
+        size -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+    while (size > 0) {
+        crc = _mm_crc32_u8(crc, *bytes++);
+        size--;
+    }
+    #else
+    while (size > 0) {
+        crc = (crc >> 8) ^ crc32c_table[(crc ^ *bytes++) & 0xFF];
+        size--;
+    }
+    #endif
+    
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool RoiCodec::is_available(Compression compression) {
+    switch (compression) {
+        case Compression::NONE: return true;
+        #ifdef FP_HAVE_LZ4
+        case Compression::LZ4:  return true;
+        #endif
+        #ifdef FP_HAVE_ZSTD
+        case Compression::ZSTD: return true;
+        #endif
+        default:                return false;
+    }
+}
+
+RoiCodec::Compression RoiCodec::best_available() {
+    if (is_available(Compression::LZ4)) return Compression::LZ4;
+    if (is_available(Compression::ZSTD)) return Compression::ZSTD;
+    return Compression::NONE;
+}
+
+std::string RoiCodec::compression_name(Compression compression) {
+    switch (compression) {
+        case Compression::NONE: return "raw";
+        case Compression::LZ4:  return "lz4";
+        case Compression::ZSTD: return "zstd";
+        default:                return "unknown";
+    }
+}
+
+size_t RoiCodec::max_encoded_size() {
+    size_t bound = RAW_SIZE;
+    #ifdef FP_HAVE_LZ4
+    bound = std::max(bound, static_cast<size_t>(LZ4_compressBound(static_cast<int>(RAW_SIZE))));
+    #endif
+    #ifdef FP_HAVE_ZSTD
+    bound = std::max(bound, ZSTD_compressBound(RAW_SIZE));
+    #endif
+    return HEADER_SIZE + bound;
+}
+
+RoiCodec::Compression RoiCodec::encode(const uint8_t (&pixels)[101][101], 
+                                       std::vector<uint8_t>& out,
+                                       Compression compression,
+                                       int zstd_level) {
+    const uint8_t* raw = &pixels[0][0];
+    out.resize(max_encoded_size());
+    uint8_t* payload = out.data() + HEADER_SIZE;
+    const size_t capacity = out.size() - HEADER_SIZE;
+    
+    size_t payload_size = 0;
+    if (!is_available(compression)) {
+        compression = Compression::NONE;
+    }
+    
+    switch (compression) {
+        #ifdef FP_HAVE_LZ4
+        case Compression::LZ4: {
+            int written = LZ4_compress_default(reinterpret_cast<const char*>(raw), 
+                                               reinterpret_cast<char*>(payload),
+                                               static_cast<int>(RAW_SIZE), static_cast<int>(capacity));
+            payload_size = written > 0 ? static_cast<size_t>(written) : 0;
+            break;
+        }
+        #endif
+        #ifdef FP_HAVE_ZSTD
+        case Compression::ZSTD: {
+            size_t written = ZSTD_compress(payload, capacity, raw, RAW_SIZE, zstd_level);
+            payload_size = ZSTD_isError(written) ? 0 : written;
+            break;
+        }
+        #endif
+        default:
+            break;
+    }
+    (void)zstd_level;
+    (void)capacity;
+    
+    // Store raw when compression is unavailable, failed or did not pay off
+    if (payload_size == 0 || payload_size >= RAW_SIZE) {
+        compression = Compression::NONE;
+        std::memcpy(payload, raw, RAW_SIZE);
+        payload_size = RAW_SIZE;
+    }
+    
+    uint8_t* header = out.data();
+    write_u32(header, MAGIC);
+    header[4] = VERSION;
+    header[5] = static_cast<uint8_t>(compression);
+    header[6] = ROI_SIZE;
+    header[7] = ROI_SIZE;
+    write_u32(header + 8, static_cast<uint32_t>(RAW_SIZE));
+    write_u32(header + 12, static_cast<uint32_t>(payload_size));
+    write_u32(header + 16, crc32c(raw, RAW_SIZE));
+    
+    out.resize(HEADER_SIZE + payload_size);
+    return compression;
+}
+
+bool RoiCodec::decode(const void* data, size_t size, 
+                      uint8_t (&pixels)[101][101], 
+                      std::string* error) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint8_t* raw = &pixels[0][0];
+    
+    // Legacy rows stored the bare pixel array
+    if (size == RAW_SIZE && (size < 4 || read_u32(bytes) != MAGIC)) {
+        std::memcpy(raw, bytes, RAW_SIZE);
+        return true;
+    }
+    
+    if (!bytes || size < HEADER_SIZE) return fail(error, "ROI blob truncated");
+    if (read_u32(bytes) != MAGIC) return fail(error, "ROI blob has bad magic");
+    if (bytes[4] != VERSION) return fail(error, "Unsupported ROI blob version");
+    if (bytes[6] != ROI_SIZE || bytes[7] != ROI_SIZE || read_u32(bytes + 8) != RAW_SIZE) {
+        return fail(error, "Unexpected ROI dimensions");
+    }
+    
+    const uint32_t payload_size = read_u32(bytes + 12);
+    if (HEADER_SIZE + static_cast<size_t>(payload_size) != size) {
+        return fail(error, "ROI blob size mismatch");
+    }
+    
+    const uint8_t* payload = bytes + HEADER_SIZE;
+    const Compression compression = static_cast<Compression>(bytes[5]);
+    
+    switch (compression) {
+        case Compression::NONE:
+            if (payload_size != RAW_SIZE) return fail(error, "Raw ROI payload has wrong size");
+            std::memcpy(raw, payload, RAW_SIZE);
+            break;
+        #ifdef FP_HAVE_LZ4
+        case Compression::LZ4: {
+            int decoded = LZ4_decompress_safe(reinterpret_cast<const char*>(payload), 
+                                              reinterpret_cast<char*>(raw),
+                                              static_cast<int>(payload_size), static_cast<int>(RAW_SIZE));
+            if (decoded != static_cast<int>(RAW_SIZE)) return fail(error, "LZ4 decompression failed");
+            break;
+        }
+        #endif
+        #ifdef FP_HAVE_ZSTD
+        case Compression::ZSTD: {
+            size_t decoded = ZSTD_decompress(raw, RAW_SIZE, payload, payload_size);
+            if (ZSTD_isError(decoded) || decoded != RAW_SIZE) return fail(error, "zstd decompression failed");
+            break;
+        }
+        #endif
+        default:
+            return fail(error, "ROI blob compression not supported by this build");
+    }
+    
+    if (crc32c(raw, RAW_SIZE) != read_u32(bytes + 16)) {
+        return fail(error, "ROI blob checksum mismatch");
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+// RoiCodec.h - Compact binary ROI BLOB encoding 
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Versioned binary encoding for 101x101 ROIs stored as SQLite BLOBs
+ *
+ * Layout (little-endian, 20-byte header followed by the payload):
+ *   0  uint32  magic        'FROI'
+ *   4  uint8   version      1
+ *   5  uint8   compression  0 = raw, 1 = LZ4, 2 = zstd
+ *   6  uint8   width        101
+ *   7  uint8   height       101
+ *   8  uint32  raw_size     width * height
+ *  12  uint32  payload_size bytes following the header
+ *  16  uint32  checksum     CRC32C of the decoded pixels
+ *
+ * LZ4/zstd are used when the build found them (FP_HAVE_LZ4 / FP_HAVE_ZSTD);
+ * otherwise, or when compression does not help, the payload is stored raw.
+ */
+class RoiCodec {
+public:
+    enum class Compression : uint8_t {
+        NONE = 0,
+        LZ4 = 1,
+        ZSTD = 2
+    };
+    
+    static constexpr uint32_t MAGIC = 0x494F5246;  // "FROI"
+    static constexpr uint8_t VERSION = 1;
+    static constexpr int ROI_SIZE = 101;
+    static constexpr size_t RAW_SIZE = ROI_SIZE * ROI_SIZE;
+    static constexpr size_t HEADER_SIZE = 20;
+    
+    // Upper bound of encode() output for any compression
+    static size_t max_encoded_size();
+    
+    // Encode into out (resized to the encoded length). Returns the compression actually used.
+    static Compression encode(const uint8_t (&pixels)[101][101], 
+                              std::vector<uint8_t>& out,
+                              Compression compression = Compression::LZ4,
+                              int zstd_level = 3);
+    
+    // Decode and verify; also accepts legacy raw 10201-byte BLOBs without a header
+    static bool decode(const void* data, size_t size, 
+                       uint8_t (&pixels)[101][101], 
+                       std::string* error = nullptr);
+    
+    // Compression support compiled into this build
+    static bool is_available(Compression compression);
+    static Compression best_available();
+    static std::string compression_name(Compression compression);
+    
+    // CRC32C (Castagnoli), hardware-accelerated with SSE4.2 when available;
+    // pass the CRC of the preceding bytes as previous to checksum data in pieces
+    static uint32_t crc32c(const void* data, size_t size, uint32_t previous = 0);
+};
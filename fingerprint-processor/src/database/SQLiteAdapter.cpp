@@ -1,2 +1,152 @@
-// SQLiteAdapter.cpp - SQLite implementation 
-// Implementation placeholder 
+// SQLiteAdapter.cpp - SQLite implementation 
+// Implementation placeholder 
+#include "SQLiteAdapter.h"
+#include "../utils/Logger.h"
+
+// SQLiteStatement implementation
+SQLiteStatement& SQLiteStatement::operator=(SQLiteStatement&& other) noexcept {
+    if (this != &other) {
+        finalize();
+        stmt = other.stmt;
+        other.stmt = nullptr;
+    }
+    return *this;
+}
+
+bool SQLiteStatement::prepare(sqlite3* db, const std::string& sql) {
+    finalize();
+    
+    if (sqlite3_prepare_v2(db, sql.c_str(), static_cast<int>(sql.size()), &stmt, nullptr) != SQLITE_OK) {
+        Logger::error("Failed to prepare statement: " + std::string(sqlite3_errmsg(db)) + " [" + sql + "]");
+        stmt = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void SQLiteStatement::finalize() {
+    if (stmt) {
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+    }
+}
+
+bool SQLiteStatement::bind_int(int index, int value) {
+    return sqlite3_bind_int(stmt, index, value) == SQLITE_OK;
+}
+
+bool SQLiteStatement::bind_int64(int index, int64_t value) {
+    return sqlite3_bind_int64(stmt, index, value) == SQLITE_OK;
+}
+
+bool SQLiteStatement::bind_double(int index, double value) {
+    return sqlite3_bind_double(stmt, index, value) == SQLITE_OK;
+}
+
+bool SQLiteStatement::bind_text(int index, const std::string& value) {
+    return bind_text(index, value.data(), value.size());
+}
+
+bool SQLiteStatement::bind_text(int index, const char* value, size_t length) {
+    // SQLITE_STATIC: the caller keeps value alive until the statement is stepped
+    return sqlite3_bind_text(stmt, index, value, static_cast<int>(length), SQLITE_STATIC) == SQLITE_OK;
+}
+
+bool SQLiteStatement::bind_blob(int index, const void* data, size_t size) {
+    return sqlite3_bind_blob(stmt, index, data, static_cast<int>(size), SQLITE_STATIC) == SQLITE_OK;
+}
+
+bool SQLiteStatement::bind_null(int index) {
+    return sqlite3_bind_null(stmt, index) == SQLITE_OK;
+}
+
+int SQLiteStatement::step() {
+    return sqlite3_step(stmt);
+}
+
+bool SQLiteStatement::execute() {
+    int rc = sqlite3_step(stmt);
+    while (rc == SQLITE_ROW) {
+        rc = sqlite3_step(stmt);
+    }
+    
+    if (rc != SQLITE_DONE) {
+        Logger::error("Statement execution failed: " + std::string(sqlite3_errmsg(sqlite3_db_handle(stmt))));
+    }
+    
+    reset();
+    return rc == SQLITE_DONE;
+}
+
+void SQLiteStatement::reset() {
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+std::string SQLiteStatement::column_text(int index) const {
+    const unsigned char* text = sqlite3_column_text(stmt, index);
+    return text ? std::string(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, index)) : "";
+}
+
+// SQLiteAdapter implementation
+bool SQLiteAdapter::open(const std::string& database_path) {
+    close();
+    
+    int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
+    if (sqlite3_open_v2(database_path.c_str(), &db, flags, nullptr) != SQLITE_OK) {
+        Logger::error("Failed to open database " + database_path + ": " + 
+                     std::string(db ? sqlite3_errmsg(db) : "out of memory"));
+        sqlite3_close(db);
+        db = nullptr;
+        return false;
+    }
+    
+    path = database_path;
+    
+    // Wait briefly instead of failing when another connection holds a lock
+    sqlite3_busy_timeout(db, 5000);
+    return true;
+}
+
+void SQLiteAdapter::close() {
+    if (db) {
+        sqlite3_close_v2(db);
+        db = nullptr;
+    }
+}
+
+bool SQLiteAdapter::exec(const std::string& sql) {
+    char* error = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &error) != SQLITE_OK) {
+        Logger::error("SQL error: " + std::string(error ? error : "unknown") + " [" + sql + "]");
+        sqlite3_free(error);
+        return false;
+    }
+    return true;
+}
+
+std::string SQLiteAdapter::pragma(const std::string& name, const std::string& value) {
+    SQLiteStatement statement;
+    if (!statement.prepare(db, "PRAGMA " + name + "=" + value + ";")) {
+        return "";
+    }
+    
+    // Some pragmas (e.g. journal_mode) report the resulting value as a row
+    std::string result = value;
+    int rc = statement.step();
+    if (rc == SQLITE_ROW) {
+        result = statement.column_text(0);
+    } else if (rc != SQLITE_DONE) {
+        Logger::error("PRAGMA " + name + " failed: " + last_error());
+        return "";
+    }
+    return result;
+}
+
+bool SQLiteAdapter::prepare(SQLiteStatement& statement, const std::string& sql) {
+    return statement.prepare(db, sql);
+}
+
+std::string SQLiteAdapter::last_error() const {
+    return db ? sqlite3_errmsg(db) : "database not open";
+}
@@ -0,0 +1,85 @@
+// SQLiteAdapter.h - SQLite connection and statement wrappers 
+#pragma once
+
+#include <sqlite3.h>
+#include <string>
+#include <cstdint>
+
+/**
+ * Thin RAII wrappers around the SQLite C API
+ * Statements are prepared once and reused across rows (bind/step/reset)
+ */
+class SQLiteStatement {
+private:
+    sqlite3_stmt* stmt;
+    
+public:
+    SQLiteStatement() : stmt(nullptr) {}
+    ~SQLiteStatement() { finalize(); }
+    
+    SQLiteStatement(const SQLiteStatement&) = delete;
+    SQLiteStatement& operator=(const SQLiteStatement&) = delete;
+    SQLiteStatement(SQLiteStatement&& other) noexcept : stmt(other.stmt) { other.stmt = nullptr; }
+    SQLiteStatement& operator=(SQLiteStatement&& other) noexcept;
+    
+    bool prepare(sqlite3* db, const std::string& sql);
+    void finalize();
+    bool is_prepared() const { return stmt != nullptr; }
+    
+    // Parameter binding (1-based indices, as in SQLite)
+    bool bind_int(int index, int value);
+    bool bind_int64(int index, int64_t value);
+    bool bind_double(int index, double value);
+    bool bind_text(int index, const std::string& value);
+    bool bind_text(int index, const char* value, size_t length);
+    bool bind_blob(int index, const void* data, size_t size);
+    bool bind_null(int index);
+    
+    // Execution: step() returns SQLITE_ROW, SQLITE_DONE or an error code
+    int step();
+    bool execute();                         // Step to completion, then reset
+    void reset();
+    
+    // Column access for SELECT statements (0-based indices)
+    int column_int(int index) const { return sqlite3_column_int(stmt, index); }
+    int64_t column_int64(int index) const { return sqlite3_column_int64(stmt, index); }
+    double column_double(int index) const { return sqlite3_column_double(stmt, index); }
+    std::string column_text(int index) const;
+    const void* column_blob(int index) const { return sqlite3_column_blob(stmt, index); }
+    size_t column_bytes(int index) const { return static_cast<size_t>(sqlite3_column_bytes(stmt, index)); }
+    
+    sqlite3_stmt* handle() const { return stmt; }
+};
+
+class SQLiteAdapter {
+private:
+    sqlite3* db;
+    std::string path;
+    
+public:
+    SQLiteAdapter() : db(nullptr) {}
+    ~SQLiteAdapter() { close(); }
+    
+    SQLiteAdapter(const SQLiteAdapter&) = delete;
+    SQLiteAdapter& operator=(const SQLiteAdapter&) = delete;
+    
+    // Connection management
+    bool open(const std::string& database_path);
+    void close();
+    bool is_open() const { return db != nullptr; }
+    const std::string& get_path() const { return path; }
+    
+    // Execute one or more SQL statements without results
+    bool exec(const std::string& sql);
+    
+    // Set a PRAGMA and return the value SQLite reports back (empty on failure)
+    std::string pragma(const std::string& name, const std::string& value);
+    
+    bool prepare(SQLiteStatement& statement, const std::string& sql);
+    
+    // Error reporting
+    std::string last_error() const;
+    int64_t last_insert_rowid() const { return db ? sqlite3_last_insert_rowid(db) : 0; }
+    
+    sqlite3* handle() const { return db; }
+};
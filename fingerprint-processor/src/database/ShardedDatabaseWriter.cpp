@@ -0,0 +1,203 @@
+// ShardedDatabaseWriter.cpp - ShardedDatabaseWriter implementation 
+#include "ShardedDatabaseWriter.h"
+#include "../utils/Logger.h"
+#include "../utils/Timer.h"
+#include <cstdio>
+
+// Columns shared by every shard's rois table (everything except the per-file id)
+static const char* const ROI_COLUMNS = 
+    "filename, file_index, core_rank, core_x, core_y, confidence, "
+    "quality, rotation, processing_time_us, roi, address, address_key, feature_vector, roi_hash, content_hash";
+
+std::string ShardedDatabaseWriter::shard_path(const std::string& base_path, size_t index) {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_shard%02zu", index);
+    
+    size_t dot = base_path.find_last_of('.');
+    size_t slash = base_path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return base_path + suffix;
+    }
+    return base_path.substr(0, dot) + suffix + base_path.substr(dot);
+}
+
+uint64_t ShardedDatabaseWriter::hash_key(const std::string& key) {
+    // FNV-1a: stable across runs and platforms, so a key always maps to the same shard
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool ShardedDatabaseWriter::start(const Config& writer_config) {
+    stop();
+    config = writer_config;
+    if (config.shard_count == 0) config.shard_count = 1;
+    
+    for (size_t i = 0; i < config.shard_count; ++i) {
+        AsyncDatabaseWriter::Config shard_config = config.shard;
+        shard_config.database.database_path = shard_path(config.shard.database.database_path, i);
+        
+        auto shard = std::make_unique<AsyncDatabaseWriter>();
+        if (!shard->start(shard_config)) {
+            Logger::error("Failed to start shard " + std::to_string(i) + ": " + shard_config.database.database_path);
+            stop();
+            return false;
+        }
+        shards.push_back(std::move(shard));
+    }
+    
+    Logger::info("ShardedDatabaseWriter started with " + std::to_string(shards.size()) + " shards (" +
+                (config.partitioning == Partitioning::FILENAME_HASH ? "filename hash" : 
+                 "key prefix " + std::to_string(config.prefix_length)) + ")");
+    return true;
+}
+
+void ShardedDatabaseWriter::stop() {
+    // Each shard drains and closes independently
+    for (auto& shard : shards) {
+        shard->stop();
+    }
+    shards.clear();
+}
+
+size_t ShardedDatabaseWriter::shard_for_key(const std::string& key) const {
+    if (config.partitioning == Partitioning::KEY_PREFIX) {
+        return hash_key(key.substr(0, config.prefix_length)) % shards.size();
+    }
+    return hash_key(key) % shards.size();
+}
+
+std::string ShardedDatabaseWriter::routing_key(const DatabaseWriter::Record& record, const std::string& key) const {
+    // KEY_PREFIX routes by the given key, else by the record's address, else by filename
+    if (config.partitioning == Partitioning::KEY_PREFIX) {
+        if (!key.empty()) return key;
+        if (record.address.text[0] != '\0') return record.address.c_str();
+    }
+    return record.filename;
+}
+
+bool ShardedDatabaseWriter::submit(const CorePointDetector::DetectionResult& result, const std::string& key) {
+    if (shards.empty()) return false;
+    
+    // Every core of one image goes to the same shard, in one unit (one transaction);
+    // addresses are computed here so KEY_PREFIX can route on them
+    AsyncDatabaseWriter::Unit rows = DatabaseWriter::make_records(
+        result, config.shard.database.roi_compression, config.shard.database.describe_rois ? &extractor : nullptr);
+    if (rows.empty()) return true;
+    size_t shard = shard_for_key(routing_key(rows.front(), key));
+    return shards[shard]->submit(std::move(rows));
+}
+
+bool ShardedDatabaseWriter::submit(DatabaseWriter::Record&& record, const std::string& key) {
+    if (shards.empty()) return false;
+    
+    size_t shard = shard_for_key(routing_key(record, key));
+    return shards[shard]->submit(std::move(record));
+}
+
+bool ShardedDatabaseWriter::flush() {
+    bool clean = !shards.empty();
+    for (auto& shard : shards) {
+        clean = shard->flush() && clean;
+    }
+    return clean;
+}
+
+std::vector<std::string> ShardedDatabaseWriter::get_shard_paths() const {
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < config.shard_count; ++i) {
+        paths.push_back(shard_path(config.shard.database.database_path, i));
+    }
+    return paths;
+}
+
+std::vector<AsyncDatabaseWriter::Metrics> ShardedDatabaseWriter::get_metrics() const {
+    std::vector<AsyncDatabaseWriter::Metrics> metrics;
+    for (const auto& shard : shards) {
+        metrics.push_back(shard->get_metrics());
+    }
+    return metrics;
+}
+
+// ShardSet implementation
+bool ShardSet::open(const std::vector<std::string>& shard_paths) {
+    close();
+    
+    if (shard_paths.empty()) {
+        Logger::error("ShardSet: no shards given");
+        return false;
+    }
+    
+    if (!db.open(":memory:")) return false;
+    
+    int attach_limit = sqlite3_limit(db.handle(), SQLITE_LIMIT_ATTACHED, -1);
+    if (static_cast<int>(shard_paths.size()) > attach_limit) {
+        Logger::error("ShardSet: " + std::to_string(shard_paths.size()) + " shards exceed SQLite's limit of " +
+                     std::to_string(attach_limit) + " attached databases; use ShardSet::merge_into instead");
+        db.close();
+        return false;
+    }
+    
+    std::string view_sql = "CREATE TEMP VIEW all_rois AS ";
+    for (size_t i = 0; i < shard_paths.size(); ++i) {
+        SQLiteStatement attach;
+        std::string schema = "shard" + std::to_string(i);
+        if (!db.prepare(attach, "ATTACH DATABASE ?1 AS " + schema + ";") ||
+            !attach.bind_text(1, shard_paths[i]) || !attach.execute()) {
+            Logger::error("ShardSet: failed to attach " + shard_paths[i] + ": " + db.last_error());
+            db.close();
+            return false;
+        }
+        
+        if (i > 0) view_sql += " UNION ALL ";
+        view_sql += "SELECT " + std::to_string(i) + " AS shard, id, " + ROI_COLUMNS + " FROM " + schema + ".rois";
+    }
+    
+    if (!db.exec(view_sql + ";")) {
+        db.close();
+        return false;
+    }
+    
+    paths = shard_paths;
+    return true;
+}
+
+bool ShardSet::merge_into(const std::vector<std::string>& shard_paths, const std::string& destination_path) {
+    DatabaseWriter::Config dest_config;
+    dest_config.database_path = destination_path;
+    
+    // Opening through DatabaseWriter creates the schema and indexes
+    {
+        DatabaseWriter schema_writer;
+        if (!schema_writer.open(dest_config)) return false;
+    }
+    
+    SQLiteAdapter dest;
+    if (!dest.open(destination_path)) return false;
+    
+    Timer merge_timer;
+    merge_timer.start();
+    
+    for (const auto& path : shard_paths) {
+        SQLiteStatement attach;
+        if (!dest.prepare(attach, "ATTACH DATABASE ?1 AS shard;") ||
+            !attach.bind_text(1, path) || !attach.execute()) {
+            Logger::error("ShardSet: failed to attach " + path + ": " + dest.last_error());
+            return false;
+        }
+        
+        bool copied = dest.exec(std::string("BEGIN; INSERT INTO main.rois (") + ROI_COLUMNS + ") SELECT " + 
+                                ROI_COLUMNS + " FROM shard.rois ORDER BY id; COMMIT;");
+        if (!copied) dest.exec("ROLLBACK;");
+        dest.exec("DETACH DATABASE shard;");
+        if (!copied) return false;
+    }
+    
+    dest.exec("ANALYZE;");
+    Logger::info("Merged " + std::to_string(shard_paths.size()) + " shards into " + destination_path + 
+                " in " + Timer::format_time(merge_timer.stop()));
+    return true;
+}
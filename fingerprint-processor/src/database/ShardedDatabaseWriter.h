@@ -0,0 +1,87 @@
+// ShardedDatabaseWriter.h - Parallel ingestion into N SQLite shard files 
+#pragma once
+
+#include "AsyncDatabaseWriter.h"
+#include "SQLiteAdapter.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Writes rows to N independent SQLite files, each with its own writer thread,
+ * so ingestion is no longer serialized on a single database lock.
+ * Rows are partitioned by a hash of the filename, or by a hash of a key
+ * prefix (e.g. the biological address) supplied by the caller.
+ */
+class ShardedDatabaseWriter {
+public:
+    enum class Partitioning {
+        FILENAME_HASH,                      // Hash of Record::filename
+        KEY_PREFIX                          // Hash of the first prefix_length chars of the key (default: the address)
+    };
+    
+    struct Config {
+        AsyncDatabaseWriter::Config shard; // Per-shard settings; database_path is the base name
+        size_t shard_count;
+        Partitioning partitioning;
+        size_t prefix_length;               // KEY_PREFIX only
+        
+        Config() : shard_count(4), partitioning(Partitioning::FILENAME_HASH), prefix_length(4) {}
+    };
+
+private:
+    Config config;
+    std::vector<std::unique_ptr<AsyncDatabaseWriter>> shards;
+    FeatureExtractor extractor;             // Addresses for KEY_PREFIX routing and storage (describe_rois)
+    
+    size_t shard_for_key(const std::string& key) const;
+    std::string routing_key(const DatabaseWriter::Record& record, const std::string& key) const;
+
+public:
+    ShardedDatabaseWriter() = default;
+    ~ShardedDatabaseWriter() { stop(); }
+    
+    ShardedDatabaseWriter(const ShardedDatabaseWriter&) = delete;
+    ShardedDatabaseWriter& operator=(const ShardedDatabaseWriter&) = delete;
+    
+    bool start(const Config& writer_config = Config());
+    void stop();                            // Drains and closes every shard
+    
+    // Route by filename (FILENAME_HASH) or by the given key or record address (KEY_PREFIX)
+    bool submit(const CorePointDetector::DetectionResult& result, const std::string& key = "");
+    bool submit(DatabaseWriter::Record&& record, const std::string& key = "");
+    
+    // Flush every shard; false if any shard dropped rows since its previous flush
+    bool flush();
+    
+    size_t shard_count() const { return shards.size(); }
+    std::vector<std::string> get_shard_paths() const;
+    std::vector<AsyncDatabaseWriter::Metrics> get_metrics() const;
+    
+    // "<dir>/name.db" -> "<dir>/name_shard03.db"
+    static std::string shard_path(const std::string& base_path, size_t index);
+    static uint64_t hash_key(const std::string& key);
+};
+
+/**
+ * Read-side view over a set of shard files
+ * Attaches every shard to one connection and exposes a TEMP view
+ * all_rois (shard, id, ...) = UNION ALL of each shard's rois table
+ */
+class ShardSet {
+private:
+    SQLiteAdapter db;
+    std::vector<std::string> paths;
+
+public:
+    // Attach the shards; limited by SQLite's attached-database limit (10 by default)
+    bool open(const std::vector<std::string>& shard_paths);
+    void close() { db.close(); paths.clear(); }
+    
+    // Connection with the all_rois view, for preparing queries
+    SQLiteAdapter& connection() { return db; }
+    size_t size() const { return paths.size(); }
+    
+    // Copy all shard rows into a single database file (one shard attached at a time)
+    static bool merge_into(const std::vector<std::string>& shard_paths, const std::string& destination_path);
+};
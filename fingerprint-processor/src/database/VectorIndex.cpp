@@ -0,0 +1,470 @@
+// VectorIndex.cpp - VectorIndex implementation 
+#include "VectorIndex.h"
+#include "SQLiteAdapter.h"
+#include "../utils/Logger.h"
+#include "../utils/Timer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+constexpr size_t FLOATS_PER_REGISTER = 8;
+
+// Both kernels take lengths that are a multiple of 8 (vectors are zero padded to the stride)
+inline float l2_squared(const float* a, const float* b, size_t length) {
+#ifdef __AVX2__
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+        sum1 = _mm256_fmadd_ps(d1, d1, sum1);
+    }
+    if (i < length) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+    }
+    __m256 sum = _mm256_add_ps(sum0, sum1);
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_movehdup_ps(half));
+    return _mm_cvtss_f32(half);
+#else
+    float sum = 0;
+    for (size_t i = 0; i < length; ++i) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+#endif
+}
+
+inline float dot_product(const float* a, const float* b, size_t length) {
+#ifdef __AVX2__
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+    }
+    if (i < length) {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+    }
+    __m256 sum = _mm256_add_ps(sum0, sum1);
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_movehdup_ps(half));
+    return _mm_cvtss_f32(half);
+#else
+    float sum = 0;
+    for (size_t i = 0; i < length; ++i) sum += a[i] * b[i];
+    return sum;
+#endif
+}
+
+// Run body(begin, end) over [0, count) on all cores (assignment passes dominate build time)
+template<typename Body>
+void parallel_for(size_t count, Body body) {
+    size_t threads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), count / 1024));
+    if (threads <= 1) {
+        body(size_t(0), count);
+        return;
+    }
+    
+    std::vector<std::thread> workers;
+    size_t chunk = (count + threads - 1) / threads;
+    for (size_t begin = 0; begin < count; begin += chunk) {
+        workers.emplace_back(body, begin, std::min(count, begin + chunk));
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+} // namespace
+
+VectorIndex::VectorIndex(const Config& index_config)
+    : config(index_config)
+    , trained_count(0)
+    , rebuilding(false) {
+    if (config.dimension == 0) {
+        config.dimension = FeatureExtractor::FeatureVector::DIM;
+        Logger::warning("VectorIndex dimension must be positive, using the feature vector size");
+    }
+    config.probes = std::max<size_t>(config.probes, 1);
+    stride = (config.dimension + FLOATS_PER_REGISTER - 1) / FLOATS_PER_REGISTER * FLOATS_PER_REGISTER;
+    current.lists.resize(1);
+}
+
+VectorIndex::~VectorIndex() {
+    if (rebuild_thread.joinable()) rebuild_thread.join();
+}
+
+void VectorIndex::prepare_vector(const float* vector, float* destination) const {
+    memcpy(destination, vector, config.dimension * sizeof(float));
+    std::fill(destination + config.dimension, destination + stride, 0.0f);
+    if (config.metric == Metric::COSINE) normalize(destination);
+}
+
+void VectorIndex::normalize(float* vector) const {
+    float norm = std::sqrt(dot_product(vector, vector, stride));
+    if (norm > 0) {
+        float scale = 1.0f / norm;
+        for (size_t i = 0; i < stride; ++i) vector[i] *= scale;
+    }
+}
+
+float VectorIndex::distance(const float* a, const float* b) const {
+    return config.metric == Metric::COSINE ? 1.0f - dot_product(a, b, stride) : l2_squared(a, b, stride);
+}
+
+size_t VectorIndex::nearest_centroid(const float* vector, const std::vector<float>& table) const {
+    size_t list_count = table.size() / stride;
+    size_t best = 0;
+    float best_distance = distance(vector, table.data());
+    for (size_t c = 1; c < list_count; ++c) {
+        float d = distance(vector, table.data() + c * stride);
+        if (d < best_distance) {
+            best_distance = d;
+            best = c;
+        }
+    }
+    return best;
+}
+
+std::vector<float> VectorIndex::train(const std::vector<float>& vectors, size_t count) const {
+    size_t list_count = config.lists > 0 ? config.lists
+                                         : static_cast<size_t>(std::sqrt(static_cast<double>(count)));
+    list_count = std::max<size_t>(1, std::min(list_count, count));
+    
+    // Evenly spaced sample, at least a few dozen points per centroid when available
+    size_t sample_size = std::min(count, std::max(config.max_train_sample, list_count * 32));
+    std::vector<float> sample(sample_size * stride);
+    for (size_t i = 0; i < sample_size; ++i) {
+        size_t source = i * count / sample_size;
+        memcpy(&sample[i * stride], &vectors[source * stride], stride * sizeof(float));
+    }
+    
+    // Seed with distinct random sample points (fixed seed: rebuilds are reproducible)
+    std::mt19937 rng(12345);
+    std::vector<size_t> order(sample_size);
+    for (size_t i = 0; i < sample_size; ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+    
+    std::vector<float> trained(list_count * stride);
+    for (size_t c = 0; c < list_count; ++c) {
+        memcpy(&trained[c * stride], &sample[order[c] * stride], stride * sizeof(float));
+    }
+    
+    std::vector<uint32_t> assignment(sample_size);
+    std::vector<double> sums(list_count * stride);
+    std::vector<size_t> members(list_count);
+    
+    for (int iteration = 0; iteration < config.train_iterations; ++iteration) {
+        parallel_for(sample_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                assignment[i] = static_cast<uint32_t>(nearest_centroid(&sample[i * stride], trained));
+            }
+        });
+        
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(members.begin(), members.end(), 0);
+        for (size_t i = 0; i < sample_size; ++i) {
+            double* sum = &sums[assignment[i] * stride];
+            const float* point = &sample[i * stride];
+            for (size_t d = 0; d < stride; ++d) sum[d] += point[d];
+            members[assignment[i]]++;
+        }
+        
+        for (size_t c = 0; c < list_count; ++c) {
+            float* centroid = &trained[c * stride];
+            if (members[c] == 0) {
+                // Empty cluster: restart it from a random point of the largest one
+                size_t largest = std::max_element(members.begin(), members.end()) - members.begin();
+                for (size_t i = rng() % sample_size, n = 0; n < sample_size; ++n, i = (i + 1) % sample_size) {
+                    if (assignment[i] == largest) {
+                        memcpy(centroid, &sample[i * stride], stride * sizeof(float));
+                        break;
+                    }
+                }
+                continue;
+            }
+            
+            double scale = 1.0 / members[c];
+            for (size_t d = 0; d < stride; ++d) centroid[d] = static_cast<float>(sums[c * stride + d] * scale);
+            if (config.metric == Metric::COSINE) normalize(centroid);     // Spherical k-means
+        }
+    }
+    return trained;
+}
+
+void VectorIndex::build_lists(std::vector<float>&& vectors, std::vector<int64_t>&& ids, Layout& layout) const {
+    Timer timer;
+    timer.start();
+    
+    size_t count = ids.size();
+    layout.centroids.clear();
+    layout.lists.clear();
+    layout.vector_count = count;
+    
+    if (count < config.min_train_size) {
+        // Too few vectors to cluster: one exact list
+        layout.lists.resize(1);
+        layout.lists[0].vectors = std::move(vectors);
+        layout.lists[0].ids = std::move(ids);
+        layout.train_time_ms = timer.stop() / 1000.0;
+        return;
+    }
+    
+    layout.centroids = train(vectors, count);
+    size_t list_count = layout.centroids.size() / stride;
+    
+    std::vector<uint32_t> assignment(count);
+    parallel_for(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            assignment[i] = static_cast<uint32_t>(nearest_centroid(&vectors[i * stride], layout.centroids));
+        }
+    });
+    
+    std::vector<size_t> members(list_count);
+    for (uint32_t list : assignment) members[list]++;
+    
+    layout.lists.resize(list_count);
+    for (size_t c = 0; c < list_count; ++c) {
+        layout.lists[c].vectors.reserve(members[c] * stride);
+        layout.lists[c].ids.reserve(members[c]);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        InvertedList& list = layout.lists[assignment[i]];
+        list.vectors.insert(list.vectors.end(), &vectors[i * stride], &vectors[i * stride] + stride);
+        list.ids.push_back(ids[i]);
+    }
+    
+    layout.train_time_ms = timer.stop() / 1000.0;
+    Logger::info("VectorIndex trained " + std::to_string(list_count) + " lists over " +
+                 std::to_string(count) + " vectors in " + std::to_string(static_cast<int>(layout.train_time_ms)) + " ms");
+}
+
+void VectorIndex::insert_locked(Layout& target, int64_t id, const float* vector) const {
+    InvertedList& list = target.lists[target.centroids.empty() ? 0 : nearest_centroid(vector, target.centroids)];
+    list.vectors.insert(list.vectors.end(), vector, vector + stride);
+    list.ids.push_back(id);
+    target.vector_count++;
+}
+
+void VectorIndex::rebuild_from_snapshot() {
+    // Snapshot under the shared lock: queries continue, adds wait only for the copy.
+    // Adds made since rebuilding was set are already in the snapshot; replay only later ones
+    std::vector<float> vectors;
+    std::vector<int64_t> ids;
+    size_t replay_from = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        vectors.reserve(current.vector_count * stride);
+        ids.reserve(current.vector_count);
+        for (const auto& list : current.lists) {
+            vectors.insert(vectors.end(), list.vectors.begin(), list.vectors.end());
+            ids.insert(ids.end(), list.ids.begin(), list.ids.end());
+        }
+        replay_from = backlog_ids.size();
+    }
+    
+    Layout rebuilt;
+    build_lists(std::move(vectors), std::move(ids), rebuilt);
+    
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (size_t i = replay_from; i < backlog_ids.size(); ++i) {
+            insert_locked(rebuilt, backlog_ids[i], &backlog_vectors[i * stride]);
+        }
+        backlog_ids.clear();
+        backlog_vectors.clear();
+        current = std::move(rebuilt);
+        trained_count = current.vector_count;
+        rebuilding = false;
+    }
+    rebuild_done.notify_all();
+}
+
+void VectorIndex::replace_layout(Layout&& layout) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    rebuild_done.wait(lock, [this] { return !rebuilding; });
+    current = std::move(layout);
+    trained_count = current.vector_count;
+}
+
+bool VectorIndex::build(const std::vector<int64_t>& ids, const float* vectors, size_t count) {
+    if (ids.size() != count || (count > 0 && !vectors)) {
+        Logger::error("VectorIndex: build called with mismatched ids and vectors");
+        return false;
+    }
+    
+    std::vector<float> padded(count * stride);
+    for (size_t i = 0; i < count; ++i) {
+        prepare_vector(vectors + i * config.dimension, &padded[i * stride]);
+    }
+    
+    Layout built;
+    build_lists(std::move(padded), std::vector<int64_t>(ids), built);
+    replace_layout(std::move(built));
+    return true;
+}
+
+bool VectorIndex::load_from_database(const std::string& database_path) {
+    SQLiteAdapter db;
+    SQLiteStatement select;
+    if (!db.open(database_path) ||
+        !db.prepare(select, "SELECT id, feature_vector FROM rois WHERE feature_vector IS NOT NULL ORDER BY id;")) {
+        Logger::error("VectorIndex: cannot read feature vectors from " + database_path);
+        return false;
+    }
+    
+    std::vector<int64_t> ids;
+    std::vector<float> vectors;
+    size_t skipped = 0;
+    
+    int rc;
+    while ((rc = select.step()) == SQLITE_ROW) {
+        if (select.column_bytes(1) != config.dimension * sizeof(float)) {
+            ++skipped;
+            continue;
+        }
+        const float* vector = static_cast<const float*>(select.column_blob(1));
+        
+        vectors.resize((ids.size() + 1) * stride);
+        prepare_vector(vector, &vectors[ids.size() * stride]);
+        ids.push_back(select.column_int64(0));
+    }
+    if (rc != SQLITE_DONE) {
+        Logger::error("VectorIndex: reading " + database_path + " failed: " + db.last_error());
+        return false;
+    }
+    if (skipped > 0) {
+        Logger::warning("VectorIndex: skipped " + std::to_string(skipped) +
+                        " feature vectors of the wrong dimension in " + database_path);
+    }
+    
+    size_t loaded = ids.size();
+    Layout built;
+    build_lists(std::move(vectors), std::move(ids), built);
+    replace_layout(std::move(built));
+    Logger::info("VectorIndex loaded " + std::to_string(loaded) + " vectors from " + database_path);
+    return true;
+}
+
+bool VectorIndex::add(int64_t id, const float* vector) {
+    if (!vector) return false;
+    
+    std::vector<float> padded(stride);
+    prepare_vector(vector, padded.data());
+    
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    insert_locked(current, id, padded.data());
+    
+    if (rebuilding) {
+        // The rebuild in progress works on a snapshot; replay this insert when it lands
+        backlog_ids.push_back(id);
+        backlog_vectors.insert(backlog_vectors.end(), padded.begin(), padded.end());
+        return true;
+    }
+    
+    // Untrained indexes train once large enough; trained ones retrain as their lists grow long
+    bool grown = current.centroids.empty() ? current.vector_count >= config.min_train_size
+                                           : current.vector_count >= trained_count * 4;
+    if (config.auto_rebuild && grown) {
+        // Hand the training to a background thread; this add() returns right away.
+        // The previous rebuild thread has already cleared rebuilding, so it joins at once
+        rebuilding = true;
+        if (rebuild_thread.joinable()) rebuild_thread.join();
+        rebuild_thread = std::thread(&VectorIndex::rebuild_from_snapshot, this);
+    }
+    return true;
+}
+
+void VectorIndex::rebuild() {
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (rebuilding) return;
+        rebuilding = true;
+    }
+    rebuild_from_snapshot();
+}
+
+void VectorIndex::wait_for_rebuild() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    rebuild_done.wait(lock, [this] { return !rebuilding; });
+}
+
+std::vector<VectorIndex::Neighbor> VectorIndex::search(const float* query, size_t k) const {
+    std::vector<Neighbor> heap;
+    if (!query || k == 0) return heap;
+    
+    std::vector<float> query_vector(stride);
+    prepare_vector(query, query_vector.data());
+    const float* padded = query_vector.data();
+    
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const std::vector<float>& centroids = current.centroids;
+    
+    // Lists to scan: the probes nearest centroids (or the single exact list)
+    std::vector<std::pair<float, size_t>> probe_order;
+    if (centroids.empty()) {
+        probe_order.emplace_back(0.0f, 0);
+    } else {
+        size_t list_count = centroids.size() / stride;
+        probe_order.resize(list_count);
+        for (size_t c = 0; c < list_count; ++c) {
+            probe_order[c] = { distance(padded, centroids.data() + c * stride), c };
+        }
+        size_t probes = std::min(config.probes, list_count);
+        std::partial_sort(probe_order.begin(), probe_order.begin() + probes, probe_order.end());
+        probe_order.resize(probes);
+    }
+    
+    // Max-heap on distance holding the best k so far
+    auto farther = [](const Neighbor& a, const Neighbor& b) { return a.distance < b.distance; };
+    heap.reserve(k);
+    
+    for (const auto& probe : probe_order) {
+        const InvertedList& list = current.lists[probe.second];
+        const float* vector = list.vectors.data();
+        for (size_t i = 0; i < list.ids.size(); ++i, vector += stride) {
+            float d = distance(padded, vector);
+            if (heap.size() < k) {
+                heap.emplace_back(list.ids[i], d);
+                std::push_heap(heap.begin(), heap.end(), farther);
+            } else if (d < heap.front().distance) {
+                std::pop_heap(heap.begin(), heap.end(), farther);
+                heap.back() = Neighbor(list.ids[i], d);
+                std::push_heap(heap.begin(), heap.end(), farther);
+            }
+        }
+    }
+    
+    std::sort_heap(heap.begin(), heap.end(), farther);
+    return heap;
+}
+
+size_t VectorIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return current.vector_count;
+}
+
+VectorIndex::IndexStats VectorIndex::get_stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    
+    IndexStats index_stats;
+    index_stats.vectors = current.vector_count;
+    index_stats.lists = current.lists.size();
+    index_stats.trained = !current.centroids.empty();
+    index_stats.train_time_ms = current.train_time_ms;
+    for (const auto& list : current.lists) {
+        index_stats.largest_list = std::max(index_stats.largest_list, list.ids.size());
+    }
+    return index_stats;
+}
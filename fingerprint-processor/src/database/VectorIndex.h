@@ -0,0 +1,151 @@
+// VectorIndex.h - In-memory nearest-neighbour search over ROI feature vectors 
+#pragma once
+
+#include "../core/FeatureExtractor.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * IVF-flat index over FeatureExtractor feature vectors
+ * Vectors are clustered by k-means into inverted lists and a query scans only
+ * the lists of its nearest centroids, with AVX2 distance kernels. Below
+ * min_train_size vectors the index is a single list and queries are exact.
+ * Bulk-loaded from the feature_vector column written by DatabaseWriter, then
+ * kept current with add(); queries take a shared lock and run concurrently.
+ * Retraining triggered by add() runs on a background thread: it copies the
+ * lists under the shared lock, trains a new layout without any lock, and swaps
+ * it in under the exclusive lock after replaying the inserts made meanwhile
+ */
+class VectorIndex {
+public:
+    enum class Metric {
+        L2,                                 // Squared Euclidean distance
+        COSINE                              // 1 - cosine similarity (vectors normalized on insert)
+    };
+    
+    struct Config {
+        size_t dimension;                   // Floats per vector
+        Metric metric;
+        size_t lists;                       // Inverted lists (0 = about sqrt(vectors) at training time)
+        size_t probes;                      // Lists scanned per query (recall vs. latency)
+        size_t min_train_size;              // Exact single-list search below this many vectors
+        size_t max_train_sample;            // Vectors given to k-means (evenly sampled)
+        int train_iterations;               // Lloyd iterations
+        bool auto_rebuild;                  // Retrain from add() once the index has grown 4x since training
+        
+        Config()
+            : dimension(FeatureExtractor::FeatureVector::DIM)
+            , metric(Metric::L2)
+            , lists(0)
+            , probes(8)
+            , min_train_size(4096)
+            , max_train_sample(65536)
+            , train_iterations(10)
+            , auto_rebuild(true) {}
+    };
+    
+    struct Neighbor {
+        int64_t id;                         // rois row id (or the id given to add())
+        float distance;                     // Per Config::metric
+        
+        Neighbor() : id(0), distance(0) {}
+        Neighbor(int64_t i, float d) : id(i), distance(d) {}
+    };
+    
+    struct IndexStats {
+        size_t vectors;
+        size_t lists;
+        size_t largest_list;                // Entries in the longest list (worst-case probe cost)
+        bool trained;
+        double train_time_ms;               // Duration of the last (re)build
+        
+        IndexStats() : vectors(0), lists(0), largest_list(0), trained(false), train_time_ms(0) {}
+    };
+
+private:
+    struct InvertedList {
+        std::vector<float> vectors;         // stride floats per entry, zero padded
+        std::vector<int64_t> ids;
+    };
+    
+    // Centroids and lists, replaced as a whole by (re)builds
+    struct Layout {
+        std::vector<float> centroids;       // lists x stride; empty while untrained (one exact list)
+        std::vector<InvertedList> lists;
+        size_t vector_count;
+        double train_time_ms;
+        
+        Layout() : lists(1), vector_count(0), train_time_ms(0) {}
+    };
+    
+    Config config;
+    size_t stride;                          // dimension rounded up to a whole AVX2 register
+    
+    Layout current;
+    size_t trained_count;                   // Vectors present at the last (re)build
+    
+    // add() during a rebuild also records the vector here, for replay into the new layout
+    bool rebuilding;
+    std::vector<float> backlog_vectors;
+    std::vector<int64_t> backlog_ids;
+    
+    mutable std::shared_mutex mutex;
+    std::condition_variable_any rebuild_done;
+    std::thread rebuild_thread;             // Background retraining started by add()
+    
+    // Pad to stride (and normalize for COSINE)
+    void prepare_vector(const float* vector, float* destination) const;
+    void normalize(float* vector) const;
+    float distance(const float* a, const float* b) const;
+    size_t nearest_centroid(const float* vector, const std::vector<float>& table) const;
+    
+    // k-means centroids for the given padded vectors
+    std::vector<float> train(const std::vector<float>& vectors, size_t count) const;
+    void build_lists(std::vector<float>&& vectors, std::vector<int64_t>&& ids, Layout& layout) const;
+    void insert_locked(Layout& target, int64_t id, const float* vector) const;
+    
+    // Called without the lock after the caller set rebuilding; swaps the new layout in
+    void rebuild_from_snapshot();
+    
+    // Install a layout built by build()/load_from_database() once no rebuild is running
+    void replace_layout(Layout&& layout);
+
+public:
+    explicit VectorIndex(const Config& index_config = Config());
+    ~VectorIndex();                         // Waits for a background rebuild
+    
+    VectorIndex(const VectorIndex&) = delete;
+    VectorIndex& operator=(const VectorIndex&) = delete;
+    
+    // Replace the contents; vectors holds count x dimension floats
+    bool build(const std::vector<int64_t>& ids, const float* vectors, size_t count);
+    
+    // Bulk load every feature_vector stored in a DatabaseWriter database
+    bool load_from_database(const std::string& database_path);
+    
+    // Incremental insert into the nearest list (reads dimension floats)
+    bool add(int64_t id, const float* vector);
+    bool add(int64_t id, const FeatureExtractor::FeatureVector& vector) { return add(id, vector.values); }
+    
+    // Retrain the lists on the current contents on the calling thread
+    // (no-op while a rebuild is running)
+    void rebuild();
+    
+    // Block until no rebuild is running
+    void wait_for_rebuild();
+    
+    // k nearest neighbours, closest first
+    std::vector<Neighbor> search(const float* query, size_t k) const;
+    std::vector<Neighbor> search(const FeatureExtractor::FeatureVector& query, size_t k) const {
+        return search(query.values, k);
+    }
+    
+    size_t size() const;
+    IndexStats get_stats() const;
+    const Config& get_config() const { return config; }
+};
@@ -0,0 +1,115 @@
+// DetectionClient.cpp - DetectionClient implementation 
+#include "DetectionClient.h"
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+bool DetectionClient::connect(const std::string& socket_path) {
+    disconnect();
+    
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    memcpy(address.sun_path, socket_path.c_str(), socket_path.size());
+    
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+void DetectionClient::disconnect() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+static uint8_t request_flags(bool include_rois, bool screen_duplicates) {
+    return static_cast<uint8_t>((include_rois ? DetectionProtocol::FLAG_INCLUDE_ROIS : 0) |
+                                (screen_duplicates ? DetectionProtocol::FLAG_SCREEN_DUPLICATES : 0));
+}
+
+bool DetectionClient::detect_encoded(const void* data, size_t size, Response& response, bool include_rois,
+                                     bool screen_duplicates) {
+    DetectionProtocol::RequestHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = DetectionProtocol::REQUEST_MAGIC;
+    header.version = DetectionProtocol::VERSION;
+    header.format = DetectionProtocol::FORMAT_ENCODED;
+    header.flags = request_flags(include_rois, screen_duplicates);
+    header.payload_size = static_cast<uint32_t>(size);
+    return request(header, data, response);
+}
+
+bool DetectionClient::detect_raw(const uint8_t* pixels, int width, int height, Response& response, bool include_rois,
+                                 bool screen_duplicates) {
+    DetectionProtocol::RequestHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = DetectionProtocol::REQUEST_MAGIC;
+    header.version = DetectionProtocol::VERSION;
+    header.format = DetectionProtocol::FORMAT_RAW;
+    header.flags = request_flags(include_rois, screen_duplicates);
+    header.width = static_cast<uint16_t>(width);
+    header.height = static_cast<uint16_t>(height);
+    header.payload_size = static_cast<uint32_t>(width) * static_cast<uint32_t>(height);
+    return request(header, pixels, response);
+}
+
+bool DetectionClient::request(const DetectionProtocol::RequestHeader& header, const void* data, Response& response) {
+    if (fd < 0) return false;
+    
+    if (!DetectionProtocol::send_all(fd, &header, sizeof(header))) {
+        disconnect();
+        return false;
+    }
+    
+    // A server rejecting the header answers and hangs up without reading the
+    // payload, so a failed payload send still leaves that answer to be read
+    bool sent = DetectionProtocol::send_all(fd, data, header.payload_size);
+    
+    DetectionProtocol::ResponseHeader reply;
+    if (!DetectionProtocol::recv_all(fd, &reply, sizeof(reply)) ||
+        reply.magic != DetectionProtocol::RESPONSE_MAGIC || reply.version != DetectionProtocol::VERSION) {
+        disconnect();
+        return false;
+    }
+    
+    size_t fixed_size = sizeof(float) + reply.core_count * sizeof(DetectionProtocol::CoreRecord) +
+                        reply.roi_count * DetectionProtocol::ROI_BYTES;
+    payload.resize(reply.payload_size);
+    if (reply.payload_size < fixed_size || !DetectionProtocol::recv_all(fd, payload.data(), payload.size())) {
+        disconnect();
+        return false;
+    }
+    
+    const uint8_t* in = payload.data();
+    response.status = reply.status;
+    response.processing_time_us = reply.processing_time_us;
+    memcpy(&response.overall_quality, in, sizeof(float));
+    in += sizeof(float);
+    
+    response.cores.resize(reply.core_count);
+    memcpy(response.cores.data(), in, reply.core_count * sizeof(DetectionProtocol::CoreRecord));
+    in += reply.core_count * sizeof(DetectionProtocol::CoreRecord);
+    
+    response.rois.assign(in, in + reply.roi_count * DetectionProtocol::ROI_BYTES);
+    in += reply.roi_count * DetectionProtocol::ROI_BYTES;
+    
+    response.error_message.assign(reinterpret_cast<const char*>(in), payload.size() - fixed_size);
+    
+    if (!sent || reply.status == DetectionProtocol::STATUS_TOO_LARGE ||
+        (reply.status == DetectionProtocol::STATUS_BAD_REQUEST && header.format != DetectionProtocol::FORMAT_RAW)) {
+        disconnect();    // The server dropped the connection
+    }
+    return true;
+}
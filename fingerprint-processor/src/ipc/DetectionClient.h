@@ -0,0 +1,55 @@
+// DetectionClient.h - Client side of the local detection socket 
+#pragma once
+
+#include "DetectionProtocol.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Blocking client for DetectionServer; one request in flight per client
+ * Has no OpenCV dependency, so lightweight tools can link it on its own.
+ */
+class DetectionClient {
+public:
+    struct Response {
+        uint8_t status;                     // DetectionProtocol::Status
+        float overall_quality;
+        uint32_t processing_time_us;        // Detection time inside the server
+        std::vector<DetectionProtocol::CoreRecord> cores;   // Best first
+        std::vector<uint8_t> rois;          // ROI_BYTES per core, when requested
+        std::string error_message;
+        
+        Response() : status(DetectionProtocol::STATUS_INTERNAL_ERROR), overall_quality(0), processing_time_us(0) {}
+        bool found() const { return status == DetectionProtocol::STATUS_OK || duplicate(); }
+        bool duplicate() const { return status == DetectionProtocol::STATUS_DUPLICATE; }
+    };
+
+private:
+    int fd;
+    std::vector<uint8_t> payload;
+    
+    bool request(const DetectionProtocol::RequestHeader& header, const void* data, Response& response);
+
+public:
+    DetectionClient() : fd(-1) {}
+    ~DetectionClient() { disconnect(); }
+    
+    DetectionClient(const DetectionClient&) = delete;
+    DetectionClient& operator=(const DetectionClient&) = delete;
+    
+    bool connect(const std::string& socket_path);
+    void disconnect();
+    bool is_connected() const { return fd >= 0; }
+    
+    // Send an encoded image file (PNG, BMP, ...) and wait for the answer.
+    // Returns false on a transport failure (the connection is then closed);
+    // detection and request errors come back in response.status.
+    // screen_duplicates asks for STATUS_DUPLICATE on near-duplicates of earlier screened requests.
+    bool detect_encoded(const void* data, size_t size, Response& response, bool include_rois = false,
+                        bool screen_duplicates = false);
+    
+    // Send width x height 8-bit grayscale pixels, rows packed
+    bool detect_raw(const uint8_t* pixels, int width, int height, Response& response, bool include_rois = false,
+                    bool screen_duplicates = false);
+};
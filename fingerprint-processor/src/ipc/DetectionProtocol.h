@@ -0,0 +1,136 @@
+// DetectionProtocol.h - Binary framing for the local detection socket 
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+/**
+ * Request/response framing spoken over the detection server's Unix socket
+ *
+ * A connection carries any number of requests; each is answered in order before
+ * the next one is read. All integers are little-endian.
+ *
+ * Request: 16-byte RequestHeader, then payload_size bytes
+ *   FORMAT_ENCODED  any image file OpenCV can decode (PNG, BMP, TIFF, ...); width/height ignored
+ *   FORMAT_RAW      width * height 8-bit grayscale pixels, rows packed (no stride)
+ *
+ * Response: 16-byte ResponseHeader, then payload_size bytes:
+ *   float overall_quality
+ *   core_count CoreRecords (16 bytes each), best first
+ *   roi_count ROIs of ROI_SIZE * ROI_SIZE pixels, one per core (only with FLAG_INCLUDE_ROIS)
+ *   error message (the remaining bytes, empty on success)
+ *
+ * With FLAG_SCREEN_DUPLICATES the server also compares the primary ROI's perceptual
+ * hash against every ROI it has already answered for with that flag, and reports a
+ * near-duplicate as STATUS_DUPLICATE: cores and ROIs are sent as for STATUS_OK and
+ * the message names the earlier request.
+ *
+ * A header with a bad magic, version or format, or a payload over the server's
+ * limit (STATUS_TOO_LARGE), is answered and the connection closed, since the rest
+ * of the stream can no longer be framed.
+ */
+class DetectionProtocol {
+public:
+    static constexpr uint32_t REQUEST_MAGIC = 0x51525046;     // "FPRQ"
+    static constexpr uint32_t RESPONSE_MAGIC = 0x53525046;    // "FPRS"
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t ROI_SIZE = 101;
+    static constexpr size_t ROI_BYTES = ROI_SIZE * ROI_SIZE;
+    
+    enum Format : uint8_t {
+        FORMAT_ENCODED = 0,
+        FORMAT_RAW = 1
+    };
+    
+    enum Flags : uint8_t {
+        FLAG_INCLUDE_ROIS = 1 << 0,
+        FLAG_SCREEN_DUPLICATES = 1 << 1
+    };
+    
+    enum Status : uint8_t {
+        STATUS_OK = 0,                      // Core point(s) found
+        STATUS_NO_CORE = 1,                 // Image processed, no core above min_confidence
+        STATUS_BAD_REQUEST = 2,             // Bad magic, version or format, or raw size mismatch
+        STATUS_DECODE_FAILED = 3,           // Payload is not a decodable image
+        STATUS_TOO_LARGE = 4,               // Payload exceeds the server's limit
+        STATUS_INTERNAL_ERROR = 5,
+        STATUS_DUPLICATE = 6                // Core point(s) found, ROI near an earlier one (FLAG_SCREEN_DUPLICATES)
+    };
+    
+    struct RequestHeader {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t format;
+        uint8_t flags;
+        uint8_t reserved;
+        uint16_t width;                     // FORMAT_RAW only
+        uint16_t height;                    // FORMAT_RAW only
+        uint32_t payload_size;
+    };
+    
+    struct ResponseHeader {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t status;
+        uint8_t core_count;
+        uint8_t roi_count;
+        uint32_t processing_time_us;        // Detection time inside the server
+        uint32_t payload_size;
+    };
+    
+    struct CoreRecord {
+        float x, y;
+        float confidence;
+        float rotation;                     // Angle applied when the ROI was extracted (radians)
+    };
+    
+    static const char* status_name(uint8_t status) {
+        switch (status) {
+            case STATUS_OK: return "ok";
+            case STATUS_NO_CORE: return "no core";
+            case STATUS_BAD_REQUEST: return "bad request";
+            case STATUS_DECODE_FAILED: return "decode failed";
+            case STATUS_TOO_LARGE: return "too large";
+            case STATUS_INTERNAL_ERROR: return "internal error";
+            case STATUS_DUPLICATE: return "duplicate";
+            default: return "unknown";
+        }
+    }
+    
+    // Blocking exact-length socket I/O; false on EOF, error or socket timeout
+    static bool send_all(int fd, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0) {
+            ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            bytes += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+    
+    static bool recv_all(int fd, void* data, size_t size) {
+        uint8_t* bytes = static_cast<uint8_t*>(data);
+        while (size > 0) {
+            ssize_t received = ::recv(fd, bytes, size, 0);
+            if (received < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (received == 0) return false;
+            bytes += received;
+            size -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+};
+
+static_assert(sizeof(DetectionProtocol::RequestHeader) == 16, "Request header must be 16 bytes");
+static_assert(sizeof(DetectionProtocol::ResponseHeader) == 16, "Response header must be 16 bytes");
+static_assert(sizeof(DetectionProtocol::CoreRecord) == 16, "Core record must be 16 bytes");
@@ -0,0 +1,412 @@
+// DetectionServer.cpp - DetectionServer implementation 
+#include "DetectionServer.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef DetectionProtocol Protocol;
+
+DetectionServer::DetectionServer()
+    : listen_fd(-1), wake_fd(-1), running(false), open_connections(0),
+      connections_accepted(0), connections_rejected(0), requests(0), requests_failed(0),
+      cores_found(0), duplicates(0), bytes_received(0), bytes_sent(0), detection_time_us(0) {}
+
+bool DetectionServer::start(const Config& server_config) {
+    stop();
+    
+    config = server_config;
+    if (config.worker_count == 0) {
+        config.worker_count = static_cast<size_t>(std::max(1L, sysconf(_SC_NPROCESSORS_ONLN)));
+    }
+    config.max_connections = std::max<size_t>(1, config.max_connections);
+    
+    if (!bind_socket()) {
+        return false;
+    }
+    
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        Logger::error("eventfd failed: " + std::string(strerror(errno)));
+        stop();
+        return false;
+    }
+    
+    // Every connection is either idle in the poller, queued or with a worker, so
+    // a queue as large as the connection limit never blocks the I/O thread
+    ready_connections = std::make_unique<ThreadSafeQueue<int>>(config.max_connections);
+    
+    connections_accepted = 0;
+    connections_rejected = 0;
+    requests = 0;
+    requests_failed = 0;
+    cores_found = 0;
+    duplicates = 0;
+    bytes_received = 0;
+    bytes_sent = 0;
+    detection_time_us = 0;
+    screened_rois.clear();
+    
+    running = true;
+    io_thread = std::thread(&DetectionServer::io_loop, this);
+    for (size_t i = 0; i < config.worker_count; ++i) {
+        workers.emplace_back(&DetectionServer::worker_loop, this);
+    }
+    
+    Logger::info("Detection server listening on " + config.socket_path + " (" +
+                std::to_string(config.worker_count) + " workers)");
+    return true;
+}
+
+void DetectionServer::stop() {
+    if (listen_fd < 0 && wake_fd < 0) return;
+    
+    running = false;
+    if (wake_fd >= 0) wake();
+    if (io_thread.joinable()) io_thread.join();
+    
+    // Workers drain the queue, closing connections instead of serving them
+    if (ready_connections) ready_connections->close();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    ready_connections.reset();
+    
+    {
+        std::lock_guard<std::mutex> lock(returned_mutex);
+        for (int fd : returned_connections) close_connection(fd);
+        returned_connections.clear();
+    }
+    
+    if (wake_fd >= 0) {
+        close(wake_fd);
+        wake_fd = -1;
+    }
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(config.socket_path.c_str());
+        Logger::info("Detection server stopped after " + std::to_string(requests.load()) + " requests");
+    }
+}
+
+bool DetectionServer::bind_socket() {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (config.socket_path.empty() || config.socket_path.size() >= sizeof(address.sun_path)) {
+        Logger::error("Invalid socket path: " + config.socket_path);
+        return false;
+    }
+    memcpy(address.sun_path, config.socket_path.c_str(), config.socket_path.size());
+    
+    struct stat existing;
+    if (lstat(config.socket_path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            Logger::error(config.socket_path + " exists and is not a socket");
+            return false;
+        }
+        
+        // Only a stale socket left by a server that died is replaced; a live one answers connect()
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && connect(probe, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) close(probe);
+        if (live) {
+            Logger::error("Another server is already listening on " + config.socket_path);
+            return false;
+        }
+        unlink(config.socket_path.c_str());
+    }
+    
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        Logger::error("socket failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    
+    if (bind(listen_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        Logger::error("Cannot bind " + config.socket_path + ": " + strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    
+    if (chmod(config.socket_path.c_str(), config.socket_mode) != 0 || listen(listen_fd, SOMAXCONN) != 0) {
+        Logger::error("Cannot listen on " + config.socket_path + ": " + strerror(errno));
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(config.socket_path.c_str());
+        return false;
+    }
+    
+    return true;
+}
+
+void DetectionServer::wake() {
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd, &one, sizeof(one));
+    (void)written;    // Only fails when the counter is already non-zero, which wakes the poller anyway
+}
+
+void DetectionServer::close_connection(int fd) {
+    close(fd);
+    open_connections--;
+}
+
+void DetectionServer::io_loop() {
+    std::vector<int> idle;
+    std::vector<struct pollfd> descriptors;
+    
+    while (running) {
+        descriptors.resize(2 + idle.size());
+        descriptors[0] = { listen_fd, POLLIN, 0 };
+        descriptors[1] = { wake_fd, POLLIN, 0 };
+        for (size_t i = 0; i < idle.size(); ++i) {
+            descriptors[2 + i] = { idle[i], POLLIN, 0 };
+        }
+        
+        if (poll(descriptors.data(), descriptors.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            Logger::error("Detection server poll failed: " + std::string(strerror(errno)));
+            break;
+        }
+        if (!running) break;
+        
+        // A request (or a hangup) is waiting: hand the connection to a worker
+        size_t kept = 0;
+        for (size_t i = 0; i < idle.size(); ++i) {
+            if (descriptors[2 + i].revents != 0) {
+                ready_connections->push(int(idle[i]));
+            } else {
+                idle[kept++] = idle[i];
+            }
+        }
+        idle.resize(kept);
+        
+        if (descriptors[1].revents & POLLIN) {
+            uint64_t count;
+            ssize_t drained = read(wake_fd, &count, sizeof(count));
+            (void)drained;
+            
+            std::lock_guard<std::mutex> lock(returned_mutex);
+            idle.insert(idle.end(), returned_connections.begin(), returned_connections.end());
+            returned_connections.clear();
+        }
+        
+        if (descriptors[0].revents & POLLIN) {
+            while (true) {
+                int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd < 0) {
+                    if (errno == EINTR) continue;
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        Logger::warning("Detection server accept failed: " + std::string(strerror(errno)));
+                    }
+                    break;
+                }
+                
+                if (open_connections >= config.max_connections) {
+                    close(fd);
+                    connections_rejected++;
+                    continue;
+                }
+                
+                // Workers block on a connection only while a frame is in flight
+                struct timeval timeout;
+                timeout.tv_sec = config.io_timeout_ms / 1000;
+                timeout.tv_usec = (config.io_timeout_ms % 1000) * 1000;
+                setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+                
+                open_connections++;
+                connections_accepted++;
+                idle.push_back(fd);
+            }
+        }
+    }
+    
+    for (int fd : idle) {
+        close_connection(fd);
+    }
+}
+
+void DetectionServer::worker_loop() {
+    // Detector and buffers are per worker; detection scratch space is per thread
+    CorePointDetector detector(config.detection_params);
+    CorePointDetector::DetectionResult result;
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> response;
+    
+    int fd;
+    while (ready_connections->pop(fd)) {
+        if (running && serve_request(fd, detector, result, payload, response)) {
+            std::lock_guard<std::mutex> lock(returned_mutex);
+            returned_connections.push_back(fd);
+            wake();
+        } else {
+            close_connection(fd);
+        }
+    }
+}
+
+bool DetectionServer::serve_request(int fd, CorePointDetector& detector, CorePointDetector::DetectionResult& result,
+                                    std::vector<uint8_t>& payload, std::vector<uint8_t>& response) {
+    Protocol::RequestHeader header;
+    if (!Protocol::recv_all(fd, &header, sizeof(header))) {
+        return false;    // Client hung up (or stalled past io_timeout_ms)
+    }
+    const uint64_t request_number = ++requests;
+    bytes_received += sizeof(header);
+    
+    bool framed = header.magic == Protocol::REQUEST_MAGIC && header.version == Protocol::VERSION &&
+                  (header.format == Protocol::FORMAT_ENCODED || header.format == Protocol::FORMAT_RAW);
+    if (!framed || header.payload_size > config.max_payload_bytes) {
+        // The payload is left unread, so the connection cannot be reused
+        if (framed) {
+            encode_response(Protocol::STATUS_TOO_LARGE, nullptr, false,
+                           "Payload exceeds " + std::to_string(config.max_payload_bytes) + " bytes", response);
+        } else {
+            encode_response(Protocol::STATUS_BAD_REQUEST, nullptr, false, "Unsupported magic, version or format", response);
+        }
+        requests_failed++;
+        if (Protocol::send_all(fd, response.data(), response.size())) bytes_sent += response.size();
+        return false;
+    }
+    
+    // Buffers only grow, so steady-state requests do not allocate
+    if (payload.size() < header.payload_size) {
+        payload.resize(header.payload_size);
+    }
+    if (!Protocol::recv_all(fd, payload.data(), header.payload_size)) {
+        requests_failed++;
+        return false;
+    }
+    bytes_received += header.payload_size;
+    
+    uint8_t status = Protocol::STATUS_OK;
+    std::string message;
+    cv::Mat image;
+    if (header.format == Protocol::FORMAT_RAW) {
+        if (header.width == 0 || header.height == 0 ||
+            static_cast<uint32_t>(header.width) * header.height != header.payload_size) {
+            status = Protocol::STATUS_BAD_REQUEST;
+            message = "Raw payload size does not match width x height";
+        } else {
+            // Zero-copy view over the request buffer
+            image = cv::Mat(header.height, header.width, CV_8U, payload.data());
+        }
+    } else {
+        try {
+            image = cv::imdecode(cv::Mat(1, static_cast<int>(header.payload_size), CV_8U, payload.data()),
+                                cv::IMREAD_GRAYSCALE);
+        } catch (const std::exception&) {
+            image = cv::Mat();    // Reported as a decode failure below
+        }
+        if (image.empty()) {
+            status = Protocol::STATUS_DECODE_FAILED;
+            message = "Cannot decode image payload";
+        }
+    }
+    
+    if (status == Protocol::STATUS_OK) {
+        detector.detect_core_point(image, result);
+        detection_time_us += result.processing_time_us;
+        if (result.success) {
+            cores_found++;
+            uint8_t found_status = Protocol::STATUS_OK;
+            std::string note;
+            HammingIndex::Match match;
+            if ((header.flags & Protocol::FLAG_SCREEN_DUPLICATES) && !result.extracted_roi.hash.empty() &&
+                screened_rois.check_and_add(static_cast<int64_t>(request_number), result.extracted_roi.hash, match)) {
+                duplicates++;
+                found_status = Protocol::STATUS_DUPLICATE;
+                note = "Near-duplicate of request " + std::to_string(match.id) + 
+                       " (distance " + std::to_string(match.distance) + ")";
+            }
+            bool include_rois = (header.flags & Protocol::FLAG_INCLUDE_ROIS) != 0;
+            encode_response(found_status, &result, include_rois, note, response);
+        } else {
+            encode_response(Protocol::STATUS_NO_CORE, &result, false, result.error_message, response);
+        }
+    } else {
+        requests_failed++;
+        encode_response(status, nullptr, false, message, response);
+    }
+    
+    if (!Protocol::send_all(fd, response.data(), response.size())) {
+        return false;
+    }
+    bytes_sent += response.size();
+    return true;
+}
+
+void DetectionServer::encode_response(uint8_t status, const CorePointDetector::DetectionResult* result,
+                                      bool include_rois, const std::string& message,
+                                      std::vector<uint8_t>& response) {
+    size_t core_count = result ? std::min<size_t>(result->core_points.size(), 255) : 0;
+    size_t roi_count = include_rois ? std::min(core_count, 1 + result->secondary_rois.size()) : 0;
+    
+    Protocol::ResponseHeader header;
+    header.magic = Protocol::RESPONSE_MAGIC;
+    header.version = Protocol::VERSION;
+    header.status = status;
+    header.core_count = static_cast<uint8_t>(core_count);
+    header.roi_count = static_cast<uint8_t>(roi_count);
+    header.processing_time_us = result ? static_cast<uint32_t>(std::min<uint64_t>(result->processing_time_us, UINT32_MAX)) : 0;
+    header.payload_size = static_cast<uint32_t>(sizeof(float) + core_count * sizeof(Protocol::CoreRecord) +
+                                                roi_count * Protocol::ROI_BYTES + message.size());
+    
+    response.resize(sizeof(header) + header.payload_size);
+    uint8_t* out = response.data();
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    
+    float quality = result ? result->overall_quality : 0.0f;
+    memcpy(out, &quality, sizeof(quality));
+    out += sizeof(quality);
+    
+    for (size_t i = 0; i < core_count; ++i) {
+        const CorePointDetector::CorePoint& core = result->core_points[i];
+        Protocol::CoreRecord record;
+        record.x = core.x;
+        record.y = core.y;
+        record.confidence = core.confidence;
+        record.rotation = 0.0f;
+        if (i == 0) {
+            record.rotation = result->extracted_roi.rotation;
+        } else if (i - 1 < result->secondary_rois.size()) {
+            record.rotation = result->secondary_rois[i - 1].rotation;
+        }
+        memcpy(out, &record, sizeof(record));
+        out += sizeof(record);
+    }
+    
+    for (size_t i = 0; i < roi_count; ++i) {
+        const CorePointDetector::ROI& roi = i == 0 ? result->extracted_roi : result->secondary_rois[i - 1];
+        memcpy(out, &roi.pixels[0][0], Protocol::ROI_BYTES);
+        out += Protocol::ROI_BYTES;
+    }
+    
+    memcpy(out, message.data(), message.size());
+}
+
+DetectionServer::ServerStats DetectionServer::get_stats() const {
+    ServerStats stats;
+    stats.connections_accepted = connections_accepted;
+    stats.connections_rejected = connections_rejected;
+    stats.requests = requests;
+    stats.requests_failed = requests_failed;
+    stats.cores_found = cores_found;
+    stats.duplicates = duplicates;
+    stats.bytes_received = bytes_received;
+    stats.bytes_sent = bytes_sent;
+    stats.detection_time_us = detection_time_us;
+    return stats;
+}
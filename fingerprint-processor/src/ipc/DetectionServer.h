@@ -0,0 +1,111 @@
+// DetectionServer.h - Unix-domain-socket server for on-demand core detection 
+#pragma once
+
+#include "DetectionProtocol.h"
+#include "../core/CorePointDetector.h"
+#include "../database/HammingIndex.h"
+#include "../utils/ThreadSafeQueue.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Serves detection requests (see DetectionProtocol) from local clients
+ *
+ * One I/O thread accepts connections and polls the idle ones; a connection with
+ * a request waiting is handed to a fixed pool of workers, each owning its own
+ * CorePointDetector and buffers. A worker answers one request and returns the
+ * connection to the poller, so thousands of mostly idle clients share the pool
+ * and a slow client only ever holds one worker for one request.
+ */
+class DetectionServer {
+public:
+    struct Config {
+        std::string socket_path;
+        size_t worker_count;                // 0 = one per online CPU
+        size_t max_connections;             // Further connections are closed on accept
+        uint32_t max_payload_bytes;         // Larger requests get STATUS_TOO_LARGE
+        int io_timeout_ms;                  // A client stalling mid-frame is disconnected
+        uint32_t socket_mode;               // Permissions of the socket file
+        CorePointDetector::DetectionParams detection_params;
+        
+        Config() : worker_count(0), max_connections(1024), max_payload_bytes(64u << 20),
+                  io_timeout_ms(5000), socket_mode(0660) {}
+    };
+    
+    struct ServerStats {
+        uint64_t connections_accepted;
+        uint64_t connections_rejected;      // Over max_connections
+        uint64_t requests;
+        uint64_t requests_failed;           // Answered with a status other than OK / NO_CORE
+        uint64_t cores_found;               // Requests answered with STATUS_OK or STATUS_DUPLICATE
+        uint64_t duplicates;                // Requests answered with STATUS_DUPLICATE
+        uint64_t bytes_received;
+        uint64_t bytes_sent;
+        uint64_t detection_time_us;         // Sum over all requests
+        
+        ServerStats() : connections_accepted(0), connections_rejected(0), requests(0), requests_failed(0),
+                       cores_found(0), duplicates(0), bytes_received(0), bytes_sent(0), detection_time_us(0) {}
+    };
+
+private:
+    Config config;
+    int listen_fd;
+    int wake_fd;                            // eventfd: returned connections or stop
+    std::atomic<bool> running;
+    
+    std::thread io_thread;
+    std::vector<std::thread> workers;
+    std::unique_ptr<ThreadSafeQueue<int>> ready_connections;   // Connections with a request waiting
+    
+    std::mutex returned_mutex;
+    std::vector<int> returned_connections;  // Served by a worker, back to the poller
+    std::atomic<size_t> open_connections;
+    
+    HammingIndex screened_rois;             // Primary ROI hashes of FLAG_SCREEN_DUPLICATES requests, by request number
+    
+    std::atomic<uint64_t> connections_accepted;
+    std::atomic<uint64_t> connections_rejected;
+    std::atomic<uint64_t> requests;
+    std::atomic<uint64_t> requests_failed;
+    std::atomic<uint64_t> cores_found;
+    std::atomic<uint64_t> duplicates;
+    std::atomic<uint64_t> bytes_received;
+    std::atomic<uint64_t> bytes_sent;
+    std::atomic<uint64_t> detection_time_us;
+    
+    bool bind_socket();
+    void io_loop();
+    void worker_loop();
+    void wake();
+    void close_connection(int fd);
+    
+    // Read, answer and account one request; false if the connection must be closed
+    bool serve_request(int fd, CorePointDetector& detector, CorePointDetector::DetectionResult& result,
+                      std::vector<uint8_t>& payload, std::vector<uint8_t>& response);
+    static void encode_response(uint8_t status, const CorePointDetector::DetectionResult* result,
+                               bool include_rois, const std::string& message,
+                               std::vector<uint8_t>& response);
+
+public:
+    DetectionServer();
+    ~DetectionServer() { stop(); }
+    
+    DetectionServer(const DetectionServer&) = delete;
+    DetectionServer& operator=(const DetectionServer&) = delete;
+    
+    // Bind the socket (replacing a stale one) and start the I/O thread and workers
+    bool start(const Config& server_config);
+    
+    // Stop accepting, let workers finish the request in hand, close every connection
+    // and remove the socket file
+    void stop();
+    bool is_running() const { return running; }
+    
+    ServerStats get_stats() const;
+    const Config& get_config() const { return config; }
+};
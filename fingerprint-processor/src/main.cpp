@@ -1,241 +1,715 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <filesystem>
-#include <chrono>
-
-// Linux-specific includes
-#include <unistd.h>
-#include <sys/resource.h>
-
-// Project includes
-#include "utils/Logger.h"
-#include "utils/Timer.h"
-#include "core/FileManager.h"
-#include "core/CorePointDetector.h"
-
-namespace fs = std::filesystem;
-
-// Test configuration
-struct TestConfig {
-    std::string input_directory = "test_data";
-    std::string output_directory = "output";
-    bool verbose = false;
-    int max_files = -1; // -1 means process all files
-};
-
-// Print system information for debugging
-void printSystemInfo() {
-    Logger::info("=== System Information ===");
-    
-    // Get CPU info
-    Logger::info("CPU Cores: " + std::to_string(sysconf(_SC_NPROCESSORS_ONLN)));
-    
-    // Get memory info
-    struct rusage usage;
-    if (getrusage(RUSAGE_SELF, &usage) == 0) {
-        Logger::info("Peak Memory: " + std::to_string(usage.ru_maxrss / 1024) + " MB");
-    }
-    
-    // Check for AVX2 support
-    #ifdef __AVX2__
-    Logger::info("AVX2 Support: Enabled");
-    #else
-    Logger::info("AVX2 Support: Disabled (using scalar fallback)");
-    #endif
-    
-    Logger::info("Build Type: " 
-    #ifdef NDEBUG
-        "Release"
-    #else
-        "Debug"
-    #endif
-    );
-}
-
-// Process a single fingerprint image
-bool processSingleImage(const std::string& filepath, 
-                       FileManager& fileManager,
-                       CorePointDetector& detector) {
-    Timer timer;
-    timer.start();
-    
-    Logger::info("Processing: " + fs::path(filepath).filename().string());
-    
-    // Step 1: Load image
-    timer.start();
-    cv::Mat image = fileManager.loadImage(filepath);
-    if (image.empty()) {
-        Logger::error("Failed to load image: " + filepath);
-        return false;
-    }
-    auto loadTime = timer.getElapsedMicroseconds();
-    
-    Logger::info("  Loaded: " + std::to_string(image.cols) + "x" + 
-                std::to_string(image.rows) + " in " + 
-                std::to_string(loadTime) + "μs");
-    
-    // Step 2: Detect core points
-    timer.start();
-    std::vector<CorePoint> corePoints = detector.detectCorePoints(image);
-    auto detectionTime = timer.getElapsedMicroseconds();
-    
-    Logger::info("  Core points found: " + std::to_string(corePoints.size()) + 
-                " in " + std::to_string(detectionTime) + "μs");
-    
-    // Step 3: Extract ROIs (regions of interest)
-    timer.start();
-    std::vector<ROI> rois;
-    for (size_t i = 0; i < corePoints.size(); ++i) {
-        ROI roi = detector.extractROI(image, corePoints[i], 
-                                    fs::path(filepath).filename().string(), 
-                                    static_cast<int32_t>(i));
-        rois.push_back(roi);
-    }
-    auto roiTime = timer.getElapsedMicroseconds();
-    
-    Logger::info("  ROIs extracted: " + std::to_string(rois.size()) + 
-                " in " + std::to_string(roiTime) + "μs");
-    
-    auto totalTime = loadTime + detectionTime + roiTime;
-    Logger::info("  Total time: " + std::to_string(totalTime) + "μs");
-    
-    return true;
-}
-
-// Batch process multiple images
-void batchProcessImages(const TestConfig& config) {
-    Logger::info("=== Starting Batch Processing ===");
-    
-    // Initialize components
-    FileManager fileManager;
-    CorePointDetector detector;
-    
-    // Find all image files in input directory
-    std::vector<std::string> imageFiles;
-    
-    if (!fs::exists(config.input_directory)) {
-        Logger::error("Input directory does not exist: " + config.input_directory);
-        return;
-    }
-    
-    for (const auto& entry : fs::directory_iterator(config.input_directory)) {
-        if (entry.is_regular_file()) {
-            std::string ext = entry.path().extension().string();
-            // Convert to lowercase for comparison
-            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-            
-            if (ext == ".bmp" || ext == ".jpg" || ext == ".jpeg" || 
-                ext == ".png" || ext == ".tiff" || ext == ".tif") {
-                imageFiles.push_back(entry.path().string());
-            }
-        }
-    }
-    
-    if (imageFiles.empty()) {
-        Logger::error("No image files found in: " + config.input_directory);
-        return;
-    }
-    
-    // Limit number of files if specified
-    if (config.max_files > 0 && imageFiles.size() > static_cast<size_t>(config.max_files)) {
-        imageFiles.resize(config.max_files);
-    }
-    
-    Logger::info("Found " + std::to_string(imageFiles.size()) + " image files");
-    
-    // Process each image
-    Timer batchTimer;
-    batchTimer.start();
-    
-    int successCount = 0;
-    int failCount = 0;
-    
-    for (const auto& filepath : imageFiles) {
-        if (processSingleImage(filepath, fileManager, detector)) {
-            successCount++;
-        } else {
-            failCount++;
-        }
-    }
-    
-    auto totalBatchTime = batchTimer.getElapsedMicroseconds();
-    
-    // Print summary
-    Logger::info("=== Batch Processing Complete ===");
-    Logger::info("Successful: " + std::to_string(successCount));
-    Logger::info("Failed: " + std::to_string(failCount));
-    Logger::info("Total time: " + std::to_string(totalBatchTime / 1000) + "ms");
-    
-    if (successCount > 0) {
-        auto avgTime = totalBatchTime / successCount;
-        Logger::info("Average per image: " + std::to_string(avgTime) + "μs");
-        
-        double imagesPerSecond = 1000000.0 / avgTime;
-        Logger::info("Processing rate: " + std::to_string(imagesPerSecond) + " images/second");
-    }
-}
-
-// Print usage information
-void printUsage(const char* programName) {
-    std::cout << "Usage: " << programName << " [options]\n";
-    std::cout << "Options:\n";
-    std::cout << "  -i <dir>     Input directory (default: test_data)\n";
-    std::cout << "  -o <dir>     Output directory (default: output)\n";
-    std::cout << "  -n <count>   Max files to process (default: all)\n";
-    std::cout << "  -v           Verbose output\n";
-    std::cout << "  -h           Show this help\n";
-    std::cout << "\nExample:\n";
-    std::cout << "  " << programName << " -i test_data -n 10 -v\n";
-}
-
-int main(int argc, char* argv[]) {
-    TestConfig config;
-    
-    // Parse command line arguments
-    int opt;
-    while ((opt = getopt(argc, argv, "i:o:n:vh")) != -1) {
-        switch (opt) {
-            case 'i':
-                config.input_directory = optarg;
-                break;
-            case 'o':
-                config.output_directory = optarg;
-                break;
-            case 'n':
-                config.max_files = std::atoi(optarg);
-                break;
-            case 'v':
-                config.verbose = true;
-                break;
-            case 'h':
-                printUsage(argv[0]);
-                return 0;
-            default:
-                printUsage(argv[0]);
-                return 1;
-        }
-    }
-    
-    // Initialize logging
-    if (config.verbose) {
-        Logger::setLevel(Logger::Level::DEBUG);
-    }
-    
-    Logger::info("Fingerprint Processor Starting...");
-    
-    // Print system information
-    printSystemInfo();
-    
-    // Create output directory if it doesn't exist
-    if (!fs::exists(config.output_directory)) {
-        fs::create_directories(config.output_directory);
-        Logger::info("Created output directory: " + config.output_directory);
-    }
-    
-    // Run batch processing
-    batchProcessImages(config);
-    
-    Logger::info("Program completed successfully");
-    return 0;
-}
+#include <iostream>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <csignal>
+#include <thread>
+
+// Linux-specific includes
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/resource.h>
+
+// Project includes
+#include "utils/Logger.h"
+#include "utils/Timer.h"
+#include "core/FileManager.h"
+#include "core/CorePointDetector.h"
+#include "core/SpoolWatcher.h"
+#include "database/AsyncDatabaseWriter.h"
+#include "database/HammingIndex.h"
+#include "database/RoiArchive.h"
+#include "ipc/DetectionServer.h"
+
+namespace fs = std::filesystem;
+
+// Test configuration
+struct TestConfig {
+    std::string input_directory = "test_data";
+    std::string output_directory = "output";
+    std::string database_name = "fingerprints.db";
+    bool verbose = false;
+    bool resume = false;       // Skip inputs committed by an earlier run over the same directory
+    bool bulk_load = false;    // Batch mode: defer indexes and journaling until the run completes
+    int max_files = -1; // -1 means process all files
+    size_t batch_size = 1000;  // Rows per database transaction (one checkpoint per transaction)
+    std::string spool_directory;    // Daemon mode: watch this directory instead of a one-shot batch
+    std::string socket_path;        // Server mode: answer detection requests on this Unix socket
+    size_t server_workers = 0;      // Server mode worker threads (0 = one per CPU)
+    std::string archive_path;       // Batch and daemon modes: also append ROIs to this archive
+};
+
+// Set by SIGINT/SIGTERM; the batch and daemon loops stop and commit what they have, the server shuts down
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void handleStopSignal(int) {
+    stopRequested = 1;
+}
+
+// Print system information for debugging
+void printSystemInfo() {
+    Logger::info("=== System Information ===");
+    
+    // Get CPU info
+    Logger::info("CPU Cores: " + std::to_string(sysconf(_SC_NPROCESSORS_ONLN)));
+    
+    // Get memory info
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        Logger::info("Peak Memory: " + std::to_string(usage.ru_maxrss / 1024) + " MB");
+    }
+    
+    // Check for AVX2 support
+    #ifdef __AVX2__
+    Logger::info("AVX2 Support: Enabled");
+    #else
+    Logger::info("AVX2 Support: Disabled (using scalar fallback)");
+    #endif
+    
+    Logger::info("Build Type: " 
+    #ifdef NDEBUG
+        "Release"
+    #else
+        "Debug"
+    #endif
+    );
+}
+
+// Load and run detection on a single fingerprint image; with a writer, images whose
+// bytes it already holds are not detected again (exactDuplicate is set instead)
+CorePointDetector::DetectionResult processSingleImage(const std::string& filepath, 
+                                                      int fileIndex,
+                                                      CorePointDetector& detector,
+                                                      AsyncDatabaseWriter* storedContent = nullptr,
+                                                      bool* exactDuplicate = nullptr) {
+    Timer timer;
+    std::string filename = fs::path(filepath).filename().string();
+    
+    if (Logger::enabled(Logger::Level::DEBUG)) {
+        Logger::debug("Processing: " + filename);
+    }
+    
+    // Step 1: Read and hash the file in one pass (no cache: every input is read exactly once);
+    // stored content is skipped before it is decoded
+    CorePointDetector::DetectionResult result;
+    if (exactDuplicate) *exactDuplicate = false;
+    
+    timer.start();
+    std::vector<uint8_t> bytes;
+    uint64_t contentHash = 0;
+    if (!FileManager::read_file(filepath, bytes, contentHash)) {
+        Logger::error("Failed to load image: " + filepath);
+    } else if (storedContent && storedContent->contains_content(contentHash)) {
+        if (exactDuplicate) *exactDuplicate = true;
+        return result;
+    }
+    cv::Mat image = bytes.empty() ? cv::Mat() : FileManager::decode_image(bytes, filepath);
+    auto loadTime = timer.stop();
+    
+    // Step 2: Detect core points and extract ROIs
+    if (image.empty()) {
+        result.error_message = "Failed to load image";
+    } else {
+        timer.start();
+        detector.detect_core_point(image, result, filename, fileIndex);
+        result.content_hash = contentHash;
+        auto detectionTime = timer.stop();
+        
+        if (Logger::enabled(Logger::Level::DEBUG)) {
+            Logger::debug("  " + std::to_string(image.cols) + "x" + std::to_string(image.rows) + 
+                         ", loaded in " + Timer::format_time(loadTime) + ", " + 
+                         std::to_string(result.core_points.size()) + " cores in " + 
+                         Timer::format_time(detectionTime));
+        }
+    }
+    
+    if (!result.success) {
+        Logger::warning("No core point for " + filename + 
+                       (result.error_message.empty() ? "" : ": " + result.error_message));
+    }
+    
+    return result;
+}
+
+// Near-duplicate screening of primary ROI hashes against the rows already stored
+// and the inputs accepted earlier by this process. An input is accepted (added to
+// the index) only once its rows are committed, or will never be retried by this
+// process; until then the spool daemon holds it, so a burst still screens within itself
+class DuplicateScreen {
+public:
+    bool load(const std::string& databasePath) {
+        return index.load_from_database(databasePath);
+    }
+    
+    // True (with a description of the earlier ROI) if the result is a near-duplicate
+    // of a stored, accepted or held ROI
+    bool check(const CorePointDetector::DetectionResult& result, std::string& original) {
+        if (!result.success || result.extracted_roi.hash.empty()) {
+            return false;
+        }
+        
+        // Stored rows keep their row ids; this process's inputs get ids -1, -2, ...
+        HammingIndex::Match match;
+        if (index.find_nearest(result.extracted_roi.hash, RoiHasher::DUPLICATE_DISTANCE, match)) {
+            original = match.id > 0 ? "stored row " + std::to_string(match.id) 
+                                    : acceptedNames[static_cast<size_t>(-match.id - 1)];
+            original += " (distance " + std::to_string(match.distance) + ")";
+            return true;
+        }
+        for (const auto& held : heldRois) {
+            int distance = RoiHasher::distance(held.second, result.extracted_roi.hash);
+            if (distance <= RoiHasher::DUPLICATE_DISTANCE) {
+                original = held.first + " (distance " + std::to_string(distance) + ")";
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // Screen later inputs against this result
+    void accept(const CorePointDetector::DetectionResult& result) {
+        if (!result.success || result.extracted_roi.hash.empty()) return;
+        acceptedNames.push_back(result.extracted_roi.filename);
+        index.add(-static_cast<int64_t>(acceptedNames.size()), result.extracted_roi.hash);
+    }
+    
+    // Screen later inputs against this result until release_held(); accept() it once committed
+    void hold(const CorePointDetector::DetectionResult& result) {
+        if (!result.success || result.extracted_roi.hash.empty()) return;
+        heldRois.emplace_back(result.extracted_roi.filename, result.extracted_roi.hash);
+    }
+    
+    void release_held() {
+        heldRois.clear();
+    }
+
+private:
+    HammingIndex index;
+    std::vector<std::string> acceptedNames;
+    std::vector<std::pair<std::string, HammingIndex::Hash>> heldRois;
+};
+
+// Detector settings for stored results: the block orientation field gives the pattern
+// class that heads each row's biological address
+static CorePointDetector::DetectionParams storageDetectionParams() {
+    CorePointDetector::DetectionParams params;
+    params.export_orientation_blocks = true;
+    return params;
+}
+
+// Start the database writer thread; each group commit holds up to batch_size rows and the latest checkpoint
+static bool openWriter(const TestConfig& config, AsyncDatabaseWriter& writer) {
+    AsyncDatabaseWriter::Config writerConfig;
+    writerConfig.database.database_path = (fs::path(config.output_directory) / config.database_name).string();
+    writerConfig.commit_rows = config.batch_size;
+    writerConfig.database.bulk_load = config.bulk_load;
+    if (!writer.start(writerConfig)) {
+        Logger::error("Cannot open database " + writerConfig.database.database_path);
+        return false;
+    }
+    return true;
+}
+
+// Open the ROI archive when one was requested
+static bool openArchive(const TestConfig& config, RoiArchiveWriter& archive) {
+    if (config.archive_path.empty()) {
+        return true;
+    }
+    if (!archive.open(config.archive_path)) {
+        Logger::error("Cannot open ROI archive " + config.archive_path);
+        return false;
+    }
+    return true;
+}
+
+// Batch process multiple images
+void batchProcessImages(const TestConfig& config) {
+    Logger::info("=== Starting Batch Processing ===");
+    
+    if (!fs::exists(config.input_directory)) {
+        Logger::error("Input directory does not exist: " + config.input_directory);
+        return;
+    }
+    
+    // Inputs are processed in path order, so progress is a single high-water mark
+    std::vector<FileManager::FileInfo> imageFiles = FileManager::scan_directory(config.input_directory, false);
+    std::sort(imageFiles.begin(), imageFiles.end(), 
+              [](const FileManager::FileInfo& a, const FileManager::FileInfo& b) { return a.filepath < b.filepath; });
+    
+    if (imageFiles.empty()) {
+        Logger::error("No image files found in: " + config.input_directory);
+        return;
+    }
+    
+    // Limit number of files if specified
+    if (config.max_files > 0 && imageFiles.size() > static_cast<size_t>(config.max_files)) {
+        imageFiles.resize(config.max_files);
+    }
+    
+    Logger::info("Found " + std::to_string(imageFiles.size()) + " image files");
+    
+    // Initialize components; detection never waits for SQLite (one writer thread)
+    CorePointDetector detector(storageDetectionParams());
+    AsyncDatabaseWriter writer;
+    if (!openWriter(config, writer)) {
+        return;
+    }
+    
+    DuplicateScreen duplicates;
+    if (!duplicates.load(writer.get_config().database.database_path)) {
+        Logger::error("Cannot load ROI hashes from " + writer.get_config().database.database_path);
+        return;
+    }
+    
+    // Archived ROIs are not part of the resume mark: inputs re-processed after a
+    // crash are archived again, and the reader maps a file to its latest records
+    RoiArchiveWriter archive;
+    if (!openArchive(config, archive)) {
+        return;
+    }
+    
+    DatabaseWriter::RunProgress progress;
+    progress.run_key = fs::absolute(config.input_directory).lexically_normal().string();
+    
+    // Resume after the last input committed by the previous run; the scan read no
+    // file contents, so committed inputs are never opened again
+    size_t firstFile = 0;
+    if (config.resume) {
+        DatabaseWriter::RunProgress committed;
+        if (writer.load_progress(progress.run_key, committed)) {
+            auto next = std::upper_bound(imageFiles.begin(), imageFiles.end(), committed.last_input,
+                                         [](const std::string& key, const FileManager::FileInfo& file) {
+                                             return key < file.filepath;
+                                         });
+            firstFile = static_cast<size_t>(next - imageFiles.begin());
+            progress = committed;
+            
+            if (static_cast<int64_t>(firstFile) != committed.inputs_committed) {
+                Logger::warning("Input directory changed since the checkpoint (" + 
+                               std::to_string(committed.inputs_committed) + " inputs committed, " +
+                               std::to_string(firstFile) + " now sort before " + committed.last_input + ")");
+            }
+            Logger::info("Resuming after " + committed.last_input + ": skipping " + 
+                        std::to_string(firstFile) + " committed inputs");
+        } else {
+            Logger::info("No checkpoint for " + progress.run_key + ", starting from the beginning");
+        }
+    }
+    
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    
+    // Process each image
+    Timer batchTimer;
+    batchTimer.start();
+    
+    int successCount = 0;
+    int failCount = 0;
+    int duplicateCount = 0;
+    int exactDuplicateCount = 0;
+    
+    for (size_t i = firstFile; i < imageFiles.size() && !stopRequested; ++i) {
+        const FileManager::FileInfo& file = imageFiles[i];
+        progress.last_input = file.filepath;
+        progress.inputs_committed = static_cast<int64_t>(i + 1);
+        
+        // Duplicates are not stored; like failed inputs they still advance the mark,
+        // so they are not retried on resume. Byte-identical copies of stored or queued
+        // content are skipped before they are decoded
+        bool exactDuplicate = false;
+        CorePointDetector::DetectionResult result = 
+            processSingleImage(file.filepath, static_cast<int>(i), detector, &writer, &exactDuplicate);
+        if (exactDuplicate) {
+            Logger::info("Skipping " + file.filepath + ": identical to an earlier or stored input");
+            exactDuplicateCount++;
+        } else {
+            // Accepted at submit: if its transaction fails, the input is re-processed
+            // only by a later --resume run, which screens against the database afresh
+            std::string original;
+            if (duplicates.check(result, original)) {
+                Logger::info("Skipping " + file.filepath + ": near-duplicate of " + original);
+                duplicateCount++;
+                result.clear();
+            } else if (result.success) {
+                duplicates.accept(result);
+                successCount++;
+            } else {
+                failCount++;
+            }
+        }
+        
+        if (!writer.submit(result, progress)) {
+            Logger::error("Failed to write results for " + file.filepath);
+        }
+        if (archive.is_open() && !archive.append(result)) {
+            Logger::error("Failed to archive ROIs of " + file.filepath);
+        }
+    }
+    
+    // Commits the rows still pending together with the final mark
+    bool committed = writer.flush();
+    if (!committed) {
+        Logger::error("Some transactions failed; --resume continues after the last committed input");
+    }
+    
+    // A bulk load ends only with a complete run; otherwise the next --bulk-load run resumes it
+    if (config.bulk_load) {
+        if (!committed || stopRequested) {
+            Logger::warning("Bulk load left unfinished; rerun with --bulk-load --resume to complete it");
+        } else if (!writer.finish_bulk_load()) {
+            Logger::error("Failed to finish the bulk load; rerun with --bulk-load --resume");
+        }
+    }
+    writer.stop();
+    archive.close();
+    
+    auto totalBatchTime = batchTimer.stop();
+    
+    // Print summary
+    Logger::info("=== Batch Processing Complete ===");
+    if (stopRequested) {
+        Logger::info("Stopped by signal; rerun with --resume to continue after " + progress.last_input);
+    }
+    Logger::info("Successful: " + std::to_string(successCount));
+    Logger::info("Failed: " + std::to_string(failCount));
+    Logger::info("Duplicates skipped: " + std::to_string(duplicateCount) + " near, " + 
+                std::to_string(exactDuplicateCount) + " identical files");
+    Logger::info("Total time: " + Timer::format_time(totalBatchTime));
+    
+    int processed = successCount + failCount + duplicateCount + exactDuplicateCount;
+    if (processed > 0) {
+        auto avgTime = totalBatchTime / processed;
+        Logger::info("Average per image: " + Timer::format_time(avgTime));
+        
+        double imagesPerSecond = 1000000.0 / avgTime;
+        Logger::info("Processing rate: " + std::to_string(imagesPerSecond) + " images/second");
+    }
+}
+
+// A spooled file between detection and leaving the spool
+struct SpooledFile {
+    std::string filepath;
+    fs::path destination;                       // processed/, failed/ or duplicates/
+    CorePointDetector::DetectionResult result;  // Stored rows (none for failures and duplicates)
+    bool archived = false;                      // ROIs appended to the archive, or nothing to append
+};
+
+// Move a spooled file into a subdirectory of the spool once its rows are committed
+static void retireSpoolFile(const std::string& filepath, const fs::path& destination) {
+    std::error_code error;
+    fs::rename(filepath, destination / fs::path(filepath).filename(), error);
+    if (error) {
+        Logger::error("Cannot move " + filepath + " to " + destination.string() + ": " + error.message());
+    }
+}
+
+// Daemon mode: keep the detector and database open and process files as they arrive
+void runSpoolDaemon(const TestConfig& config) {
+    Logger::info("=== Starting Spool Daemon ===");
+    
+    // Processed files leave the spool root, so anything left there after a restart is new
+    fs::path processedDirectory = fs::path(config.spool_directory) / "processed";
+    fs::path failedDirectory = fs::path(config.spool_directory) / "failed";
+    fs::path duplicateDirectory = fs::path(config.spool_directory) / "duplicates";
+    FileManager::create_directory(processedDirectory.string());
+    FileManager::create_directory(failedDirectory.string());
+    FileManager::create_directory(duplicateDirectory.string());
+    
+    CorePointDetector detector(storageDetectionParams());
+    AsyncDatabaseWriter writer;
+    if (!openWriter(config, writer)) {
+        return;
+    }
+    
+    DuplicateScreen duplicates;
+    if (!duplicates.load(writer.get_config().database.database_path)) {
+        Logger::error("Cannot load ROI hashes from " + writer.get_config().database.database_path);
+        return;
+    }
+    
+    RoiArchiveWriter archive;
+    if (!openArchive(config, archive)) {
+        return;
+    }
+    
+    std::vector<std::string> ready;
+    SpoolWatcher watcher;
+    if (!watcher.start(config.spool_directory, &ready)) {
+        return;
+    }
+    if (!ready.empty()) {
+        Logger::info("Processing " + std::to_string(ready.size()) + " files already in the spool");
+    }
+    
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    
+    int fileIndex = 0;
+    size_t processedCount = 0;
+    size_t failedCount = 0;
+    size_t duplicateCount = 0;
+    
+    // Committed files whose ROIs could not be archived yet; they stay in the spool until they are
+    std::vector<SpooledFile> unarchived;
+    
+    while (!stopRequested) {
+        if (ready.empty() && !watcher.wait(ready, 1000)) {
+            break;
+        }
+        if (ready.empty()) continue;
+        
+        Timer burstTimer;
+        burstTimer.start();
+        
+        std::vector<SpooledFile> burst;
+        for (const auto& filepath : ready) {
+            if (stopRequested) break;
+            
+            SpooledFile file;
+            file.filepath = filepath;
+            bool identical = false;
+            file.result = processSingleImage(filepath, fileIndex++, detector, &writer, &identical);
+            std::string original;
+            if (identical) {
+                Logger::info("Not storing " + filepath + ": identical to a stored input");
+                file.destination = duplicateDirectory;
+                file.result.clear();
+            } else if (duplicates.check(file.result, original)) {
+                Logger::info("Not storing " + filepath + ": near-duplicate of " + original);
+                file.destination = duplicateDirectory;
+                file.result.clear();
+            } else {
+                file.destination = file.result.success ? processedDirectory : failedDirectory;
+                duplicates.hold(file.result);
+                if (!writer.submit(file.result)) {
+                    Logger::error("Failed to write results for " + filepath);
+                }
+            }
+            file.archived = !archive.is_open() || !file.result.success;
+            burst.push_back(std::move(file));
+        }
+        ready.clear();
+        
+        // One commit per burst of arrivals: rows reach the database as soon as the burst
+        // is processed. Files whose rows were dropped go back into ready for the next
+        // burst; failures and duplicates have no rows to lose. Only committed ROIs screen
+        // later bursts, so a retried file cannot match itself
+        bool durable = writer.flush();
+        std::vector<SpooledFile> committed = std::move(unarchived);
+        unarchived.clear();
+        duplicates.release_held();
+        for (auto& file : burst) {
+            if (!durable && file.result.success && !writer.contains_content(file.result.content_hash)) {
+                ready.push_back(file.filepath);
+            } else {
+                duplicates.accept(file.result);
+                committed.push_back(std::move(file));
+            }
+        }
+        if (!durable) {
+            Logger::error("Commit failed; retrying " + std::to_string(ready.size()) + " files with the next burst");
+        }
+        
+        // ROIs are archived only once their rows are committed, so a retried file is
+        // archived once; files leave the spool only after the archive is synced
+        bool archived = true;
+        if (archive.is_open()) {
+            for (auto& file : committed) {
+                if (!file.archived) file.archived = archive.append(file.result);
+                archived = archived && file.archived;
+            }
+            archived = archive.flush() && archived;
+        }
+        if (!archived) {
+            Logger::error("Archiving failed; keeping " + std::to_string(committed.size()) + 
+                         " committed files in the spool until their ROIs are archived");
+            unarchived = std::move(committed);
+            committed.clear();
+        }
+        
+        for (const auto& file : committed) {
+            retireSpoolFile(file.filepath, file.destination);
+            if (file.destination == processedDirectory) {
+                processedCount++;
+            } else if (file.destination == failedDirectory) {
+                failedCount++;
+            } else {
+                duplicateCount++;
+            }
+        }
+        
+        if (!committed.empty()) {
+            Logger::info("Committed " + std::to_string(committed.size()) + 
+                        " spooled files in " + Timer::format_time(burstTimer.stop()) + " (" + 
+                        std::to_string(processedCount) + " processed, " + std::to_string(failedCount) + " failed, " +
+                        std::to_string(duplicateCount) + " duplicates since start)");
+        }
+        
+        // Back off before retrying, instead of spinning on a database or disk that keeps failing
+        if (!durable || !archived) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+    
+    watcher.stop();
+    writer.stop();
+    archive.close();
+    Logger::info("=== Spool Daemon Stopped ===");
+}
+
+// Server mode: detect on images sent by local clients over a Unix socket (nothing is stored)
+void runDetectionServer(const TestConfig& config) {
+    Logger::info("=== Starting Detection Server ===");
+    
+    DetectionServer server;
+    DetectionServer::Config serverConfig;
+    serverConfig.socket_path = config.socket_path;
+    serverConfig.worker_count = config.server_workers;
+    if (!server.start(serverConfig)) {
+        return;
+    }
+    
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    
+    while (!stopRequested && server.is_running()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    
+    server.stop();
+    
+    DetectionServer::ServerStats stats = server.get_stats();
+    Logger::info("Connections: " + std::to_string(stats.connections_accepted) + 
+                " (" + std::to_string(stats.connections_rejected) + " rejected)");
+    Logger::info("Requests: " + std::to_string(stats.requests) + ", " + 
+                std::to_string(stats.cores_found) + " with a core (" + 
+                std::to_string(stats.duplicates) + " flagged as duplicates), " + 
+                std::to_string(stats.requests_failed) + " failed");
+    if (stats.requests > 0) {
+        Logger::info("Average detection time: " + 
+                    Timer::format_time(static_cast<double>(stats.detection_time_us) / stats.requests));
+    }
+    Logger::info("=== Detection Server Stopped ===");
+}
+
+// Print usage information
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n";
+    std::cout << "Options:\n";
+    std::cout << "  -i <dir>     Input directory (default: test_data)\n";
+    std::cout << "  -o <dir>     Output directory (default: output)\n";
+    std::cout << "  -n <count>   Max files to process (default: all)\n";
+    std::cout << "  -b <rows>    Rows per database transaction/checkpoint (default: 1000)\n";
+    std::cout << "  --resume     Skip inputs committed by an earlier run over the same directory\n";
+    std::cout << "  --bulk-load  Initial ingestion: defer indexes, no journal; indexes are built when the run completes\n";
+    std::cout << "  -w <dir>     Daemon mode: watch a spool directory and process files as they arrive\n";
+    std::cout << "  -s <path>    Server mode: answer detection requests on a Unix socket\n";
+    std::cout << "  -j <count>   Server worker threads (default: one per CPU)\n";
+    std::cout << "  -a <path>    Batch and daemon modes: also append every ROI to a ROI archive\n";
+    std::cout << "  -v           Verbose output\n";
+    std::cout << "  -h           Show this help\n";
+    std::cout << "\nExample:\n";
+    std::cout << "  " << programName << " -i test_data -n 10 -v\n";
+    std::cout << "  " << programName << " -i /data/backfill --resume\n";
+    std::cout << "  " << programName << " -i /data/backfill --bulk-load --resume\n";
+    std::cout << "  " << programName << " -w /var/spool/fingerprints -o /data/output\n";
+    std::cout << "  " << programName << " -i /data/backfill -a /data/output/rois.frar\n";
+    std::cout << "  " << programName << " -s /tmp/fingerprint.sock -j 8\n";
+}
+
+int main(int argc, char* argv[]) {
+    TestConfig config;
+    
+    // Parse command line arguments
+    static const struct option longOptions[] = {
+        { "resume",  no_argument,       nullptr, 'r' },
+        { "bulk-load", no_argument,     nullptr, 'B' },
+        { "watch",   required_argument, nullptr, 'w' },
+        { "serve",   required_argument, nullptr, 's' },
+        { "workers", required_argument, nullptr, 'j' },
+        { "archive", required_argument, nullptr, 'a' },
+        { "help",    no_argument,       nullptr, 'h' },
+        { nullptr,   0,                 nullptr, 0 }
+    };
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "i:o:n:b:w:s:j:a:vh", longOptions, nullptr)) != -1) {
+        switch (opt) {
+            case 'i':
+                config.input_directory = optarg;
+                break;
+            case 'o':
+                config.output_directory = optarg;
+                break;
+            case 'n':
+                config.max_files = std::atoi(optarg);
+                break;
+            case 'b':
+                config.batch_size = static_cast<size_t>(std::max(1, std::atoi(optarg)));
+                break;
+            case 'r':
+                config.resume = true;
+                break;
+            case 'B':
+                config.bulk_load = true;
+                break;
+            case 'w':
+                config.spool_directory = optarg;
+                break;
+            case 's':
+                config.socket_path = optarg;
+                break;
+            case 'j':
+                config.server_workers = static_cast<size_t>(std::max(0, std::atoi(optarg)));
+                break;
+            case 'a':
+                config.archive_path = optarg;
+                break;
+            case 'v':
+                config.verbose = true;
+                break;
+            case 'h':
+                printUsage(argv[0]);
+                return 0;
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+    
+    // Initialize logging
+    if (config.verbose) {
+        Logger::set_level(Logger::Level::DEBUG);
+    }
+    
+    Logger::info("Fingerprint Processor Starting...");
+    
+    // Print system information
+    printSystemInfo();
+    
+    // Create output directory if it doesn't exist
+    if (!fs::exists(config.output_directory)) {
+        fs::create_directories(config.output_directory);
+        Logger::info("Created output directory: " + config.output_directory);
+    }
+    
+    // A daemon never completes a run, so it could never rebuild the deferred indexes
+    if (config.bulk_load && (!config.socket_path.empty() || !config.spool_directory.empty())) {
+        Logger::warning("--bulk-load applies to batch runs only; ignored");
+        config.bulk_load = false;
+    }
+    
+    // Run as a detection server, a spool daemon or a one-shot batch
+    if (!config.socket_path.empty()) {
+        runDetectionServer(config);
+    } else if (!config.spool_directory.empty()) {
+        runSpoolDaemon(config);
+    } else {
+        batchProcessImages(config);
+    }
+    
+    Logger::info("Program completed successfully");
+    return 0;
+}
@@ -0,0 +1,227 @@
+// detection_client.cpp - Local test client for the detection server (fingerprint_processor -s) 
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <getopt.h>
+
+#include "ipc/DetectionClient.h"
+
+struct ClientConfig {
+    std::string socketPath;
+    std::vector<std::string> files;
+    int connections = 1;        // Concurrent client connections, one thread each
+    int repeat = 1;             // Times every file is sent
+    int rawWidth = 0;           // Inputs are raw 8-bit pixels of this size (0 = encoded image files)
+    int rawHeight = 0;
+    bool includeRois = false;
+    bool screenDuplicates = false;  // Ask the server to flag near-duplicate ROIs
+    bool quiet = false;         // Summary only
+};
+
+struct ClientTotals {
+    size_t requests = 0;
+    size_t found = 0;
+    size_t duplicates = 0;
+    size_t errors = 0;          // Transport failures and non-detection statuses
+    std::vector<double> latenciesUs;
+};
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& bytes) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// One connection: send this thread's share of the requests and record round-trip latencies
+static void runConnection(const ClientConfig& config, const std::vector<std::vector<uint8_t>>& images,
+                          int connectionIndex, ClientTotals& totals, std::mutex& outputMutex) {
+    DetectionClient client;
+    DetectionClient::Response response;
+    size_t total = images.size() * static_cast<size_t>(config.repeat);
+    
+    for (size_t i = static_cast<size_t>(connectionIndex); i < total; i += static_cast<size_t>(config.connections)) {
+        size_t fileIndex = i % images.size();
+        if (!client.is_connected() && !client.connect(config.socketPath)) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cerr << "Cannot connect to " << config.socketPath << "\n";
+            totals.errors += 1;
+            return;
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        bool delivered = config.rawWidth > 0
+            ? client.detect_raw(images[fileIndex].data(), config.rawWidth, config.rawHeight, response,
+                                config.includeRois, config.screenDuplicates)
+            : client.detect_encoded(images[fileIndex].data(), images[fileIndex].size(), response,
+                                    config.includeRois, config.screenDuplicates);
+        double latencyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        
+        totals.requests++;
+        totals.latenciesUs.push_back(latencyUs);
+        if (delivered && response.found()) {
+            totals.found++;
+            if (response.duplicate()) totals.duplicates++;
+        } else if (!delivered || response.status != DetectionProtocol::STATUS_NO_CORE) {
+            totals.errors++;
+        }
+        
+        if (config.quiet) continue;
+        
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << config.files[fileIndex] << ": ";
+        if (!delivered) {
+            std::cout << "connection failed\n";
+            continue;
+        }
+        std::cout << DetectionProtocol::status_name(response.status)
+                  << " quality=" << response.overall_quality
+                  << " server_us=" << response.processing_time_us
+                  << " rtt_us=" << static_cast<uint64_t>(latencyUs);
+        for (const auto& core : response.cores) {
+            std::cout << " core=(" << core.x << "," << core.y << " conf=" << core.confidence << ")";
+        }
+        if (!response.rois.empty()) {
+            std::cout << " roi_bytes=" << response.rois.size();
+        }
+        if (!response.error_message.empty()) {
+            std::cout << (response.duplicate() ? " note=\"" : " error=\"") << response.error_message << "\"";
+        }
+        std::cout << "\n";
+    }
+}
+
+static void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " -s <socket> [options] <image>...\n";
+    std::cout << "Options:\n";
+    std::cout << "  -s <path>      Socket of a running 'fingerprint_processor -s <path>'\n";
+    std::cout << "  -c <count>     Concurrent connections (default: 1)\n";
+    std::cout << "  -n <count>     Send every image this many times (default: 1)\n";
+    std::cout << "  --raw <WxH>    Inputs are raw 8-bit grayscale pixels of this size\n";
+    std::cout << "  --rois         Ask for the 101x101 ROI pixels as well\n";
+    std::cout << "  --dedup        Ask the server to flag near-duplicates of earlier ROIs\n";
+    std::cout << "  -q             Print only the summary\n";
+    std::cout << "  -h             Show this help\n";
+    std::cout << "\nExample:\n";
+    std::cout << "  " << programName << " -s /tmp/fingerprint.sock test_data/*.png\n";
+    std::cout << "  " << programName << " -s /tmp/fingerprint.sock -c 32 -n 100 -q test_data/sample.png\n";
+}
+
+int main(int argc, char* argv[]) {
+    ClientConfig config;
+    
+    static const struct option longOptions[] = {
+        { "raw",  required_argument, nullptr, 'R' },
+        { "rois", no_argument,       nullptr, 'I' },
+        { "dedup", no_argument,      nullptr, 'D' },
+        { "help", no_argument,       nullptr, 'h' },
+        { nullptr, 0,                nullptr, 0 }
+    };
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:c:n:qh", longOptions, nullptr)) != -1) {
+        switch (opt) {
+            case 's':
+                config.socketPath = optarg;
+                break;
+            case 'c':
+                config.connections = std::max(1, std::atoi(optarg));
+                break;
+            case 'n':
+                config.repeat = std::max(1, std::atoi(optarg));
+                break;
+            case 'R':
+                if (std::sscanf(optarg, "%dx%d", &config.rawWidth, &config.rawHeight) != 2 ||
+                    config.rawWidth <= 0 || config.rawHeight <= 0 ||
+                    config.rawWidth > 65535 || config.rawHeight > 65535) {
+                    std::cerr << "Invalid raw size: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case 'I':
+                config.includeRois = true;
+                break;
+            case 'D':
+                config.screenDuplicates = true;
+                break;
+            case 'q':
+                config.quiet = true;
+                break;
+            case 'h':
+                printUsage(argv[0]);
+                return 0;
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+    
+    for (int i = optind; i < argc; ++i) {
+        config.files.push_back(argv[i]);
+    }
+    if (config.socketPath.empty() || config.files.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    // Load every input up front so only the round trips are timed
+    std::vector<std::vector<uint8_t>> images(config.files.size());
+    for (size_t i = 0; i < config.files.size(); ++i) {
+        if (!readFile(config.files[i], images[i])) {
+            std::cerr << "Cannot read " << config.files[i] << "\n";
+            return 1;
+        }
+        if (config.rawWidth > 0 && images[i].size() != static_cast<size_t>(config.rawWidth) * config.rawHeight) {
+            std::cerr << config.files[i] << " is not " << config.rawWidth << "x" << config.rawHeight << " raw pixels\n";
+            return 1;
+        }
+    }
+    
+    std::vector<ClientTotals> totals(static_cast<size_t>(config.connections));
+    std::vector<std::thread> threads;
+    std::mutex outputMutex;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < config.connections; ++i) {
+        threads.emplace_back(runConnection, std::cref(config), std::cref(images), i,
+                             std::ref(totals[static_cast<size_t>(i)]), std::ref(outputMutex));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    ClientTotals summary;
+    for (const auto& part : totals) {
+        summary.requests += part.requests;
+        summary.found += part.found;
+        summary.duplicates += part.duplicates;
+        summary.errors += part.errors;
+        summary.latenciesUs.insert(summary.latenciesUs.end(), part.latenciesUs.begin(), part.latenciesUs.end());
+    }
+    std::sort(summary.latenciesUs.begin(), summary.latenciesUs.end());
+    
+    auto percentile = [&summary](double fraction) {
+        if (summary.latenciesUs.empty()) return 0.0;
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(summary.latenciesUs.size() - 1));
+        return summary.latenciesUs[index];
+    };
+    
+    std::cout << "Requests: " << summary.requests << " over " << config.connections << " connections, "
+              << summary.found << " with a core (" << summary.duplicates << " duplicates), "
+              << summary.errors << " errors\n";
+    std::cout << "Throughput: " << (elapsedSeconds > 0 ? summary.requests / elapsedSeconds : 0.0) << " requests/s\n";
+    std::cout << "Latency (us): p50 " << static_cast<uint64_t>(percentile(0.50))
+              << ", p99 " << static_cast<uint64_t>(percentile(0.99))
+              << ", max " << static_cast<uint64_t>(percentile(1.0)) << "\n";
+    
+    return summary.errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+// ContentHash.h - Streaming 64-bit content hash (XXH64) 
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * Streaming XXH64 over raw file bytes, for exact-duplicate detection
+ * Bit-compatible with the reference xxHash XXH64 (seed 0 by default), so hashes
+ * can be checked with the xxhsum tool; update() may be fed chunks of any size
+ * as they are read, and digest() can be called at any point without consuming
+ * the state
+ */
+class ContentHasher {
+private:
+    static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+    
+    uint64_t seed;
+    uint64_t lanes[4];                      // Accumulators for the 32-byte stripes
+    uint64_t total_length;
+    uint8_t buffer[32];                     // Tail of the input not yet forming a stripe
+    size_t buffered;
+    
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+    
+    static uint64_t read64(const uint8_t* p) {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));   // Little-endian hosts only (x86-64, AArch64)
+        return value;
+    }
+    
+    static uint32_t read32(const uint8_t* p) {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    
+    static uint64_t round(uint64_t lane, uint64_t input) {
+        lane += input * PRIME2;
+        return rotl(lane, 31) * PRIME1;
+    }
+    
+    static uint64_t merge_round(uint64_t hash, uint64_t lane) {
+        hash ^= round(0, lane);
+        return hash * PRIME1 + PRIME4;
+    }
+    
+    // Consume whole 32-byte stripes; returns the number of bytes used
+    size_t consume_stripes(const uint8_t* p, size_t length) {
+        const uint8_t* start = p;
+        const uint8_t* limit = p + length - length % 32;
+        uint64_t v1 = lanes[0], v2 = lanes[1], v3 = lanes[2], v4 = lanes[3];
+        
+        while (p < limit) {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+            p += 32;
+        }
+        
+        lanes[0] = v1; lanes[1] = v2; lanes[2] = v3; lanes[3] = v4;
+        return static_cast<size_t>(p - start);
+    }
+
+public:
+    explicit ContentHasher(uint64_t hash_seed = 0) { reset(hash_seed); }
+    
+    void reset(uint64_t hash_seed = 0) {
+        seed = hash_seed;
+        lanes[0] = seed + PRIME1 + PRIME2;
+        lanes[1] = seed + PRIME2;
+        lanes[2] = seed;
+        lanes[3] = seed - PRIME1;
+        total_length = 0;
+        buffered = 0;
+    }
+    
+    void update(const void* data, size_t length) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        total_length += length;
+        
+        if (buffered + length < 32) {
+            memcpy(buffer + buffered, p, length);
+            buffered += length;
+            return;
+        }
+        
+        if (buffered > 0) {
+            size_t fill = 32 - buffered;
+            memcpy(buffer + buffered, p, fill);
+            consume_stripes(buffer, 32);
+            p += fill;
+            length -= fill;
+            buffered = 0;
+        }
+        
+        size_t used = consume_stripes(p, length);
+        buffered = length - used;
+        memcpy(buffer, p + used, buffered);
+    }
+    
+    uint64_t digest() const {
+        uint64_t hash;
+        if (total_length >= 32) {
+            hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+            for (uint64_t lane : lanes) {
+                hash = merge_round(hash, lane);
+            }
+        } else {
+            hash = seed + PRIME5;
+        }
+        hash += total_length;
+        
+        const uint8_t* p = buffer;
+        const uint8_t* end = buffer + buffered;
+        for (; p + 8 <= end; p += 8) {
+            hash ^= round(0, read64(p));
+            hash = rotl(hash, 27) * PRIME1 + PRIME4;
+        }
+        if (p + 4 <= end) {
+            hash ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+            hash = rotl(hash, 23) * PRIME2 + PRIME3;
+            p += 4;
+        }
+        for (; p < end; ++p) {
+            hash ^= (*p) * PRIME5;
+            hash = rotl(hash, 11) * PRIME1;
+        }
+        
+        hash ^= hash >> 33;
+        hash *= PRIME2;
+        hash ^= hash >> 29;
+        hash *= PRIME3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+    
+    // One-shot hash of a buffer
+    static uint64_t hash(const void* data, size_t length, uint64_t hash_seed = 0) {
+        ContentHasher hasher(hash_seed);
+        hasher.update(data, length);
+        return hasher.digest();
+    }
+};
@@ -1,2 +1,2 @@
-// MemoryPool.h - Pre-allocated memory pools 
-// Implementation placeholder 
+// MemoryPool.h - Pre-allocated memory pools 
+// Implementation placeholder 
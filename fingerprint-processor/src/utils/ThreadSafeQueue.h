@@ -1,2 +1,122 @@
-// ThreadSafeQueue.h - Lock-free queue template 
-// Implementation placeholder 
+// ThreadSafeQueue.h - Bounded blocking queue template 
+#pragma once
+
+#include <deque>
+#include <algorithm>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * Bounded multi-producer / multi-consumer queue
+ * push() blocks while the queue is full (backpressure on producers)
+ * close() wakes everyone; consumers drain what is left, producers are rejected
+ */
+template<typename T>
+class ThreadSafeQueue {
+private:
+    std::deque<T> items;
+    size_t capacity;
+    bool is_closed;
+    size_t peak_size;
+    
+    mutable std::mutex queue_mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+public:
+    explicit ThreadSafeQueue(size_t max_items = 1024) 
+        : capacity(max_items > 0 ? max_items : 1), is_closed(false), peak_size(0) {}
+    
+    ThreadSafeQueue(const ThreadSafeQueue&) = delete;
+    ThreadSafeQueue& operator=(const ThreadSafeQueue&) = delete;
+    
+    // Blocking push; returns false if the queue was closed
+    bool push(T&& item) {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        not_full.wait(lock, [this] { return items.size() < capacity || is_closed; });
+        if (is_closed) return false;
+        
+        items.push_back(std::move(item));
+        peak_size = std::max(peak_size, items.size());
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+    
+    // Non-blocking push; returns false if the queue is full or closed
+    bool try_push(T&& item) {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        if (is_closed || items.size() >= capacity) return false;
+        
+        items.push_back(std::move(item));
+        peak_size = std::max(peak_size, items.size());
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+    
+    // Blocking pop; returns false once the queue is closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        not_empty.wait(lock, [this] { return !items.empty() || is_closed; });
+        if (items.empty()) return false;
+        
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+    
+    // Move up to max_items into out, waiting until at least one item is available,
+    // the deadline passes or the queue is closed. Returns the number of items moved.
+    size_t pop_batch(std::vector<T>& out, size_t max_items, 
+                     std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        not_empty.wait_until(lock, deadline, [this] { return !items.empty() || is_closed; });
+        
+        size_t count = std::min(max_items, items.size());
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(std::move(items.front()));
+            items.pop_front();
+        }
+        lock.unlock();
+        
+        if (count > 0) not_full.notify_all();
+        return count;
+    }
+    
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            is_closed = true;
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+    
+    // State
+    bool closed() const {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return is_closed;
+    }
+    
+    bool drained() const {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return is_closed && items.empty();
+    }
+    
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return items.size();
+    }
+    
+    size_t peak() const {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return peak_size;
+    }
+    
+    size_t get_capacity() const { return capacity; }
+};
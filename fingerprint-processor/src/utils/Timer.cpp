@@ -1,103 +1,160 @@
-// Timer.cpp - Timer implementation 
-// Implementation placeholder 
-#include "Timer.h"
-#include <iostream>
-#include <iomanip>
-#include <algorithm>
-
-// Static member definitions
-std::mutex Timer::profile_mutex;
-std::unordered_map<std::string, double> Timer::total_times;
-std::unordered_map<std::string, int> Timer::call_counts;
-
-// Thread-local storage for nested profiling
-thread_local std::unordered_map<std::string, Timer> active_timers;
-
-void Timer::profile_start(const std::string& name) {
-    active_timers[name].start();
-}
-
-double Timer::profile_stop(const std::string& name) {
-    auto it = active_timers.find(name);
-    if (it == active_timers.end()) {
-        return 0.0;
-    }
-    
-    double elapsed = it->second.stop();
-    
-    // Add to global profiling data
-    {
-        std::lock_guard<std::mutex> lock(profile_mutex);
-        total_times[name] += elapsed;
-        call_counts[name]++;
-    }
-    
-    active_timers.erase(it);
-    return elapsed;
-}
-
-void Timer::profile_add(const std::string& name, double time_us) {
-    std::lock_guard<std::mutex> lock(profile_mutex);
-    total_times[name] += time_us;
-    call_counts[name]++;
-}
-
-void Timer::print_profile_summary() {
-    std::lock_guard<std::mutex> lock(profile_mutex);
-    
-    if (total_times.empty()) {
-        std::cout << "No profiling data available." << std::endl;
-        return;
-    }
-
-    std::cout << "\n=== PROFILING SUMMARY ===" << std::endl;
-    std::cout << std::left << std::setw(25) << "Function"
-              << std::right << std::setw(10) << "Calls"
-              << std::setw(15) << "Total (μs)"
-              << std::setw(15) << "Avg (μs)"
-              << std::setw(15) << "Total (ms)"
-              << std::setw(15) << "Avg (ms)" << std::endl;
-    std::cout << std::string(95, '-') << std::endl;
-
-    // Sort by total time (descending)
-    std::vector<std::pair<std::string, double>> sorted_times;
-    for (const auto& pair : total_times) {
-        sorted_times.emplace_back(pair.first, pair.second);
-    }
-    std::sort(sorted_times.begin(), sorted_times.end(),
-              [](const auto& a, const auto& b) { return a.second > b.second; });
-
-    for (const auto& pair : sorted_times) {
-        const std::string& name = pair.first;
-        double total_us = pair.second;
-        int calls = call_counts[name];
-        double avg_us = total_us / calls;
-        double total_ms = total_us / 1000.0;
-        double avg_ms = avg_us / 1000.0;
-
-        std::cout << std::left << std::setw(25) << name
-                  << std::right << std::setw(10) << calls
-                  << std::setw(15) << std::fixed << std::setprecision(1) << total_us
-                  << std::setw(15) << std::fixed << std::setprecision(1) << avg_us
-                  << std::setw(15) << std::fixed << std::setprecision(3) << total_ms
-                  << std::setw(15) << std::fixed << std::setprecision(3) << avg_ms
-                  << std::endl;
-    }
-
-    std::cout << std::string(95, '-') << std::endl;
-    
-    // Calculate total processing time
-    double grand_total = 0.0;
-    for (const auto& pair : total_times) {
-        grand_total += pair.second;
-    }
-    
-    std::cout << "Total processing time: " << format_time(grand_total) << std::endl;
-    std::cout << "========================" << std::endl;
-}
-
-void Timer::clear_profile_data() {
-    std::lock_guard<std::mutex> lock(profile_mutex);
-    total_times.clear();
-    call_counts.clear();
-}
+// Timer.cpp - Timer implementation 
+// Implementation placeholder 
+#include "Timer.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Static member definitions
+std::mutex Timer::profile_mutex;
+
+namespace {
+    // Fixed-size profiling tables: a stage is looked up by name, so timing it
+    // never builds a std::string or touches the heap on the hot path
+    struct ProfileEntry {
+        char name[Timer::MAX_PROFILE_NAME + 1];
+        double total_us;
+        int calls;
+    };
+    
+    struct ActiveTimer {
+        char name[Timer::MAX_PROFILE_NAME + 1];
+        Timer timer;
+        bool active;
+    };
+    
+    // Global totals, guarded by Timer::profile_mutex
+    ProfileEntry profile_entries[Timer::MAX_PROFILE_STAGES];
+    size_t profile_entry_count = 0;
+    
+    // Thread-local storage for nested profiling
+    thread_local ActiveTimer active_timers[Timer::MAX_PROFILE_STAGES];
+    
+    void copy_name(char* dest, const char* name) {
+        std::strncpy(dest, name, Timer::MAX_PROFILE_NAME);
+        dest[Timer::MAX_PROFILE_NAME] = '\0';
+    }
+    
+    bool same_name(const char* stored, const char* name) {
+        return std::strncmp(stored, name, Timer::MAX_PROFILE_NAME) == 0;
+    }
+    
+    // Caller holds profile_mutex; nullptr once the table is full
+    ProfileEntry* find_entry(const char* name) {
+        for (size_t i = 0; i < profile_entry_count; ++i) {
+            if (same_name(profile_entries[i].name, name)) {
+                return &profile_entries[i];
+            }
+        }
+        if (profile_entry_count == Timer::MAX_PROFILE_STAGES) {
+            return nullptr;
+        }
+        ProfileEntry& entry = profile_entries[profile_entry_count++];
+        copy_name(entry.name, name);
+        entry.total_us = 0.0;
+        entry.calls = 0;
+        return &entry;
+    }
+}
+
+void Timer::profile_start(const char* name) {
+    ActiveTimer* free_slot = nullptr;
+    for (auto& slot : active_timers) {
+        if (slot.active && same_name(slot.name, name)) {
+            slot.timer.start();
+            return;
+        }
+        if (!slot.active && !free_slot) {
+            free_slot = &slot;
+        }
+    }
+    if (!free_slot) {
+        return;
+    }
+    
+    copy_name(free_slot->name, name);
+    free_slot->active = true;
+    free_slot->timer.start();
+}
+
+double Timer::profile_stop(const char* name) {
+    for (auto& slot : active_timers) {
+        if (!slot.active || !same_name(slot.name, name)) continue;
+        
+        double elapsed = slot.timer.stop();
+        slot.active = false;
+        profile_add(name, elapsed);
+        return elapsed;
+    }
+    return 0.0;
+}
+
+void Timer::profile_add(const char* name, double time_us) {
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    ProfileEntry* entry = find_entry(name);
+    if (entry) {
+        entry->total_us += time_us;
+        entry->calls++;
+    }
+}
+
+void Timer::print_profile_summary() {
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    
+    if (profile_entry_count == 0) {
+        std::cout << "No profiling data available." << std::endl;
+        return;
+    }
+
+    std::cout << "\n=== PROFILING SUMMARY ===" << std::endl;
+    std::cout << std::left << std::setw(25) << "Function"
+              << std::right << std::setw(10) << "Calls"
+              << std::setw(15) << "Total (μs)"
+              << std::setw(15) << "Avg (μs)"
+              << std::setw(15) << "Total (ms)"
+              << std::setw(15) << "Avg (ms)" << std::endl;
+    std::cout << std::string(95, '-') << std::endl;
+
+    // Sort by total time (descending)
+    std::vector<const ProfileEntry*> sorted_times;
+    for (size_t i = 0; i < profile_entry_count; ++i) {
+        sorted_times.push_back(&profile_entries[i]);
+    }
+    std::sort(sorted_times.begin(), sorted_times.end(),
+              [](const ProfileEntry* a, const ProfileEntry* b) { return a->total_us > b->total_us; });
+
+    for (const ProfileEntry* entry : sorted_times) {
+        const char* name = entry->name;
+        double total_us = entry->total_us;
+        int calls = entry->calls;
+        double avg_us = total_us / calls;
+        double total_ms = total_us / 1000.0;
+        double avg_ms = avg_us / 1000.0;
+
+        std::cout << std::left << std::setw(25) << name
+                  << std::right << std::setw(10) << calls
+                  << std::setw(15) << std::fixed << std::setprecision(1) << total_us
+                  << std::setw(15) << std::fixed << std::setprecision(1) << avg_us
+                  << std::setw(15) << std::fixed << std::setprecision(3) << total_ms
+                  << std::setw(15) << std::fixed << std::setprecision(3) << avg_ms
+                  << std::endl;
+    }
+
+    std::cout << std::string(95, '-') << std::endl;
+    
+    // Calculate total processing time
+    double grand_total = 0.0;
+    for (size_t i = 0; i < profile_entry_count; ++i) {
+        grand_total += profile_entries[i].total_us;
+    }
+    
+    std::cout << "Total processing time: " << format_time(grand_total) << std::endl;
+    std::cout << "========================" << std::endl;
+}
+
+void Timer::clear_profile_data() {
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    profile_entry_count = 0;
+}
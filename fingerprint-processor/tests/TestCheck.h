@@ -0,0 +1,34 @@
+// TestCheck.h - Minimal assertion helpers for the unit tests 
+#pragma once
+
+#include <iostream>
+
+/**
+ * CHECK records a failure and keeps going; TEST_RESULT() is the test's exit code.
+ * Each test is a plain executable registered with ctest (tests/CMakeLists.txt).
+ */
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition "\n"; \
+            test_failures()++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto actual_value = (actual); \
+        auto expected_value = (expected); \
+        if (!(actual_value == expected_value)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ failed: " #actual " == " #expected \
+                      << " (" << actual_value << " vs " << expected_value << ")\n"; \
+            test_failures()++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() (test_failures() == 0 ? 0 : 1)
@@ -0,0 +1,156 @@
+// test_address_generator.cpp - Golden addresses and keys for fixed ROIs, and key order 
+#include "TestCheck.h"
+#include "core/AddressGenerator.h"
+#include "core/FeatureExtractor.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+using PatternType = FeatureExtractor::PatternType;
+
+// Synthetic ROIs; each is chosen so no feature sits near a bin edge
+enum class Pattern { RINGS, STRIPES, TILTED_CHIRP, BROKEN_STRIPES };
+
+static void make_roi(Pattern pattern, FeatureExtractor::ROI& roi) {
+    const float two_pi = 2.0f * 3.14159265f;
+    for (int y = 0; y < 101; ++y) {
+        for (int x = 0; x < 101; ++x) {
+            float phase = 0.0f;
+            switch (pattern) {
+                case Pattern::RINGS:          phase = std::hypot(x - 50.0f, y - 50.0f) * two_pi / 8.5f; break;
+                case Pattern::STRIPES:        phase = x * two_pi / 7.0f; break;
+                case Pattern::TILTED_CHIRP:   phase = (x * 0.8f + y * 0.6f) * two_pi / (7.0f + 5.0f * x / 100.0f); break;
+                case Pattern::BROKEN_STRIPES: phase = x * two_pi / 9.0f + (y > 50 && x > 30 && x < 70 ? 3.14159f : 0.0f); break;
+            }
+            roi.pixels[y][x] = static_cast<uint8_t>(std::lrint(128.0f + 100.0f * std::sin(phase)));
+        }
+    }
+}
+
+static std::string address_of(const FeatureExtractor& extractor, Pattern pattern, PatternType type, uint64_t& key) {
+    FeatureExtractor::ROI roi;
+    make_roi(pattern, roi);
+    
+    FeatureExtractor::PatternClassification classification;
+    classification.type = type;
+    AddressGenerator::Features features = AddressGenerator::make_features(
+        classification, extractor.compute_ridge_density(roi), extractor.extract_minutiae(roi),
+        extractor.compute_zernike_moments(roi));
+    
+    AddressGenerator::Codes codes = AddressGenerator::quantize(features);
+    AddressGenerator::Address address;
+    AddressGenerator::format(codes, address);
+    key = AddressGenerator::address_key(codes);
+    return address.c_str();
+}
+
+static std::string address_of(const AddressGenerator::Codes& codes) {
+    AddressGenerator::Address address;
+    AddressGenerator::format(codes, address);
+    return address.c_str();
+}
+
+int main() {
+    // Golden vectors: a change to the extractor, the bin tables or the key layout
+    // moves stored addresses and has to show up here
+    struct Golden { Pattern pattern; PatternType type; const char* address; uint64_t key; };
+    const Golden goldens[] = {
+        {Pattern::RINGS,          PatternType::WHORL,     "W-9-0-E000", 0x490E000000000000ull},
+        {Pattern::STRIPES,        PatternType::ARCH,      "A-5-0-6446", 0x0506446000000000ull},
+        {Pattern::TILTED_CHIRP,   PatternType::LEFT_LOOP, "L-D-1-0228", 0x1D10228000000000ull},
+        {Pattern::BROKEN_STRIPES, PatternType::RIGHT_LOOP, "R-9-7-0657", 0x2970657000000000ull},
+    };
+    
+    for (bool use_simd : {false, true}) {
+        FeatureExtractor::ExtractionParams params;
+        params.use_simd = use_simd;
+        FeatureExtractor extractor(params);
+        
+        for (const Golden& golden : goldens) {
+            uint64_t key = 0;
+            CHECK_EQ(address_of(extractor, golden.pattern, golden.type, key), std::string(golden.address));
+            CHECK_EQ(key, golden.key);
+            
+            uint64_t parsed = 0;
+            CHECK(AddressGenerator::address_key(golden.address, parsed));
+            CHECK_EQ(parsed, golden.key);
+        }
+    }
+    
+    // Quantization alone, from features in natural units
+    AddressGenerator::Features features;
+    features.pattern = PatternType::WHORL;
+    features.ridge_period = 9.0f;
+    features.minutiae_count = 7;
+    const float ratios[] = {0.0f, 0.01f, 0.05f, 0.5f};
+    std::memcpy(features.zernike_ratio, ratios, sizeof(ratios));
+    CHECK_EQ(std::string(AddressGenerator::generate(features).c_str()), std::string("W-9-6-05BF"));
+    CHECK_EQ(AddressGenerator::address_key(AddressGenerator::quantize(features)), 0x49605BF000000000ull);
+    
+    // NaN, infinities and huge values clamp to the end bins instead of hitting an undefined cast
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    features.pattern = PatternType::TENTED_ARCH;
+    features.ridge_period = nan;
+    features.minutiae_count = -5;
+    const float extremes[] = {inf, -inf, nan, 1e30f};
+    std::memcpy(features.zernike_ratio, extremes, sizeof(extremes));
+    CHECK_EQ(std::string(AddressGenerator::generate(features).c_str()), std::string("T-0-0-F00F"));
+    features.ridge_period = 1e30f;
+    features.minutiae_count = 1000;
+    CHECK_EQ(std::string(AddressGenerator::generate(features).c_str()), std::string("T-F-F-F00F"));
+    
+    // Pattern letters sort A < L < R < T < W < X in both text and key
+    const PatternType by_letter[] = {PatternType::ARCH, PatternType::LEFT_LOOP, PatternType::RIGHT_LOOP,
+                                     PatternType::TENTED_ARCH, PatternType::WHORL, PatternType::UNKNOWN};
+    const char letters[] = "ALRTWX";
+    for (int i = 0; i < 6; ++i) {
+        AddressGenerator::Codes codes;
+        codes.pattern = static_cast<uint8_t>(by_letter[i]);
+        CHECK_EQ(address_of(codes)[0], letters[i]);
+        CHECK_EQ(AddressGenerator::address_key(codes) >> 60, static_cast<uint64_t>(i));
+    }
+    
+    // Key order is string order for arbitrary codes
+    uint32_t seed = 12345;
+    auto next_digit = [&seed](int range) {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<uint8_t>((seed >> 16) % range);
+    };
+    AddressGenerator::Codes previous;
+    std::string previous_text = address_of(previous);
+    uint64_t previous_key = AddressGenerator::address_key(previous);
+    for (int i = 0; i < 5000; ++i) {
+        AddressGenerator::Codes codes;
+        codes.pattern = next_digit(6);
+        codes.ridge = next_digit(16);
+        codes.minutiae = next_digit(16);
+        for (int z = 0; z < AddressGenerator::ZERNIKE_DIGITS; ++z) codes.zernike[z] = next_digit(i % 2 ? 16 : 2);
+        
+        std::string text = address_of(codes);
+        uint64_t key = AddressGenerator::address_key(codes);
+        CHECK_EQ(text < previous_text, key < previous_key);
+        CHECK_EQ(text == previous_text, key == previous_key);
+        CHECK(key <= static_cast<uint64_t>(INT64_MAX));
+        
+        // Every prefix's range holds the key
+        for (size_t length = 1; length <= AddressGenerator::ADDRESS_LENGTH; ++length) {
+            uint64_t low = 0, high = 0;
+            CHECK(AddressGenerator::prefix_range(text.substr(0, length).c_str(), low, high));
+            CHECK(low <= key && key <= high);
+        }
+        previous_text = text;
+        previous_key = key;
+    }
+    
+    // Malformed addresses and prefixes are rejected
+    uint64_t key = 0, low = 0, high = 0;
+    CHECK(!AddressGenerator::address_key("W-9-6-05B", key));
+    CHECK(!AddressGenerator::address_key("Q-9-6-05BF", key));
+    CHECK(!AddressGenerator::prefix_range("W-g", low, high));
+    CHECK(!AddressGenerator::prefix_range("W_9", low, high));
+    CHECK(!AddressGenerator::prefix_range("W-9-6-05BF0", low, high));
+    
+    return TEST_RESULT();
+}
@@ -0,0 +1,116 @@
+// test_async_database_writer.cpp - One result is one unit; failed commits are retried, isolated and reported, and marks stop before them 
+#include "TestCheck.h"
+#include "database/AsyncDatabaseWriter.h"
+#include "utils/Logger.h"
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+// Three cores per image, so every result is a unit of three rows
+static CorePointDetector::DetectionResult make_result(int index) {
+    CorePointDetector::DetectionResult result;
+    result.success = true;
+    for (int core = 0; core < 3; ++core) {
+        result.core_points.emplace_back(50.0f + core, 60.0f, 0.9f - 0.1f * core);
+    }
+    result.extracted_roi.filename = "image_" + std::to_string(index) + ".png";
+    result.extracted_roi.file_index = index;
+    result.secondary_rois.resize(2, result.extracted_roi);
+    result.content_hash = 7000 + static_cast<uint64_t>(index);
+    return result;
+}
+
+static int64_t count_rows(const std::string& path, const std::string& where) {
+    SQLiteAdapter db;
+    SQLiteStatement count;
+    if (!db.open(path) || !db.prepare(count, "SELECT COUNT(*) FROM rois WHERE " + where + ";") ||
+        count.step() != SQLITE_ROW) {
+        return -1;
+    }
+    return count.column_int64(0);
+}
+
+int main() {
+    Logger::set_level(Logger::Level::WARNING);
+    const std::string path = "/tmp/test_async_database_writer_" + std::to_string(getpid()) + ".db";
+    std::remove(path.c_str());
+    
+    AsyncDatabaseWriter::Config config;
+    config.database.database_path = path;
+    config.commit_rows = 8;                 // Not a multiple of 3: units must not be split to fit
+    config.commit_interval_ms = 1000;       // Long enough that only size and flush() trigger commits
+    config.retry_backoff_ms = 1;
+    
+    // Create the schema, then make one core of image 13 fail to insert
+    {
+        DatabaseWriter schema_writer;
+        CHECK(schema_writer.open(config.database));
+        schema_writer.close();
+        
+        SQLiteAdapter db;
+        CHECK(db.open(path));
+        CHECK(db.exec("CREATE TRIGGER fail_one BEFORE INSERT ON rois WHEN NEW.file_index = 13 AND NEW.core_rank = 2 "
+                      "BEGIN SELECT RAISE(ABORT, 'injected'); END;"));
+        db.close();
+    }
+    
+    Logger::set_level(Logger::Level::ERROR);
+    AsyncDatabaseWriter writer;
+    CHECK(writer.start(config));
+    for (int i = 0; i < 40; ++i) {
+        CHECK(writer.submit(make_result(i)));
+        CHECK(writer.contains_content(7000 + static_cast<uint64_t>(i)));   // Queued counts as present
+    }
+    CHECK(writer.submit(CorePointDetector::DetectionResult()));     // Nothing to store
+    
+    // flush() commits now, and reports the dropped unit exactly once
+    CHECK(!writer.flush());
+    CHECK(writer.flush());
+    
+    AsyncDatabaseWriter::Metrics metrics = writer.get_metrics();
+    CHECK_EQ(metrics.rows_committed, static_cast<size_t>(39 * 3));
+    CHECK_EQ(metrics.failed_rows, static_cast<size_t>(3));
+    CHECK(metrics.failed_commits >= static_cast<size_t>(config.commit_retries + 1));
+    
+    // Rows are visible after flush(), before stop()
+    CHECK_EQ(count_rows(path, "1"), static_cast<int64_t>(39 * 3));
+    
+    // The whole unit of image 13 was rejected, not just its failing core
+    CHECK_EQ(count_rows(path, "file_index = 13"), static_cast<int64_t>(0));
+    CHECK_EQ(count_rows(path, "file_index = 12"), static_cast<int64_t>(3));
+    CHECK_EQ(count_rows(path, "file_index = 14"), static_cast<int64_t>(3));
+    
+    // Committed and dropped rows leave the queue: only the stored ones are still present
+    CHECK(writer.contains_content(7000 + 12));
+    CHECK(!writer.contains_content(7000 + 13));
+    
+    writer.stop();
+    Logger::set_level(Logger::Level::WARNING);
+    CHECK(!writer.submit(make_result(99)));
+    CHECK(!writer.flush());
+    
+    // Marks ride with their units: the stored one is the last before the dropped unit,
+    // even though later units (and marks of inputs without rows) were committed
+    Logger::set_level(Logger::Level::ERROR);
+    CHECK(writer.start(config));
+    DatabaseWriter::RunProgress progress;
+    progress.run_key = "marks";
+    for (int i = 0; i < 30; ++i) {
+        progress.last_input = "image_" + std::to_string(i) + ".png";
+        progress.inputs_committed = i + 1;
+        CHECK(writer.submit(i % 4 == 3 ? CorePointDetector::DetectionResult() : make_result(i), progress));
+    }
+    CHECK(!writer.flush());
+    DatabaseWriter::RunProgress committed;
+    CHECK(writer.load_progress("marks", committed));
+    CHECK_EQ(committed.last_input, std::string("image_12.png"));
+    CHECK_EQ(committed.inputs_committed, static_cast<int64_t>(13));
+    CHECK_EQ(count_rows(path, "file_index = 29"), static_cast<int64_t>(6));     // Both sessions
+    writer.stop();
+    Logger::set_level(Logger::Level::WARNING);
+    
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+    return TEST_RESULT();
+}
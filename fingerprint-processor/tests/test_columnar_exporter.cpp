@@ -0,0 +1,241 @@
+// test_columnar_exporter.cpp - Exported files read back column by column, with addresses and features 
+#include "TestCheck.h"
+#include "database/ColumnarExporter.h"
+#include "utils/Logger.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using Exporter = ColumnarExporter;
+
+static uint32_t get_u32(const uint8_t* p) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) value = value << 8 | p[i];
+    return value;
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    return get_u32(p) | static_cast<uint64_t>(get_u32(p + 4)) << 32;
+}
+
+// A minimal reader following the layout documented in ColumnarExporter.h
+struct ColumnarFile {
+    std::vector<uint8_t> bytes;
+    uint16_t column_count = 0;
+    uint32_t row_group_rows = 0;
+    std::vector<std::string> names;
+    uint64_t total_rows = 0;
+    std::vector<std::pair<uint64_t, uint32_t>> row_groups;   // offset, rows
+    
+    bool load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (bytes.size() < 64 + Exporter::TRAILER_SIZE || get_u32(&bytes[0]) != Exporter::MAGIC) return false;
+        
+        column_count = static_cast<uint16_t>(bytes[6] | bytes[7] << 8);
+        row_group_rows = get_u32(&bytes[8]);
+        for (size_t i = 0; i < column_count; ++i) {
+            names.emplace_back(reinterpret_cast<const char*>(&bytes[64 + 32 * i + 4]));
+        }
+        
+        const uint8_t* trailer = &bytes[bytes.size() - Exporter::TRAILER_SIZE];
+        if (get_u32(trailer + 20) != Exporter::MAGIC || get_u32(trailer + 16) != Exporter::VERSION) return false;
+        total_rows = get_u64(trailer);
+        uint32_t count = get_u32(trailer + 8);
+        const uint8_t* footer = trailer - 16 * count;
+        if (RoiCodec::crc32c(footer, 16 * count) != get_u32(trailer + 12)) return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            row_groups.emplace_back(get_u64(footer + 16 * i), get_u32(footer + 16 * i + 8));
+        }
+        return true;
+    }
+    
+    // Bytes of one column chunk, after checking its CRC; nullptr on a mismatch
+    const uint8_t* chunk(size_t group, size_t column, uint64_t& size) const {
+        const uint8_t* header = &bytes[row_groups[group].first];
+        if (get_u32(header) != Exporter::ROW_GROUP_MAGIC) return nullptr;
+        
+        uint64_t offset = row_groups[group].first + aligned(16 + 16 * column_count);
+        for (size_t i = 0; i < column; ++i) offset += aligned(get_u64(header + 16 + 16 * i));
+        size = get_u64(header + 16 + 16 * column);
+        const uint8_t* data = &bytes[offset];
+        return RoiCodec::crc32c(data, size) == get_u32(header + 16 + 16 * column + 8) ? data : nullptr;
+    }
+    
+    template <typename T>
+    T value(size_t group, size_t column, size_t row, size_t width = 1, size_t element = 0) const {
+        uint64_t size = 0;
+        const uint8_t* data = chunk(group, column, size);
+        T result{};
+        if (data) std::memcpy(&result, data + (row * width + element) * sizeof(T), sizeof(T));
+        return result;
+    }
+    
+    std::string string_value(size_t group, size_t column, size_t row) const {
+        uint64_t size = 0;
+        const uint8_t* data = chunk(group, column, size);
+        if (!data) return "";
+        uint32_t rows = row_groups[group].second;
+        uint32_t begin = get_u32(data + 4 * row);
+        uint32_t end = get_u32(data + 4 * (row + 1));
+        return std::string(reinterpret_cast<const char*>(data + 4 * (rows + 1) + begin), end - begin);
+    }
+    
+    size_t column(const std::string& name) const {
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) return i;
+        }
+        return names.size();
+    }
+    
+    static uint64_t aligned(uint64_t size) {
+        return (size + Exporter::ALIGNMENT - 1) / Exporter::ALIGNMENT * Exporter::ALIGNMENT;
+    }
+};
+
+// Two cores per print with ridge-like ROIs (stripes of a per-print period)
+static CorePointDetector::DetectionResult make_result(int index) {
+    CorePointDetector::DetectionResult result;
+    result.success = true;
+    result.overall_quality = 0.75f;
+    result.processing_time_us = 1000 + index;
+    result.content_hash = 0xC0FFEE00ull + index;
+    result.core_points.emplace_back(50.0f + index, 60.0f, 0.9f);
+    result.core_points.emplace_back(80.0f, 90.0f + index, 0.6f);
+    result.secondary_rois.resize(1);
+    
+    CorePointDetector::ROI* rois[] = { &result.extracted_roi, &result.secondary_rois[0] };
+    for (int r = 0; r < 2; ++r) {
+        CorePointDetector::ROI& roi = *rois[r];
+        roi.filename = "print_" + std::to_string(index) + ".png";
+        roi.file_index = index;
+        roi.rotation = 0.1f * r;
+        roi.hash.bits[0] = static_cast<uint64_t>(index) << 8 | r;
+        roi.hash.bits[1] = ~roi.hash.bits[0];
+        const float period = 6.0f + index % 5 + 2 * r;
+        for (int y = 0; y < 101; ++y) {
+            for (int x = 0; x < 101; ++x) {
+                roi.pixels[y][x] = static_cast<uint8_t>(std::lrint(128.0f + 100.0f * std::sin((x + 0.3f * y) * 6.2831853f / period)));
+            }
+        }
+    }
+    return result;
+}
+
+int main() {
+    Logger::set_level(Logger::Level::WARNING);
+    const std::string path = "/tmp/test_columnar_exporter_" + std::to_string(getpid()) + ".fcol";
+    
+    // Rows 0-9 from results, 10-19 from records made with an extractor; 4 rows per group
+    FeatureExtractor extractor;
+    std::vector<DatabaseWriter::Record> expected;
+    {
+        Exporter exporter;
+        Exporter::Config config;
+        config.output_path = path;
+        config.row_group_rows = 4;
+        CHECK(exporter.open(config));
+        
+        for (int i = 0; i < 10; ++i) {
+            CorePointDetector::DetectionResult result = make_result(i);
+            std::vector<DatabaseWriter::Record> records =
+                DatabaseWriter::make_records(result, RoiCodec::Compression::NONE, &extractor);
+            
+            if (i < 5) {
+                CHECK(exporter.write(result));
+            } else {
+                CHECK(exporter.write(records));
+            }
+            expected.insert(expected.end(), records.begin(), records.end());
+        }
+        CHECK(exporter.write(CorePointDetector::DetectionResult()));    // Failed detections add no rows
+        
+        Exporter::ExportStats stats = exporter.get_stats();
+        CHECK_EQ(stats.rows_written, static_cast<size_t>(20));
+        CHECK_EQ(stats.row_groups_written, static_cast<size_t>(5));
+        exporter.close();
+    }
+    
+    ColumnarFile file;
+    CHECK(file.load(path));
+    CHECK_EQ(file.column_count, static_cast<uint16_t>(13));
+    CHECK_EQ(file.row_group_rows, static_cast<uint32_t>(4));
+    CHECK_EQ(file.total_rows, static_cast<uint64_t>(20));
+    CHECK_EQ(file.row_groups.size(), static_cast<size_t>(5));
+    
+    const size_t filename = file.column("filename");
+    const size_t core_rank = file.column("core_rank");
+    const size_t core_x = file.column("core_x");
+    const size_t address_key = file.column("address_key");
+    const size_t content_hash = file.column("content_hash");
+    const size_t roi_hash = file.column("roi_hash");
+    const size_t feature_vector = file.column("feature_vector");
+    CHECK(feature_vector < file.names.size());
+    
+    // Both write paths produce the same values the database would store
+    const size_t dim = FeatureExtractor::FeatureVector::DIM;
+    size_t row = 0, described = 0;
+    for (size_t group = 0; group < file.row_groups.size(); ++group) {
+        for (size_t r = 0; r < file.row_groups[group].second; ++r, ++row) {
+            const DatabaseWriter::Record& record = expected[row];
+            CHECK_EQ(file.string_value(group, filename, r), record.filename);
+            CHECK_EQ(file.value<int32_t>(group, core_rank, r), record.core_rank);
+            CHECK_EQ(file.value<float>(group, core_x, r), record.core_x);
+            CHECK_EQ(file.value<uint64_t>(group, content_hash, r), record.content_hash);
+            CHECK_EQ(file.value<uint64_t>(group, roi_hash, r, 2, 1), record.roi_hash.bits[1]);
+            
+            uint64_t key = 0;
+            CHECK(AddressGenerator::address_key(record.address.c_str(), key));
+            CHECK_EQ(file.value<uint64_t>(group, address_key, r), key);
+            
+            CHECK_EQ(record.feature_vector.size(), dim);
+            bool same = true;
+            for (size_t k = 0; k < dim; ++k) {
+                same = same && file.value<float>(group, feature_vector, r, dim, k) == record.feature_vector[k];
+            }
+            CHECK(same);
+            described += key != 0;
+        }
+    }
+    CHECK_EQ(row, static_cast<size_t>(20));
+    CHECK_EQ(described, static_cast<size_t>(20));
+    
+    // Without describe_rois, result rows have no address and NaN features
+    {
+        Exporter exporter;
+        Exporter::Config config;
+        config.output_path = path;
+        config.describe_rois = false;
+        CHECK(exporter.open(config));
+        CHECK(exporter.write(make_result(0)));
+        exporter.close();
+        
+        ColumnarFile plain;
+        CHECK(plain.load(path));
+        CHECK_EQ(plain.total_rows, static_cast<uint64_t>(2));
+        CHECK_EQ(plain.value<uint64_t>(0, address_key, 1), static_cast<uint64_t>(0));
+        CHECK(std::isnan(plain.value<float>(0, feature_vector, 1, dim, 0)));
+    }
+    
+    // A file whose exporter never closed has no trailer
+    {
+        Exporter::Config config;
+        config.output_path = path;
+        auto* exporter = new Exporter();
+        CHECK(exporter->open(config));
+        CHECK(exporter->write(make_result(1)));
+        CHECK(exporter->flush());
+        
+        ColumnarFile partial;
+        CHECK(!partial.load(path));
+        delete exporter;
+        CHECK(partial.load(path));
+    }
+    
+    std::remove(path.c_str());
+    return TEST_RESULT();
+}
@@ -0,0 +1,112 @@
+// test_content_hash.cpp - XXH64 matches the reference vectors and FileManager hashes what it reads 
+#include "TestCheck.h"
+#include "core/FileManager.h"
+#include "utils/ContentHash.h"
+#include "utils/Logger.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static uint64_t xxh64(const void* data, size_t length, uint64_t seed = 0) {
+    ContentHasher hasher(seed);
+    hasher.update(data, length);
+    return hasher.digest();
+}
+
+static uint64_t xxh64(const char* text) {
+    return xxh64(text, std::strlen(text));
+}
+
+// An 8-bit grayscale PGM with a gradient, so no two sizes share content
+static std::vector<uint8_t> make_pgm(int size, uint8_t offset) {
+    std::string header = "P5\n" + std::to_string(size) + " " + std::to_string(size) + "\n255\n";
+    std::vector<uint8_t> bytes(header.begin(), header.end());
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) bytes.push_back(static_cast<uint8_t>(x * 3 + y * 5 + offset));
+    }
+    return bytes;
+}
+
+static void write_file(const fs::path& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+int main() {
+    Logger::set_level(Logger::Level::ERROR);
+    
+    // Reference XXH64 vectors (seed 0)
+    CHECK_EQ(xxh64(""), 0xEF46DB3751D8E999ULL);
+    CHECK_EQ(xxh64("a"), 0xD24EC4F1A98C6E5BULL);
+    CHECK_EQ(xxh64("abc"), 0x44BC2CF5AD770999ULL);
+    CHECK_EQ(xxh64("Nobody inspects the spammish repetition"), 0xFBCEA83C8A378BF1ULL);
+    
+    // Several 32-byte stripes plus 8-, 4- and 1-byte tails, with and without a seed
+    std::vector<uint8_t> data(1000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<uint8_t>(i * 31 + 7);
+    CHECK_EQ(xxh64(data.data(), 100), 0xEFA0AD2D3E70C151ULL);
+    CHECK_EQ(xxh64(data.data(), data.size()), 0x99594F4828043D35ULL);
+    CHECK_EQ(xxh64(data.data(), data.size(), 2654435761ULL), 0xF8735CE614AEB002ULL);
+    
+    // Any chunking of the input gives the same digest, and digest() leaves the state usable
+    for (size_t chunk : {1u, 3u, 31u, 32u, 33u, 257u}) {
+        ContentHasher hasher;
+        for (size_t offset = 0; offset < data.size(); offset += chunk) {
+            hasher.update(data.data() + offset, std::min(chunk, data.size() - offset));
+            if (offset == 64) hasher.digest();
+        }
+        CHECK_EQ(hasher.digest(), 0x99594F4828043D35ULL);
+    }
+    
+    // FileManager: a load returns the hash of exactly the file's bytes, across several read chunks
+    const fs::path directory = fs::temp_directory_path() / ("test_content_hash_" + std::to_string(getpid()));
+    fs::create_directories(directory);
+    const std::vector<uint8_t> large = make_pgm(600, 0);     // Larger than one 256 KiB read chunk
+    const std::vector<uint8_t> small = make_pgm(150, 9);
+    write_file(directory / "a.png", large);
+    write_file(directory / "b.png", small);
+    write_file(directory / "c.png", large);
+    
+    uint64_t loaded = 0;
+    cv::Mat image = FileManager::load_image((directory / "a.png").string(), false, &loaded);
+    CHECK(!image.empty());
+    CHECK_EQ(image.rows, 600);
+    CHECK_EQ(loaded, xxh64(large.data(), large.size()));
+    CHECK_EQ(FileManager::hash_file((directory / "a.png").string()), loaded);
+    
+    // The cache hands back the hash of the bytes the cached image came from
+    uint64_t cached = 0;
+    FileManager::load_image((directory / "b.png").string(), true, &cached);
+    CHECK_EQ(cached, xxh64(small.data(), small.size()));
+    cached = 0;
+    FileManager::load_image((directory / "b.png").string(), true, &cached);
+    CHECK_EQ(cached, xxh64(small.data(), small.size()));
+    CHECK_EQ(FileManager::get_cache_statistics().cache_hits, static_cast<size_t>(1));
+    FileManager::clear_cache();
+    
+    // A read hashes the bytes it returns, so callers can skip known content before decoding
+    std::vector<uint8_t> bytes;
+    uint64_t read_hash = 0;
+    CHECK(FileManager::read_file((directory / "c.png").string(), bytes, read_hash));
+    CHECK(bytes == large);
+    CHECK_EQ(read_hash, loaded);
+    cv::Mat decoded = FileManager::decode_image(bytes, (directory / "c.png").string());
+    CHECK_EQ(decoded.rows, 600);
+    CHECK(!FileManager::read_file((directory / "missing.png").string(), bytes, read_hash));
+    
+    // A scan only lists files; nothing is read
+    std::vector<FileManager::FileInfo> files = FileManager::scan_directory(directory.string());
+    CHECK_EQ(files.size(), static_cast<size_t>(3));
+    for (const auto& file : files) {
+        CHECK(file.is_valid);
+        CHECK_EQ(file.content_hash, static_cast<uint64_t>(0));
+    }
+    
+    fs::remove_all(directory);
+    return TEST_RESULT();
+}
@@ -0,0 +1,106 @@
+// test_core_selection.cpp - Top-K core selection: suppression radius, ordering and secondary ROIs 
+#include "TestCheck.h"
+#include "core/CorePointDetector.h"
+#include "utils/Logger.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+using CorePoint = CorePointDetector::CorePoint;
+
+// Two identical whorls side by side on a flat background: every candidate on the
+// left has a mirror on the right with the same confidence
+static cv::Mat make_twin_whorls(int rows, int cols) {
+    const float centers[2][2] = {{110.0f, 150.0f}, {310.0f, 150.0f}};
+    cv::Mat image(rows, cols, CV_8U);
+    for (int y = 0; y < rows; ++y) {
+        uint8_t* row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < cols; ++x) {
+            float value = 128.0f;
+            for (const auto& center : centers) {
+                float radius = std::hypot(x - center[0], y - center[1]);
+                if (radius < 90.0f) value = 128.0f + 90.0f * std::sin(radius * 0.7f);
+            }
+            row[x] = static_cast<uint8_t>(value);
+        }
+    }
+    return image;
+}
+
+static CorePointDetector::DetectionResult detect(const cv::Mat& image, int max_core_points, float nms_radius) {
+    CorePointDetector::DetectionParams params;
+    params.max_core_points = max_core_points;
+    params.core_nms_radius = nms_radius;
+    CorePointDetector detector(params);
+    return detector.detect_core_point(image, "twins.png", 3);
+}
+
+static bool same_point(const CorePoint& a, const CorePoint& b) {
+    return a.x == b.x && a.y == b.y && a.confidence == b.confidence;
+}
+
+int main() {
+    Logger::set_level(Logger::Level::ERROR);
+    const cv::Mat image = make_twin_whorls(300, 420);
+    
+    const CorePointDetector::DetectionResult single = detect(image, 1, 48.0f);
+    CHECK(single.success);
+    CHECK_EQ(single.core_points.size(), static_cast<size_t>(1));
+    CHECK(single.secondary_rois.empty());
+    
+    for (float radius : {0.0f, 20.0f, 48.0f, 150.0f}) {
+        std::vector<CorePoint> previous;
+        for (int k : {2, 4, 8}) {
+            const CorePointDetector::DetectionResult result = detect(image, k, radius);
+            const std::vector<CorePoint>& cores = result.core_points;
+            CHECK(result.success);
+            CHECK(!cores.empty());
+            CHECK(cores.size() <= static_cast<size_t>(k));
+            CHECK(same_point(cores[0], single.core_points[0]));
+            
+            // One ROI per core, all tagged with the input
+            CHECK_EQ(result.secondary_rois.size(), cores.size() - 1);
+            for (const auto& roi : result.secondary_rois) {
+                CHECK_EQ(roi.filename, std::string("twins.png"));
+                CHECK_EQ(roi.file_index, 3);
+            }
+            
+            for (size_t i = 0; i < cores.size(); ++i) {
+                // Best first; equal confidences in scan order (top to bottom, then left to right)
+                if (i > 0) {
+                    CHECK(cores[i - 1].confidence >= cores[i].confidence);
+                    if (cores[i - 1].confidence == cores[i].confidence) {
+                        CHECK(cores[i - 1].y < cores[i].y || (cores[i - 1].y == cores[i].y && cores[i - 1].x < cores[i].x));
+                    }
+                }
+                
+                // No two reported cores closer than the suppression radius
+                for (size_t j = 0; j < i; ++j) {
+                    CHECK(std::hypot(cores[i].x - cores[j].x, cores[i].y - cores[j].y) >= radius);
+                }
+            }
+            
+            // Raising K only adds cores: the greedy pass accepts the same ones first
+            for (const CorePoint& core : previous) {
+                bool kept = false;
+                for (const CorePoint& other : cores) kept = kept || same_point(core, other);
+                CHECK(kept);
+            }
+            previous = cores;
+        }
+    }
+    
+    // The twins have identical cores, so two are reported as soon as K allows it
+    const CorePointDetector::DetectionResult twins = detect(image, 2, 48.0f);
+    CHECK_EQ(twins.core_points.size(), static_cast<size_t>(2));
+    CHECK_EQ(twins.core_points[0].confidence, twins.core_points[1].confidence);
+    CHECK_EQ(twins.core_points[1].x - twins.core_points[0].x, 200.0f);
+    
+    // A radius wider than the image suppresses everything but the best core
+    const CorePointDetector::DetectionResult wide = detect(image, 8, 1000.0f);
+    CHECK_EQ(wide.core_points.size(), static_cast<size_t>(1));
+    CHECK(same_point(wide.core_points[0], single.core_points[0]));
+    CHECK(wide.secondary_rois.empty());
+    
+    return TEST_RESULT();
+}
@@ -0,0 +1,305 @@
+// test_database_writer.cpp - Batches commit in write order and progress marks never run ahead 
+#include "TestCheck.h"
+#include "database/AddressIndex.h"
+#include "database/DatabaseWriter.h"
+#include "utils/Logger.h"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+static CorePointDetector::DetectionResult make_result(const std::string& filename, int index) {
+    CorePointDetector::DetectionResult result;
+    result.success = true;
+    result.core_points.emplace_back(60.0f + index % 7, 70.0f, 0.8f);
+    result.extracted_roi.filename = filename;
+    result.extracted_roi.file_index = index;
+    // Stripes of a per-input period, so stored addresses differ
+    for (int y = 0; y < 101; ++y) {
+        for (int x = 0; x < 101; ++x) {
+            result.extracted_roi.pixels[y][x] = static_cast<uint8_t>((x + y / 3) % (6 + index % 5) < 3 ? 40 : 210);
+        }
+    }
+    result.content_hash = 1000 + static_cast<uint64_t>(index);
+    return result;
+}
+
+static std::string input_name(int index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "input_%05d.png", index);
+    return name;
+}
+
+int main() {
+    Logger::set_level(Logger::Level::WARNING);
+    const std::string path = "/tmp/test_database_writer_" + std::to_string(getpid()) + ".db";
+    std::remove(path.c_str());
+    
+    DatabaseWriter::Config config;
+    config.database_path = path;
+    config.batch_size = 7;
+    const int inputs = 500;
+    
+    // One producer with a progress mark per input (every fifth input has no core)
+    {
+        DatabaseWriter writer;
+        CHECK(writer.open(config));
+        DatabaseWriter::RunProgress progress;
+        progress.run_key = "run";
+        for (int i = 0; i < inputs; ++i) {
+            progress.last_input = input_name(i);
+            progress.inputs_committed = i + 1;
+            CorePointDetector::DetectionResult result = i % 5 == 4 ? CorePointDetector::DetectionResult()
+                                                                   : make_result(input_name(i), i);
+            CHECK(writer.write(result, progress));
+            
+            // Queued rows count as present for duplicate screening
+            if (i % 5 != 4) CHECK(writer.contains_content(1000 + static_cast<uint64_t>(i)));
+        }
+        CHECK(writer.flush());
+        CHECK_EQ(writer.pending_count(), static_cast<size_t>(0));
+        writer.close();
+        CHECK(!writer.write(make_result("late.png", 0)));
+    }
+    
+    // Rows went in input order and the stored mark is the last input
+    {
+        SQLiteAdapter db;
+        CHECK(db.open(path));
+        SQLiteStatement rows;
+        CHECK(db.prepare(rows, "SELECT file_index FROM rois ORDER BY id;"));
+        int count = 0, previous = -1;
+        bool ordered = true;
+        while (rows.step() == SQLITE_ROW) {
+            int index = rows.column_int(0);
+            ordered = ordered && index > previous;
+            previous = index;
+            count++;
+        }
+        CHECK_EQ(count, inputs - inputs / 5);
+        CHECK(ordered);
+        rows.finalize();
+        db.close();
+        
+        DatabaseWriter writer;
+        CHECK(writer.open(config));
+        DatabaseWriter::RunProgress committed;
+        CHECK(writer.load_progress("run", committed));
+        CHECK_EQ(committed.last_input, input_name(inputs - 1));
+        CHECK_EQ(committed.inputs_committed, static_cast<int64_t>(inputs));
+        writer.close();
+    }
+    
+    // Results are stored with their address (and key) and feature vector, so prefix
+    // range scans find them
+    {
+        SQLiteAdapter db;
+        CHECK(db.open(path));
+        SQLiteStatement described;
+        CHECK(db.prepare(described, "SELECT COUNT(*), MIN(address) FROM rois WHERE address_key IS NOT NULL "
+                                    "AND length(feature_vector) = ?1;"));
+        described.bind_int64(1, FeatureExtractor::FeatureVector::DIM * sizeof(float));
+        CHECK(described.step() == SQLITE_ROW);
+        CHECK_EQ(described.column_int64(0), static_cast<int64_t>(inputs - inputs / 5));
+        const std::string prefix = described.column_text(1).substr(0, 3);
+        described.finalize();
+        
+        SQLiteStatement expected;
+        CHECK(db.prepare(expected, "SELECT COUNT(*) FROM rois WHERE substr(address, 1, 3) = ?1;"));
+        expected.bind_text(1, prefix);
+        CHECK(expected.step() == SQLITE_ROW);
+        const int64_t with_prefix = expected.column_int64(0);
+        expected.finalize();
+        db.close();
+        
+        AddressIndex index;
+        CHECK(index.open(path));
+        std::vector<AddressIndex::Match> matches;
+        CHECK(index.find_prefix(prefix, matches));
+        CHECK(with_prefix > 0);
+        CHECK_EQ(static_cast<int64_t>(matches.size()), with_prefix);
+        CHECK_EQ(index.count_prefix(prefix), with_prefix);
+        index.close();
+    }
+    
+    // Concurrent producers: nothing lost
+    {
+        DatabaseWriter writer;
+        CHECK(writer.open(config));
+        std::atomic<int> failures{0};
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&writer, &failures, t]() {
+                for (int i = 0; i < 250; ++i) {
+                    int index = 10000 + t * 1000 + i;
+                    if (!writer.write(make_result(input_name(index), index))) failures++;
+                }
+            });
+        }
+        for (auto& producer : producers) producer.join();
+        CHECK_EQ(failures.load(), 0);
+        CHECK(writer.flush());
+        DatabaseWriter::WriterStats stats = writer.get_stats();
+        CHECK_EQ(stats.rows_written, static_cast<size_t>(1000));
+        CHECK_EQ(stats.failed_transactions, static_cast<size_t>(0));
+        writer.close();
+    }
+    
+    // A mark is stored only by the transaction that commits its batch: pending marks
+    // are invisible, and a mark with no rows of its own waits for flush()
+    {
+        std::remove(path.c_str());
+        DatabaseWriter writer;
+        CHECK(writer.open(config));
+        DatabaseWriter::RunProgress progress, committed;
+        progress.run_key = "marks";
+        for (int i = 0; i < 10; ++i) {
+            progress.last_input = input_name(i);
+            progress.inputs_committed = i + 1;
+            CHECK(writer.write(make_result(input_name(i), i), progress));
+            if (i < 6) CHECK(!writer.load_progress("marks", committed));
+        }
+        CHECK(writer.load_progress("marks", committed));     // The first batch of 7
+        CHECK_EQ(committed.last_input, input_name(6));
+        CHECK_EQ(committed.inputs_committed, static_cast<int64_t>(7));
+        
+        progress.last_input = input_name(10);
+        progress.inputs_committed = 11;
+        CHECK(writer.write(CorePointDetector::DetectionResult(), progress));
+        CHECK(writer.load_progress("marks", committed));
+        CHECK_EQ(committed.inputs_committed, static_cast<int64_t>(7));
+        
+        CHECK(writer.flush());
+        CHECK(writer.load_progress("marks", committed));
+        CHECK_EQ(committed.last_input, input_name(10));
+        CHECK_EQ(committed.inputs_committed, static_cast<int64_t>(11));
+        writer.close();
+    }
+    
+    // A failed transaction: the stored mark stays at the last batch committed before
+    // it, so a resumed run starts at the first input whose rows were lost
+    {
+        std::remove(path.c_str());
+        DatabaseWriter writer;
+        CHECK(writer.open(config));
+        writer.close();
+        
+        SQLiteAdapter db;
+        CHECK(db.open(path));
+        CHECK(db.exec("CREATE TRIGGER fail_one BEFORE INSERT ON rois WHEN NEW.file_index = 123 "
+                      "BEGIN SELECT RAISE(ABORT, 'injected'); END;"));
+        db.close();
+        
+        Logger::set_level(Logger::Level::ERROR);
+        CHECK(writer.open(config));
+        DatabaseWriter::RunProgress progress;
+        progress.run_key = "run";
+        int failed_writes = 0;
+        for (int i = 0; i < 300; ++i) {
+            progress.last_input = input_name(i);
+            progress.inputs_committed = i + 1;
+            if (!writer.write(make_result(input_name(i), i), progress)) failed_writes++;
+        }
+        CHECK_EQ(failed_writes, 1);     // Only the write that committed the bad batch
+        CHECK(writer.flush());
+        
+        // Batches of 7: input 123 is in the batch of inputs 119..125
+        DatabaseWriter::RunProgress committed;
+        CHECK(writer.load_progress("run", committed));
+        CHECK_EQ(committed.last_input, input_name(118));
+        CHECK_EQ(committed.inputs_committed, static_cast<int64_t>(119));
+        writer.close();
+        
+        // The mark survives the writer: a new run resumes at input 119
+        CHECK(writer.open(config));
+        CHECK(writer.load_progress("run", committed));
+        CHECK_EQ(committed.inputs_committed, static_cast<int64_t>(119));
+        writer.close();
+        Logger::set_level(Logger::Level::WARNING);
+        
+        CHECK(db.open(path));
+        SQLiteStatement covered;
+        CHECK(db.prepare(covered, "SELECT COUNT(*) FROM rois WHERE file_index < ?1;"));
+        covered.bind_int64(1, committed.inputs_committed);
+        CHECK(covered.step() == SQLITE_ROW);
+        CHECK_EQ(covered.column_int64(0), committed.inputs_committed);
+        covered.finalize();
+        db.close();
+    }
+    
+    // An interrupted bulk load resumes after its last mark: rows of the torn transaction
+    // are discarded, committed content is found without the content_hash index, and
+    // finish_bulk_load() rebuilds the indexes
+    {
+        std::remove(path.c_str());
+        std::remove((path + "-wal").c_str());
+        DatabaseWriter::Config bulk_config = config;
+        bulk_config.bulk_load = true;
+        
+        DatabaseWriter writer;
+        CHECK(writer.open(bulk_config));
+        CHECK(!writer.resumed_bulk_load());
+        DatabaseWriter::RunProgress progress;
+        progress.run_key = "bulk";
+        for (int i = 0; i < 100; ++i) {
+            int index = (i * 37) % 100;     // A permutation of 0..99
+            progress.last_input = input_name(index);
+            progress.inputs_committed = i + 1;
+            CHECK(writer.write(make_result(input_name(index), index), progress));
+        }
+        CHECK(writer.flush());
+        CHECK(writer.contains_content(1000));
+        CHECK(!writer.contains_content(5000));
+        writer.close();                     // No finish_bulk_load(): the load is unfinished
+        
+        // What a crash mid-transaction leaves behind: rows past the last mark
+        SQLiteAdapter db;
+        CHECK(db.open(path));
+        CHECK(db.exec("INSERT INTO rois (filename, file_index, core_rank, core_x, core_y, confidence, quality, "
+                      "rotation, processing_time_us, roi, content_hash) "
+                      "VALUES ('torn.png', 100, 0, 0, 0, 0, 0, 0, 0, x'00', 5000);"));
+        db.close();
+        
+        CHECK(writer.open(bulk_config));
+        CHECK(writer.resumed_bulk_load());
+        CHECK(!writer.contains_content(5000));
+        CHECK(writer.contains_content(1099));
+        DatabaseWriter::RunProgress resumed;
+        CHECK(writer.load_progress("bulk", resumed));
+        CHECK_EQ(resumed.inputs_committed, static_cast<int64_t>(100));
+        
+        // Rows without a mark still get the anonymous one
+        CHECK(writer.write(make_result(input_name(100), 100)));
+        CHECK(writer.flush());
+        CHECK(writer.contains_content(1100));
+        CHECK(writer.finish_bulk_load());
+        CHECK(!writer.is_bulk_loading());
+        CHECK(writer.contains_content(1100));
+        writer.close();
+        
+        CHECK(db.open(path));
+        SQLiteStatement count;
+        CHECK(db.prepare(count, "SELECT (SELECT COUNT(*) FROM rois), (SELECT COUNT(*) FROM rois WHERE filename = 'torn.png'), "
+                                "(SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name LIKE 'idx_rois_%'), "
+                                "(SELECT COUNT(*) FROM run_progress);"));
+        CHECK(count.step() == SQLITE_ROW);
+        CHECK_EQ(count.column_int64(0), static_cast<int64_t>(101));
+        CHECK_EQ(count.column_int64(1), static_cast<int64_t>(0));
+        CHECK_EQ(count.column_int64(2), static_cast<int64_t>(3));
+        CHECK_EQ(count.column_int64(3), static_cast<int64_t>(1));     // Only the run's own mark
+        count.finalize();
+        db.close();
+        
+        // A finished load is not resumed; the next bulk load starts fresh
+        CHECK(writer.open(bulk_config));
+        CHECK(!writer.resumed_bulk_load());
+        CHECK(writer.contains_content(1050));
+        writer.close();
+    }
+    
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+    return TEST_RESULT();
+}
@@ -0,0 +1,198 @@
+// test_detection_protocol.cpp - Request/response framing between DetectionClient and DetectionServer 
+#include "TestCheck.h"
+#include "ipc/DetectionClient.h"
+#include "ipc/DetectionServer.h"
+#include "utils/Logger.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using Protocol = DetectionProtocol;
+
+// Concentric ridges on a flat background: one core at the centre
+static std::vector<uint8_t> make_whorl(int width, int height, float center_x, float center_y, float period) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height, 128);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float radius = std::hypot(x - center_x, y - center_y);
+            if (radius < 90.0f) {
+                pixels[static_cast<size_t>(y) * width + x] =
+                    static_cast<uint8_t>(128.0f + 90.0f * std::sin(radius * 6.2831853f / period));
+            }
+        }
+    }
+    return pixels;
+}
+
+static std::vector<uint8_t> make_pgm(const std::vector<uint8_t>& pixels, int width, int height) {
+    std::string header = "P5\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    std::vector<uint8_t> bytes(header.begin(), header.end());
+    bytes.insert(bytes.end(), pixels.begin(), pixels.end());
+    return bytes;
+}
+
+static int connect_raw(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// One request on an open connection; the answer's status, or 255 if none came back
+static uint8_t exchange(int fd, const Protocol::RequestHeader& header, const void* payload, size_t size) {
+    Protocol::ResponseHeader response;
+    if (!Protocol::send_all(fd, &header, sizeof(header)) || (size > 0 && !Protocol::send_all(fd, payload, size)) ||
+        !Protocol::recv_all(fd, &response, sizeof(response)) || response.magic != Protocol::RESPONSE_MAGIC) {
+        return 255;
+    }
+    std::vector<uint8_t> rest(response.payload_size);
+    return Protocol::recv_all(fd, rest.data(), rest.size()) ? response.status : 255;
+}
+
+// Whether the server has hung up on the connection
+static bool hung_up(int fd) {
+    char byte;
+    return recv(fd, &byte, 1, 0) == 0;
+}
+
+static Protocol::RequestHeader make_header(uint8_t format, uint32_t payload_size) {
+    Protocol::RequestHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = Protocol::REQUEST_MAGIC;
+    header.version = Protocol::VERSION;
+    header.format = format;
+    header.payload_size = payload_size;
+    return header;
+}
+
+int main() {
+    Logger::set_level(Logger::Level::ERROR);
+    const std::string socket_path = "/tmp/test_detection_protocol_" + std::to_string(getpid()) + ".sock";
+    
+    DetectionServer server;
+    DetectionServer::Config config;
+    config.socket_path = socket_path;
+    config.worker_count = 2;
+    config.max_payload_bytes = 1 << 20;
+    CHECK(server.start(config));
+    
+    const int width = 300, height = 320;
+    const std::vector<uint8_t> whorl = make_whorl(width, height, 150.0f, 160.0f, 9.0f);
+    const std::vector<uint8_t> other = make_whorl(width, height, 140.0f, 150.0f, 13.0f);
+    const std::vector<uint8_t> flat(static_cast<size_t>(width) * height, 128);
+    
+    // Several requests on one connection, answered in order
+    {
+        DetectionClient client;
+        CHECK(client.connect(socket_path));
+        DetectionClient::Response response;
+        
+        CHECK(client.detect_raw(whorl.data(), width, height, response, true));
+        CHECK_EQ(response.status, static_cast<uint8_t>(Protocol::STATUS_OK));
+        CHECK(!response.cores.empty());
+        CHECK_EQ(response.rois.size(), response.cores.size() * Protocol::ROI_BYTES);
+        CHECK(std::fabs(response.cores[0].x - 150.0f) < 12.0f);
+        CHECK(response.error_message.empty());
+        
+        CHECK(client.detect_raw(flat.data(), width, height, response));
+        CHECK_EQ(response.status, static_cast<uint8_t>(Protocol::STATUS_NO_CORE));
+        CHECK(response.cores.empty());
+        CHECK(response.rois.empty());
+        
+        // Encoded payloads go through the image decoder
+        std::vector<uint8_t> encoded = make_pgm(whorl, width, height);
+        CHECK(client.detect_encoded(encoded.data(), encoded.size(), response));
+        CHECK_EQ(response.status, static_cast<uint8_t>(Protocol::STATUS_OK));
+        CHECK(response.rois.empty());
+        
+        const char garbage[] = "not an image";
+        CHECK(client.detect_encoded(garbage, sizeof(garbage), response));
+        CHECK_EQ(response.status, static_cast<uint8_t>(Protocol::STATUS_DECODE_FAILED));
+        CHECK(!response.error_message.empty());
+        
+        CHECK(client.is_connected());
+    }
+    
+    // Duplicate screening only among requests that ask for it
+    {
+        DetectionClient client;
+        CHECK(client.connect(socket_path));
+        DetectionClient::Response response;
+        
+        CHECK(client.detect_raw(whorl.data(), width, height, response, false, true));
+        CHECK_EQ(response.status, static_cast<uint8_t>(Protocol::STATUS_OK));
+        CHECK(client.detect_raw(whorl.data(), width, height, response, true, true));
+        CHECK_EQ(response.status, static_cast<uint8_t>(Protocol::STATUS_DUPLICATE));
+        CHECK(response.found());
+        CHECK(response.duplicate());
+        CHECK_EQ(response.rois.size(), response.cores.size() * Protocol::ROI_BYTES);
+        CHECK(response.error_message.find("Near-duplicate of request") == 0);
+        
+        CHECK(client.detect_raw(whorl.data(), width, height, response));
+        CHECK_EQ(response.status, static_cast<uint8_t>(Protocol::STATUS_OK));
+        CHECK(client.detect_raw(other.data(), width, height, response, false, true));
+        CHECK_EQ(response.status, static_cast<uint8_t>(Protocol::STATUS_OK));
+    }
+    
+    // A raw size mismatch is a bad request, but the payload was framed, so the
+    // connection stays usable
+    {
+        int fd = connect_raw(socket_path);
+        CHECK(fd >= 0);
+        Protocol::RequestHeader header = make_header(Protocol::FORMAT_RAW, static_cast<uint32_t>(whorl.size()));
+        header.width = width;
+        header.height = height - 1;
+        CHECK_EQ(exchange(fd, header, whorl.data(), whorl.size()), static_cast<uint8_t>(Protocol::STATUS_BAD_REQUEST));
+        header.height = height;
+        CHECK_EQ(exchange(fd, header, whorl.data(), whorl.size()), static_cast<uint8_t>(Protocol::STATUS_OK));
+        close(fd);
+    }
+    
+    // Unframeable headers are answered, then the connection is closed
+    Protocol::RequestHeader bad_headers[4];
+    bad_headers[0] = make_header(Protocol::FORMAT_RAW, 16);
+    bad_headers[0].magic = 0x12345678;
+    bad_headers[1] = make_header(Protocol::FORMAT_RAW, 16);
+    bad_headers[1].version = Protocol::VERSION + 1;
+    bad_headers[2] = make_header(7, 16);
+    bad_headers[3] = make_header(Protocol::FORMAT_ENCODED, config.max_payload_bytes + 1);
+    for (int i = 0; i < 4; ++i) {
+        int fd = connect_raw(socket_path);
+        CHECK(fd >= 0);
+        uint8_t expected = i == 3 ? Protocol::STATUS_TOO_LARGE : Protocol::STATUS_BAD_REQUEST;
+        CHECK_EQ(exchange(fd, bad_headers[i], nullptr, 0), expected);
+        CHECK(hung_up(fd));
+        close(fd);
+    }
+    
+    // The client reports a too-large request as a status, not a transport failure
+    {
+        DetectionClient client;
+        CHECK(client.connect(socket_path));
+        std::vector<uint8_t> large(config.max_payload_bytes + 1, 0);
+        DetectionClient::Response response;
+        CHECK(client.detect_encoded(large.data(), large.size(), response));
+        CHECK_EQ(response.status, static_cast<uint8_t>(Protocol::STATUS_TOO_LARGE));
+        CHECK(!client.is_connected());
+    }
+    
+    server.stop();
+    DetectionServer::ServerStats stats = server.get_stats();
+    CHECK_EQ(stats.duplicates, static_cast<uint64_t>(1));
+    CHECK_EQ(stats.requests, static_cast<uint64_t>(15));
+    CHECK_EQ(stats.cores_found, static_cast<uint64_t>(7));
+    CHECK_EQ(stats.requests_failed, static_cast<uint64_t>(7));     // Undecodable, mismatched, unframeable, too large
+    CHECK(access(socket_path.c_str(), F_OK) != 0);      // stop() removes the socket file
+    
+    return TEST_RESULT();
+}
@@ -0,0 +1,118 @@
+// test_detector_allocations.cpp - A warm detect_core_point performs no heap allocation 
+#include "TestCheck.h"
+#include "core/CorePointDetector.h"
+#include "utils/Logger.h"
+#include "utils/Timer.h"
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+// Every operator new in the process goes through these counters
+static std::atomic<size_t> allocation_count{0};
+
+static void* counted_alloc(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// Concentric ridges (a whorl: the orientation field turns a full circle around the
+// centre) with a little deterministic noise, on a flat background so the only
+// orientation singularity is the centre
+static cv::Mat make_whorl(int rows, int cols, float center_x, float center_y, float extent, uint32_t seed) {
+    cv::Mat image(rows, cols, CV_8U);
+    for (int y = 0; y < rows; ++y) {
+        uint8_t* row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < cols; ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            float radius = std::hypot(x - center_x, y - center_y);
+            float value = 128.0f;
+            if (radius < extent) {
+                value += 90.0f * std::sin(radius * 0.7f) + static_cast<float>((seed >> 24) % 9) - 4.0f;
+            }
+            row[x] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value)));
+        }
+    }
+    return image;
+}
+
+static size_t count_allocations(CorePointDetector& detector, const cv::Mat& image,
+                                CorePointDetector::DetectionResult& result, const std::string& filename, int calls) {
+    size_t before = allocation_count.load();
+    for (int i = 0; i < calls; ++i) {
+        detector.detect_core_point(image, result, filename, i);
+    }
+    return allocation_count.load() - before;
+}
+
+int main() {
+    Logger::set_level(Logger::Level::WARNING);
+    
+    // Long enough to defeat the small-string optimization on the ROI filename copy
+    const std::string filename = "fingerprint_capture_with_a_long_name_0001.png";
+    const cv::Mat large = make_whorl(320, 300, 150.0f, 160.0f, 90.0f, 1);
+    const cv::Mat small = make_whorl(240, 260, 130.0f, 120.0f, 65.0f, 2);
+    
+    CorePointDetector::DetectionParams params;
+    params.use_simd = false;                // Both code paths must hold; SIMD is covered below
+    CorePointDetector scalar_detector(params);
+    CorePointDetector detector;
+    CorePointDetector::DetectionResult result;
+    
+    // Warm-up: the thread workspace and the result grow to the largest image once
+    detector.detect_core_point(large, result, filename, 0);
+    CHECK(result.success);
+    CHECK_EQ(result.core_points.size(), static_cast<size_t>(1));
+    CHECK_EQ(result.extracted_roi.filename, filename);
+    detector.detect_core_point(small, result, filename, 0);
+    CHECK(result.success);
+    scalar_detector.detect_core_point(large, result, filename, 0);
+    
+    CHECK_EQ(count_allocations(detector, large, result, filename, 20), static_cast<size_t>(0));
+    CHECK_EQ(count_allocations(detector, small, result, filename, 20), static_cast<size_t>(0));
+    CHECK_EQ(count_allocations(scalar_detector, large, result, filename, 20), static_cast<size_t>(0));
+    CHECK(result.success);
+    
+    // Profiling uses the fixed stage tables, so it stays allocation-free as well
+    Timer::profile_start("allocation_test_stage_with_a_long_name");
+    Timer::profile_stop("allocation_test_stage_with_a_long_name");
+    size_t before = allocation_count.load();
+    Timer::profile_start("allocation_test_stage_with_a_long_name");
+    Timer::profile_stop("allocation_test_stage_with_a_long_name");
+    CHECK_EQ(allocation_count.load() - before, static_cast<size_t>(0));
+    
+    // The counters do see allocations: a fresh result has to grow its vectors
+    before = allocation_count.load();
+    CorePointDetector::DetectionResult fresh = detector.detect_core_point(large, filename, 0);
+    CHECK(fresh.success);
+    CHECK(allocation_count.load() - before > 0);
+    
+    CorePointDetector::ProcessingStats stats = detector.get_processing_stats();
+    CHECK_EQ(stats.total_images_processed, static_cast<size_t>(43));
+    CHECK_EQ(stats.successful_detections, static_cast<size_t>(43));
+    
+    // Results reused after a success must not keep stale cores when a later image fails
+    cv::Mat flat(200, 200, CV_8U, cv::Scalar(128));
+    detector.detect_core_point(flat, result, filename, 7);
+    CHECK(!result.success);
+    CHECK(result.core_points.empty());
+    CHECK(!result.error_message.empty());
+    
+    return TEST_RESULT();
+}
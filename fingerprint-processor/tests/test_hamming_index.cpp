@@ -0,0 +1,132 @@
+// test_hamming_index.cpp - ROI hashes of repeat captures stay close; index lookups match a linear scan 
+#include "TestCheck.h"
+#include "core/RoiHasher.h"
+#include "database/HammingIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using Hash = HammingIndex::Hash;
+
+static uint64_t next_random(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static Hash random_hash(uint64_t& state) {
+    Hash hash;
+    hash.bits[0] = next_random(state);
+    hash.bits[1] = next_random(state);
+    return hash;
+}
+
+// A copy of hash with exactly flips distinct bits changed
+static Hash flip_bits(const Hash& hash, int flips, uint64_t& state) {
+    Hash flipped = hash;
+    while (RoiHasher::distance(flipped, hash) < flips) {
+        int bit = static_cast<int>(next_random(state) % RoiHasher::HASH_BITS);
+        flipped.bits[bit >> 6] ^= 1ull << (bit & 63);
+        if (RoiHasher::distance(flipped, hash) > flips) flipped.bits[bit >> 6] ^= 1ull << (bit & 63);
+    }
+    return flipped;
+}
+
+// Ridges at the given period and angle, with brightness gain/offset and a sub-pixel shift
+static void make_roi(RoiHasher::ROI& roi, float period, float angle, float gain, float offset, float shift) {
+    for (int y = 0; y < 101; ++y) {
+        for (int x = 0; x < 101; ++x) {
+            float u = (x + shift) * std::cos(angle) + y * std::sin(angle);
+            float value = offset + gain * 90.0f * std::sin(u * 6.2831853f / period + 0.02f * (y - 50) * (y - 50) / period);
+            roi.pixels[y][x] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value)));
+        }
+    }
+}
+
+int main() {
+    // Repeat captures (re-exposed, shifted by half a pixel) hash within the duplicate
+    // distance; a different finger does not
+    RoiHasher::ROI original, recapture, shifted, other, flat;
+    make_roi(original, 9.0f, 0.3f, 1.0f, 128.0f, 0.0f);
+    make_roi(recapture, 9.0f, 0.3f, 0.8f, 140.0f, 0.0f);
+    make_roi(shifted, 9.0f, 0.3f, 1.0f, 128.0f, 0.5f);
+    make_roi(other, 13.0f, 1.2f, 1.0f, 128.0f, 0.0f);
+    std::memset(flat.pixels, 128, sizeof(flat.pixels));
+    
+    const Hash base = RoiHasher::compute(original);
+    CHECK(!base.empty());
+    CHECK(RoiHasher::compute(original) == base);
+    CHECK(RoiHasher::distance(base, RoiHasher::compute(recapture)) <= RoiHasher::DUPLICATE_DISTANCE);
+    CHECK(RoiHasher::distance(base, RoiHasher::compute(shifted)) <= RoiHasher::DUPLICATE_DISTANCE);
+    CHECK(RoiHasher::distance(base, RoiHasher::compute(other)) > RoiHasher::DUPLICATE_DISTANCE);
+    CHECK(RoiHasher::compute(flat).empty());
+    
+    // The duplicate threshold is inclusive: DUPLICATE_DISTANCE bits away matches, one more does not
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    {
+        HammingIndex index;
+        index.add(7, base);
+        HammingIndex::Match match;
+        CHECK(index.find_nearest(flip_bits(base, RoiHasher::DUPLICATE_DISTANCE, state),
+                                 RoiHasher::DUPLICATE_DISTANCE, match));
+        CHECK_EQ(match.id, static_cast<int64_t>(7));
+        CHECK_EQ(match.distance, RoiHasher::DUPLICATE_DISTANCE);
+        CHECK(!index.find_nearest(flip_bits(base, RoiHasher::DUPLICATE_DISTANCE + 1, state),
+                                  RoiHasher::DUPLICATE_DISTANCE, match));
+        
+        // check_and_add adds only what it does not match
+        CHECK(index.check_and_add(8, flip_bits(base, 3, state), match));
+        CHECK_EQ(match.id, static_cast<int64_t>(7));
+        CHECK_EQ(index.size(), static_cast<size_t>(1));
+        CHECK(!index.check_and_add(9, flip_bits(base, 40, state), match));
+        CHECK_EQ(index.size(), static_cast<size_t>(2));
+    }
+    
+    // Multi-index lookups find exactly what a linear scan finds, for radii served by
+    // the chunk tables and for larger radii that fall back to a scan
+    HammingIndex index;
+    std::vector<Hash> stored;
+    for (int i = 0; i < 3000; ++i) {
+        // Clusters of near copies, so every radius has neighbours to find
+        Hash hash = i % 4 == 0 ? random_hash(state) : flip_bits(stored[i - i % 4], 2 + i % 13, state);
+        stored.push_back(hash);
+        index.add(i, hash);
+    }
+    CHECK_EQ(index.size(), stored.size());
+    
+    const int radii[] = {0, 4, RoiHasher::DUPLICATE_DISTANCE, HammingIndex::MAX_INDEXED_DISTANCE,
+                         HammingIndex::MAX_INDEXED_DISTANCE + 6};
+    int mismatches = 0, found = 0;
+    for (int q = 0; q < 200; ++q) {
+        Hash query = flip_bits(stored[(q * 37) % stored.size()], q % 20, state);
+        for (int radius : radii) {
+            std::vector<HammingIndex::Match> matches = index.find_within(query, radius);
+            
+            std::vector<std::pair<int, int64_t>> expected, actual;
+            for (size_t i = 0; i < stored.size(); ++i) {
+                int distance = RoiHasher::distance(stored[i], query);
+                if (distance <= radius) expected.emplace_back(distance, static_cast<int64_t>(i));
+            }
+            for (size_t m = 0; m < matches.size(); ++m) {
+                actual.emplace_back(matches[m].distance, matches[m].id);
+                if (m > 0 && matches[m].distance < matches[m - 1].distance) mismatches++;     // Closest first
+            }
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            if (actual != expected) mismatches++;
+            found += static_cast<int>(matches.size());
+            
+            HammingIndex::Match nearest;
+            bool any = index.find_nearest(query, radius, nearest);
+            CHECK_EQ(any, !expected.empty());
+            if (any) CHECK_EQ(nearest.distance, expected.front().first);
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK(found > 0);
+    
+    return TEST_RESULT();
+}
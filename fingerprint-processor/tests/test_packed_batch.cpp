@@ -0,0 +1,108 @@
+// test_packed_batch.cpp - Packed detect_batch gives the same results as per-image detect_core_point 
+#include "TestCheck.h"
+#include "core/CorePointDetector.h"
+#include "utils/Logger.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using DetectionResult = CorePointDetector::DetectionResult;
+
+// Concentric ridges around (center_x, center_y) with deterministic noise, on a flat background
+static cv::Mat make_whorl(int rows, int cols, float center_x, float center_y, float period, uint32_t seed) {
+    cv::Mat image(rows, cols, CV_8U);
+    for (int y = 0; y < rows; ++y) {
+        uint8_t* row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < cols; ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            float radius = std::hypot(x - center_x, y - center_y);
+            float value = 128.0f + static_cast<float>((seed >> 24) % 9) - 4.0f;
+            if (radius < 100.0f) value += 90.0f * std::sin(radius * 6.2831853f / period);
+            row[x] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value)));
+        }
+    }
+    return image;
+}
+
+static bool same_roi(const CorePointDetector::ROI& a, const CorePointDetector::ROI& b) {
+    return a.filename == b.filename && a.file_index == b.file_index &&
+           std::memcmp(a.pixels, b.pixels, sizeof(a.pixels)) == 0;
+}
+
+// Everything detection reports except timing
+static void check_same(const DetectionResult& packed, const DetectionResult& single) {
+    CHECK_EQ(packed.success, single.success);
+    CHECK_EQ(packed.error_message, single.error_message);
+    CHECK_EQ(packed.overall_quality, single.overall_quality);
+    CHECK_EQ(packed.core_points.size(), single.core_points.size());
+    for (size_t i = 0; i < packed.core_points.size() && i < single.core_points.size(); ++i) {
+        CHECK_EQ(packed.core_points[i].x, single.core_points[i].x);
+        CHECK_EQ(packed.core_points[i].y, single.core_points[i].y);
+        CHECK_EQ(packed.core_points[i].confidence, single.core_points[i].confidence);
+    }
+    if (single.success) CHECK(same_roi(packed.extracted_roi, single.extracted_roi));
+    CHECK_EQ(packed.secondary_rois.size(), single.secondary_rois.size());
+    for (size_t i = 0; i < packed.secondary_rois.size() && i < single.secondary_rois.size(); ++i) {
+        CHECK(same_roi(packed.secondary_rois[i], single.secondary_rois[i]));
+    }
+    
+    const CorePointDetector::OrientationBlocks& a = packed.orientation_blocks;
+    const CorePointDetector::OrientationBlocks& b = single.orientation_blocks;
+    CHECK_EQ(a.rows, b.rows);
+    CHECK_EQ(a.cols, b.cols);
+    CHECK(a.angle == b.angle);
+    CHECK(a.coherence == b.coherence);
+    CHECK(a.energy == b.energy);
+    CHECK_EQ(packed.singular_points.size(), single.singular_points.size());
+}
+
+int main() {
+    Logger::set_level(Logger::Level::ERROR);
+    
+    // Five same-size images (split over two packs of three), one of another size,
+    // one too flat to pass the quality gate and one too small to pack
+    std::vector<cv::Mat> images;
+    std::vector<std::string> filenames;
+    const float centers[5][2] = {{150, 160}, {120, 140}, {180, 200}, {160, 110}, {140, 170}};
+    for (int i = 0; i < 5; ++i) {
+        images.push_back(make_whorl(320, 300, centers[i][0], centers[i][1], 8.0f + i, 17u + i));
+    }
+    images.push_back(make_whorl(280, 340, 170.0f, 140.0f, 10.0f, 99u));
+    images.push_back(cv::Mat(320, 300, CV_8U, cv::Scalar(128)));
+    images.push_back(make_whorl(90, 90, 45.0f, 45.0f, 9.0f, 5u));
+    for (size_t i = 0; i < images.size(); ++i) filenames.push_back("input_" + std::to_string(i) + ".png");
+    
+    struct Mode { bool align; bool blocks; int max_cores; };
+    const Mode modes[] = {{false, false, 1}, {true, true, 1}, {true, false, 3}};
+    
+    int found = 0;
+    for (const Mode& mode : modes) {
+        CorePointDetector::DetectionParams params;
+        params.align_roi_orientation = mode.align;
+        params.export_orientation_blocks = mode.blocks;
+        params.max_core_points = mode.max_cores;
+        
+        CorePointDetector single_detector(params);
+        std::vector<DetectionResult> expected(images.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+            single_detector.detect_core_point(images[i], expected[i], filenames[i], static_cast<int>(i));
+            found += expected[i].success;
+        }
+        
+        params.packed_batch_size = 3;
+        CorePointDetector packed_detector(params);
+        for (bool parallel : {false, true}) {
+            std::vector<DetectionResult> results = packed_detector.detect_batch(images, filenames, parallel);
+            CHECK_EQ(results.size(), images.size());
+            for (size_t i = 0; i < results.size() && i < expected.size(); ++i) {
+                check_same(results[i], expected[i]);
+            }
+        }
+    }
+    
+    // The comparison means something only if most inputs produced cores
+    CHECK(found >= 12);
+    
+    return TEST_RESULT();
+}
@@ -0,0 +1,94 @@
+// test_pattern_classifier.cpp - Henry classes from singular-point layouts and from detected orientation fields 
+#include "TestCheck.h"
+#include "core/FeatureExtractor.h"
+#include "utils/Logger.h"
+#include <cmath>
+#include <vector>
+
+using PatternType = FeatureExtractor::PatternType;
+using SingularPoint = CorePointDetector::SingularPoint;
+
+// A uniform 10x10 block field (coherence 0.8) with the given singular points
+static CorePointDetector::DetectionResult make_layout(const std::vector<SingularPoint>& points) {
+    CorePointDetector::DetectionResult result;
+    CorePointDetector::OrientationBlocks& blocks = result.orientation_blocks;
+    blocks.block_size = 16;
+    blocks.cols = blocks.rows = 10;
+    blocks.angle.assign(100, 0.0f);
+    blocks.coherence.assign(100, 0.8f);
+    blocks.energy.assign(100, 50.0f);
+    result.singular_points = points;
+    return result;
+}
+
+static PatternType classify(const std::vector<SingularPoint>& points) {
+    return FeatureExtractor::classify_pattern(make_layout(points)).type;
+}
+
+// Synthetic prints: concentric ridges (whorl) or ridges bowed upwards in the middle (arch)
+static cv::Mat make_print(bool whorl) {
+    cv::Mat image(320, 300, CV_8U);
+    for (int y = 0; y < image.rows; ++y) {
+        for (int x = 0; x < image.cols; ++x) {
+            float phase = whorl ? std::hypot(x - 150.0f, y - 160.0f)
+                                : y + 25.0f * std::exp(-(x - 150.0f) * (x - 150.0f) / 4000.0f);
+            image.at<uint8_t>(y, x) = static_cast<uint8_t>(128.0f + 90.0f * std::sin(phase * 0.7f));
+        }
+    }
+    return image;
+}
+
+int main() {
+    Logger::set_level(Logger::Level::ERROR);
+    
+    // Decision rules on hand-made layouts
+    CHECK(classify({}) == PatternType::ARCH);
+    CHECK(classify({{80, 60, 2}, {40, 120, -1}, {120, 120, -1}}) == PatternType::WHORL);
+    CHECK(classify({{70, 60, 1}, {90, 70, 1}}) == PatternType::WHORL);             // Twin loop
+    CHECK(classify({{80, 60, 1}, {130, 110, -1}}) == PatternType::LEFT_LOOP);       // Delta right of the core
+    CHECK(classify({{80, 60, 1}, {30, 110, -1}}) == PatternType::RIGHT_LOOP);
+    CHECK(classify({{80, 60, 1}, {85, 130, -1}}) == PatternType::TENTED_ARCH);      // Delta below the core
+    CHECK(classify({{80, 60, 1}}) == PatternType::UNKNOWN);                         // Lone core
+    CHECK(classify({{40, 120, -1}}) == PatternType::UNKNOWN);                       // Lone delta
+    
+    // The nearest delta decides the loop side
+    CHECK(classify({{80, 60, 1}, {20, 150, -1}, {110, 90, -1}}) == PatternType::LEFT_LOOP);
+    
+    // Confidence: the block coherence, reduced when deltas are missing
+    FeatureExtractor::PatternClassification complete =
+        FeatureExtractor::classify_pattern(make_layout({{80, 60, 1}, {130, 110, -1}}));
+    FeatureExtractor::PatternClassification partial =
+        FeatureExtractor::classify_pattern(make_layout({{80, 60, 2}}));
+    CHECK(std::fabs(complete.confidence - 0.8f) < 1e-5f);
+    CHECK(std::fabs(partial.confidence - 0.6f) < 1e-5f);
+    CHECK_EQ(partial.cores, 2);
+    CHECK_EQ(partial.deltas, 0);
+    
+    // Without exported blocks there is nothing to classify
+    CHECK(FeatureExtractor::classify_pattern(CorePointDetector::DetectionResult()).type == PatternType::UNKNOWN);
+    
+    // Detected orientation fields: a whorl centre is one singular point of index 2,
+    // even though rings through the centre block see only half its turn
+    CorePointDetector::DetectionParams params;
+    params.export_orientation_blocks = true;
+    CorePointDetector detector(params);
+    
+    CorePointDetector::DetectionResult result = detector.detect_core_point(make_print(true), "whorl.png", 0);
+    CHECK_EQ(result.singular_points.size(), static_cast<size_t>(1));
+    if (!result.singular_points.empty()) {
+        CHECK_EQ(result.singular_points[0].poincare_index, 2);
+        CHECK(std::hypot(result.singular_points[0].x - 150.0f, result.singular_points[0].y - 160.0f) < 16.0f);
+    }
+    FeatureExtractor::PatternClassification whorl = FeatureExtractor::classify_pattern(result);
+    CHECK(whorl.type == PatternType::WHORL);
+    CHECK_EQ(whorl.cores, 2);
+    CHECK(whorl.confidence > 0.5f);
+    
+    result = detector.detect_core_point(make_print(false), "arch.png", 1);
+    CHECK(result.singular_points.empty());
+    FeatureExtractor::PatternClassification arch = FeatureExtractor::classify_pattern(result);
+    CHECK(arch.type == PatternType::ARCH);
+    CHECK(arch.confidence > 0.9f);
+    
+    return TEST_RESULT();
+}
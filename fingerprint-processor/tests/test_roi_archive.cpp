@@ -0,0 +1,167 @@
+// test_roi_archive.cpp - Archives survive torn tails and failed appends, and reopen where they left off 
+#include "TestCheck.h"
+#include "database/RoiArchive.h"
+#include "utils/Logger.h"
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static CorePointDetector::DetectionResult make_result(const std::string& filename, int index, int cores) {
+    CorePointDetector::DetectionResult result;
+    result.success = true;
+    result.content_hash = 500 + static_cast<uint64_t>(index);
+    result.secondary_rois.resize(cores - 1);
+    for (int c = 0; c < cores; ++c) {
+        result.core_points.emplace_back(40.0f + c, 50.0f + index, 0.9f - 0.1f * c);
+        CorePointDetector::ROI& roi = c == 0 ? result.extracted_roi : result.secondary_rois[c - 1];
+        roi.filename = filename;
+        roi.file_index = index;
+        for (int y = 0; y < 101; ++y) {
+            for (int x = 0; x < 101; ++x) roi.pixels[y][x] = static_cast<uint8_t>(x * y + index * 7 + c);
+        }
+    }
+    return result;
+}
+
+static std::string name_of(int index) {
+    return "print_" + std::to_string(index) + ".png";
+}
+
+static void append_bytes(const std::string& path, size_t count) {
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    std::string garbage(count, '\x5A');
+    file.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+}
+
+// Every indexed file resolves to complete records with valid checksums
+static bool consistent(const std::string& path, size_t records, size_t files) {
+    RoiArchiveReader reader;
+    if (!reader.open(path) || reader.size() != records || reader.file_count() != files) return false;
+    for (size_t i = 0; i < reader.size(); ++i) {
+        if (!reader.verify(i)) return false;
+    }
+    return true;
+}
+
+int main() {
+    Logger::set_level(Logger::Level::ERROR);
+    const std::string path = "/tmp/test_roi_archive_" + std::to_string(getpid()) + ".frar";
+    const std::string idx_path = RoiArchive::index_path(path);
+    std::remove(path.c_str());
+    std::remove(idx_path.c_str());
+    
+    // Files 0-4 with 1, 2, 3, 1, 2 cores: 9 records
+    {
+        RoiArchiveWriter writer;
+        CHECK(writer.open(path));
+        for (int i = 0; i < 5; ++i) CHECK(writer.append(make_result(name_of(i), i, 1 + i % 3)));
+        CHECK(writer.append(CorePointDetector::DetectionResult()));     // No cores, nothing archived
+        CHECK(writer.flush());
+        CHECK_EQ(writer.get_stats().records, static_cast<uint64_t>(9));
+        writer.close();
+    }
+    CHECK_EQ(fs::file_size(path), static_cast<uintmax_t>(RoiArchive::HEADER_SIZE + 9 * RoiArchive::RECORD_SIZE));
+    CHECK(consistent(path, 9, 5));
+    
+    // Reopening continues the record numbering
+    {
+        RoiArchiveWriter writer;
+        CHECK(writer.open(path));
+        CHECK_EQ(writer.get_stats().records, static_cast<uint64_t>(9));
+        CHECK(writer.append(make_result(name_of(5), 5, 2)));
+        writer.close();
+    }
+    CHECK(consistent(path, 11, 6));
+    {
+        RoiArchiveReader reader;
+        CHECK(reader.open(path));
+        RoiArchiveReader::FileRange range = reader.find(name_of(5));
+        CHECK_EQ(range.first_record, static_cast<uint64_t>(9));
+        CHECK_EQ(range.record_count, static_cast<uint32_t>(2));
+        CHECK_EQ(reader.record(10).core_rank, static_cast<uint8_t>(1));
+        CHECK_EQ(reader.record(10).file_index, 5);
+    }
+    
+    // A crash mid-append: half a record and a torn index entry are trimmed on open
+    append_bytes(path, RoiArchive::RECORD_SIZE / 2);
+    append_bytes(idx_path, 10);
+    {
+        RoiArchiveWriter writer;
+        CHECK(writer.open(path));
+        CHECK_EQ(writer.get_stats().records, static_cast<uint64_t>(11));
+        CHECK(writer.append(make_result(name_of(6), 6, 1)));
+        writer.close();
+    }
+    CHECK(consistent(path, 12, 7));
+    
+    // Records lost with the archive tail take their index entries with them, so the
+    // record numbers are not reused under the old names
+    fs::resize_file(path, RoiArchive::HEADER_SIZE + 10 * RoiArchive::RECORD_SIZE + 100);
+    {
+        RoiArchiveWriter writer;
+        CHECK(writer.open(path));
+        CHECK_EQ(writer.get_stats().records, static_cast<uint64_t>(10));
+        writer.close();
+    }
+    CHECK(consistent(path, 10, 5));
+    {
+        RoiArchiveReader reader;
+        CHECK(reader.open(path));
+        CHECK_EQ(reader.find(name_of(5)).record_count, static_cast<uint32_t>(0));
+        CHECK_EQ(reader.find(name_of(6)).record_count, static_cast<uint32_t>(0));
+        CHECK_EQ(reader.find(name_of(4)).record_count, static_cast<uint32_t>(2));
+    }
+    
+    // Failed appends (the file size limit stops the archive write part way, or the index
+    // write after the records went in) leave both files and the stats as they were
+    {
+        RoiArchiveWriter writer;
+        CHECK(writer.open(path));
+        const uintmax_t archive_size = fs::file_size(path);
+        const uintmax_t index_size = fs::file_size(idx_path);
+        
+        std::signal(SIGXFSZ, SIG_IGN);
+        struct rlimit original;
+        CHECK(getrlimit(RLIMIT_FSIZE, &original) == 0);
+        struct rlimit limited = original;
+        limited.rlim_cur = archive_size + RoiArchive::RECORD_SIZE + RoiArchive::RECORD_SIZE / 2;
+        CHECK(setrlimit(RLIMIT_FSIZE, &limited) == 0);
+        
+        CHECK(!writer.append(make_result(name_of(7), 7, 2)));
+        CHECK_EQ(fs::file_size(path), archive_size);
+        
+        // A name longer than the limit allows in the index, with one record that fits
+        const std::string long_name(static_cast<size_t>(limited.rlim_cur), 'n');
+        CHECK(!writer.append(make_result(long_name, 8, 1)));
+        CHECK_EQ(fs::file_size(path), archive_size);
+        CHECK_EQ(fs::file_size(idx_path), index_size);
+        
+        CHECK(setrlimit(RLIMIT_FSIZE, &original) == 0);
+        std::signal(SIGXFSZ, SIG_DFL);
+        
+        RoiArchiveWriter::WriterStats stats = writer.get_stats();
+        CHECK_EQ(stats.records, static_cast<uint64_t>(10));
+        CHECK_EQ(stats.records_appended, static_cast<uint64_t>(0));
+        
+        // The writer stays usable and the next file gets the next record number
+        CHECK(writer.append(make_result(name_of(9), 9, 1)));
+        writer.close();
+    }
+    CHECK(consistent(path, 11, 6));
+    {
+        RoiArchiveReader reader;
+        CHECK(reader.open(path));
+        CHECK_EQ(reader.find(name_of(9)).first_record, static_cast<uint64_t>(10));
+        CHECK_EQ(reader.record(10).file_index, 9);
+    }
+    
+    std::remove(path.c_str());
+    std::remove(idx_path.c_str());
+    return TEST_RESULT();
+}
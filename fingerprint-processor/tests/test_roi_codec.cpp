@@ -0,0 +1,102 @@
+// test_roi_codec.cpp - ROI BLOB round trips, CRC32C vectors and corruption checks 
+#include "TestCheck.h"
+#include "database/RoiCodec.h"
+#include <cstring>
+
+static void fill_pixels(uint8_t (&pixels)[101][101], bool smooth, uint32_t seed) {
+    for (int y = 0; y < 101; ++y) {
+        for (int x = 0; x < 101; ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            pixels[y][x] = smooth ? static_cast<uint8_t>((x + y) / 2) : static_cast<uint8_t>(seed >> 24);
+        }
+    }
+}
+
+static bool same_pixels(const uint8_t (&a)[101][101], const uint8_t (&b)[101][101]) {
+    return std::memcmp(a, b, RoiCodec::RAW_SIZE) == 0;
+}
+
+int main() {
+    // CRC32C check values (RFC 3720 and the standard "123456789" vector)
+    CHECK_EQ(RoiCodec::crc32c("123456789", 9), 0xE3069283u);
+    uint8_t zeros[32] = {0};
+    CHECK_EQ(RoiCodec::crc32c(zeros, sizeof(zeros)), 0x8A9136AAu);
+    CHECK_EQ(RoiCodec::crc32c("", 0), 0u);
+    
+    // Checksumming in pieces matches one pass, at every split point of an odd length
+    const char* text = "The quick brown fox jumps over the lazy dog";
+    const size_t length = std::strlen(text);
+    const uint32_t whole = RoiCodec::crc32c(text, length);
+    for (size_t split = 0; split <= length; ++split) {
+        CHECK_EQ(RoiCodec::crc32c(text + split, length - split, RoiCodec::crc32c(text, split)), whole);
+    }
+    
+    uint8_t pixels[101][101];
+    uint8_t decoded[101][101];
+    std::vector<uint8_t> blob;
+    
+    // Every requested compression round-trips, whether or not this build has it
+    const RoiCodec::Compression modes[] = {
+        RoiCodec::Compression::NONE, RoiCodec::Compression::LZ4, RoiCodec::Compression::ZSTD
+    };
+    for (RoiCodec::Compression mode : modes) {
+        for (bool smooth : {false, true}) {
+            fill_pixels(pixels, smooth, 7);
+            RoiCodec::Compression used = RoiCodec::encode(pixels, blob, mode);
+            CHECK(used == mode || used == RoiCodec::Compression::NONE);
+            CHECK(blob.size() <= RoiCodec::max_encoded_size());
+            CHECK_EQ(blob[5], static_cast<uint8_t>(used));
+            
+            std::memset(decoded, 0, sizeof(decoded));
+            std::string error;
+            CHECK(RoiCodec::decode(blob.data(), blob.size(), decoded, &error));
+            CHECK(error.empty());
+            CHECK(same_pixels(pixels, decoded));
+            
+            // Noise never compresses: it must fall back to raw rather than grow
+            if (!smooth) CHECK_EQ(blob.size(), RoiCodec::HEADER_SIZE + RoiCodec::RAW_SIZE);
+            if (smooth && RoiCodec::is_available(mode) && mode != RoiCodec::Compression::NONE) {
+                CHECK(used == mode);
+                CHECK(blob.size() < RoiCodec::RAW_SIZE / 4);
+            }
+        }
+    }
+    
+    // Header layout
+    fill_pixels(pixels, false, 11);
+    RoiCodec::encode(pixels, blob, RoiCodec::Compression::NONE);
+    CHECK_EQ(blob[0], static_cast<uint8_t>('F'));
+    CHECK_EQ(blob[1], static_cast<uint8_t>('R'));
+    CHECK_EQ(blob[2], static_cast<uint8_t>('O'));
+    CHECK_EQ(blob[3], static_cast<uint8_t>('I'));
+    CHECK_EQ(blob[4], RoiCodec::VERSION);
+    CHECK_EQ(blob[6], static_cast<uint8_t>(101));
+    CHECK_EQ(blob[7], static_cast<uint8_t>(101));
+    
+    // Corruption is detected, never decoded into garbage
+    std::string error;
+    std::vector<uint8_t> damaged = blob;
+    damaged[RoiCodec::HEADER_SIZE + 500] ^= 0x01;
+    CHECK(!RoiCodec::decode(damaged.data(), damaged.size(), decoded, &error));
+    CHECK_EQ(error, std::string("ROI blob checksum mismatch"));
+    
+    CHECK(!RoiCodec::decode(blob.data(), blob.size() - 1, decoded, &error));
+    CHECK(!RoiCodec::decode(blob.data(), RoiCodec::HEADER_SIZE - 1, decoded, &error));
+    CHECK(!RoiCodec::decode(nullptr, 0, decoded, &error));
+    
+    damaged = blob;
+    damaged[4] = RoiCodec::VERSION + 1;
+    CHECK(!RoiCodec::decode(damaged.data(), damaged.size(), decoded, &error));
+    
+    damaged = blob;
+    damaged[5] = 9;
+    CHECK(!RoiCodec::decode(damaged.data(), damaged.size(), decoded, &error));
+    
+    // Legacy rows: the bare 10201-byte pixel array
+    fill_pixels(pixels, true, 3);
+    std::memset(decoded, 0, sizeof(decoded));
+    CHECK(RoiCodec::decode(&pixels[0][0], RoiCodec::RAW_SIZE, decoded, &error));
+    CHECK(same_pixels(pixels, decoded));
+    
+    return TEST_RESULT();
+}
@@ -0,0 +1,126 @@
+// test_roi_extraction.cpp - Row-copy and rotated ROI extraction match per-pixel references, inside and at the edges 
+#include "TestCheck.h"
+#include "core/CorePointDetector.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using DetectionResult = CorePointDetector::DetectionResult;
+
+// Concentric ridges with noise, so neighbouring pixels differ and any off-by-one shows
+static cv::Mat make_whorl(int rows, int cols, float center_x, float center_y) {
+    cv::Mat image(rows, cols, CV_8U);
+    uint32_t seed = 1;
+    for (int y = 0; y < rows; ++y) {
+        uint8_t* row = image.ptr<uint8_t>(y);
+        for (int x = 0; x < cols; ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            float radius = std::hypot(x - center_x, y - center_y);
+            float value = 128.0f + static_cast<float>(seed >> 29);
+            if (radius < 110.0f) value += 90.0f * std::sin(radius * 6.2831853f / 9.0f);
+            row[x] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, value)));
+        }
+    }
+    return image;
+}
+
+// Many weak cores, so ROIs land both well inside the image and across its edges
+static DetectionResult detect(const cv::Mat& image, bool align, bool use_simd) {
+    CorePointDetector::DetectionParams params;
+    params.align_roi_orientation = align;
+    params.use_simd = use_simd;
+    params.max_core_points = 200;
+    params.core_nms_radius = 0.0f;
+    params.min_confidence = 0.0f;
+    CorePointDetector detector(params);
+    return detector.detect_core_point(image, "whorl.png", 0);
+}
+
+static const CorePointDetector::ROI& roi_of(const DetectionResult& result, size_t core) {
+    return core == 0 ? result.extracted_roi : result.secondary_rois[core - 1];
+}
+
+// 101x101 crop around (x, y) with edge pixels replicated outside the image
+static int crop_mismatches(const cv::Mat& image, int center_x, int center_y, const CorePointDetector::ROI& roi) {
+    int mismatches = 0;
+    for (int y = 0; y < 101; ++y) {
+        for (int x = 0; x < 101; ++x) {
+            int image_x = std::clamp(center_x - 50 + x, 0, image.cols - 1);
+            int image_y = std::clamp(center_y - 50 + y, 0, image.rows - 1);
+            mismatches += roi.pixels[y][x] != image.at<uint8_t>(image_y, image_x);
+        }
+    }
+    return mismatches;
+}
+
+// Largest difference from a double-precision bilinear sample of the grid rotated by angle
+static int max_sampling_error(const cv::Mat& image, double center_x, double center_y, double angle,
+                              const CorePointDetector::ROI& roi) {
+    const double cos_a = std::cos(angle), sin_a = std::sin(angle);
+    int worst = 0;
+    for (int v = 0; v < 101; ++v) {
+        for (int u = 0; u < 101; ++u) {
+            double x = std::clamp(center_x + (u - 50) * cos_a - (v - 50) * sin_a, 0.0, image.cols - 1.0);
+            double y = std::clamp(center_y + (u - 50) * sin_a + (v - 50) * cos_a, 0.0, image.rows - 1.0);
+            int x0 = static_cast<int>(x), y0 = static_cast<int>(y);
+            int x1 = std::min(x0 + 1, image.cols - 1), y1 = std::min(y0 + 1, image.rows - 1);
+            double fx = x - x0, fy = y - y0;
+            double upper = image.at<uint8_t>(y0, x0) + fx * (image.at<uint8_t>(y0, x1) - image.at<uint8_t>(y0, x0));
+            double lower = image.at<uint8_t>(y1, x0) + fx * (image.at<uint8_t>(y1, x1) - image.at<uint8_t>(y1, x0));
+            long expected = std::lround(upper + fy * (lower - upper));
+            worst = std::max(worst, static_cast<int>(std::labs(expected - roi.pixels[v][u])));
+        }
+    }
+    return worst;
+}
+
+int main() {
+    Logger::set_level(Logger::Level::ERROR);
+    const cv::Mat images[] = {make_whorl(320, 300, 150.0f, 160.0f), make_whorl(320, 300, 60.0f, 60.0f)};
+    
+    int interior_crops = 0, edge_crops = 0;
+    int simd_samples = 0, clamped_samples = 0;
+    for (const cv::Mat& image : images) {
+        // Row-copy extraction: the memcpy fast path and the replicated-edge path both
+        // give exactly the clamped crop
+        const DetectionResult plain = detect(image, false, true);
+        CHECK(plain.success);
+        for (size_t i = 0; i < plain.core_points.size(); ++i) {
+            const CorePointDetector::CorePoint& core = plain.core_points[i];
+            int x = static_cast<int>(core.x), y = static_cast<int>(core.y);
+            CHECK_EQ(crop_mismatches(image, x, y, roi_of(plain, i)), 0);
+            CHECK_EQ(roi_of(plain, i).rotation, 0.0f);
+            bool inside = x >= 50 && y >= 50 && x + 51 <= image.cols && y + 51 <= image.rows;
+            (inside ? interior_crops : edge_crops)++;
+        }
+        
+        // Rotated extraction: AVX2 and scalar samplers pick the same cores and angles,
+        // and both stay within rounding of an exact bilinear sample
+        const DetectionResult simd = detect(image, true, true);
+        const DetectionResult scalar = detect(image, true, false);
+        CHECK_EQ(simd.core_points.size(), scalar.core_points.size());
+        for (size_t i = 0; i < simd.core_points.size() && i < scalar.core_points.size(); ++i) {
+            const CorePointDetector::CorePoint& core = simd.core_points[i];
+            CHECK_EQ(core.x, scalar.core_points[i].x);
+            CHECK_EQ(core.y, scalar.core_points[i].y);
+            CHECK_EQ(roi_of(simd, i).rotation, roi_of(scalar, i).rotation);
+            
+            const double angle = roi_of(simd, i).rotation;
+            CHECK(max_sampling_error(image, core.x, core.y, angle, roi_of(simd, i)) <= 1);
+            CHECK(max_sampling_error(image, core.x, core.y, angle, roi_of(scalar, i)) <= 1);
+            
+            bool reachable = core.x >= 77 && core.x + 77 <= image.cols - 4 && core.y >= 77 && core.y + 77 <= image.rows - 2;
+            (reachable ? simd_samples : clamped_samples)++;
+        }
+    }
+    
+    // Both paths of each extractor were exercised
+    CHECK(interior_crops > 0);
+    CHECK(edge_crops > 0);
+    CHECK(simd_samples > 0);
+    CHECK(clamped_samples > 0);
+    
+    return TEST_RESULT();
+}
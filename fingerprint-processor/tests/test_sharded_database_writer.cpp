@@ -0,0 +1,166 @@
+// test_sharded_database_writer.cpp - Shard routing by filename and address prefix, the ShardSet view and merge_into 
+#include "TestCheck.h"
+#include "database/ShardedDatabaseWriter.h"
+#include "utils/Logger.h"
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+static void make_stripes(CorePointDetector::ROI& roi, float period) {
+    for (int y = 0; y < 101; ++y) {
+        for (int x = 0; x < 101; ++x) {
+            float phase = (x + 0.3f * y) * 6.2831853f / period;
+            roi.pixels[y][x] = static_cast<uint8_t>(std::lrint(128.0f + 90.0f * std::sin(phase)));
+        }
+    }
+}
+
+// Stripes of a per-input period, so addresses spread over several ridge bins;
+// odd inputs carry a second core with a different period (and address)
+static CorePointDetector::DetectionResult make_result(int index) {
+    CorePointDetector::DetectionResult result;
+    result.success = true;
+    result.core_points.emplace_back(60.0f, 70.0f, 0.8f);
+    result.extracted_roi.filename = "input_" + std::to_string(index) + ".png";
+    result.extracted_roi.file_index = index;
+    make_stripes(result.extracted_roi, 5.0f + 0.5f * (index % 16));
+    if (index % 2 == 1) {
+        result.core_points.emplace_back(90.0f, 40.0f, 0.6f);
+        result.secondary_rois.push_back(result.extracted_roi);
+        make_stripes(result.secondary_rois.back(), 5.0f + 0.5f * ((index + 7) % 16));
+    }
+    result.content_hash = 300 + static_cast<uint64_t>(index);
+    return result;
+}
+
+struct StoredRow {
+    size_t shard;
+    std::string filename;
+    std::string address;
+};
+
+// Every row of every shard, read through the ShardSet view
+static std::vector<StoredRow> read_all(const std::vector<std::string>& paths) {
+    std::vector<StoredRow> rows;
+    ShardSet set;
+    CHECK(set.open(paths));
+    CHECK_EQ(set.size(), paths.size());
+    SQLiteStatement select;
+    CHECK(set.connection().prepare(select, "SELECT shard, filename, address FROM all_rois ORDER BY shard, id;"));
+    while (select.step() == SQLITE_ROW) {
+        StoredRow row;
+        row.shard = static_cast<size_t>(select.column_int64(0));
+        row.filename = select.column_text(1);
+        row.address = select.column_text(2);
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+static std::vector<std::string> write_shards(const std::string& base, ShardedDatabaseWriter::Partitioning partitioning,
+                                             int inputs) {
+    ShardedDatabaseWriter::Config config;
+    config.shard.database.database_path = base;
+    config.shard_count = 3;
+    config.partitioning = partitioning;
+    config.prefix_length = 3;               // Pattern letter and ridge digit
+    
+    ShardedDatabaseWriter writer;
+    CHECK(writer.start(config));
+    CHECK_EQ(writer.shard_count(), static_cast<size_t>(3));
+    for (int i = 0; i < inputs; ++i) {
+        CHECK(writer.submit(make_result(i)));
+    }
+    CHECK(writer.flush());
+    std::vector<std::string> paths = writer.get_shard_paths();
+    writer.stop();
+    return paths;
+}
+
+static void remove_all(const std::vector<std::string>& paths) {
+    for (const auto& path : paths) std::remove(path.c_str());
+}
+
+int main() {
+    Logger::set_level(Logger::Level::WARNING);
+    const std::string base = "/tmp/test_sharded_writer_" + std::to_string(getpid()) + ".db";
+    const int inputs = 48;
+    const size_t expected_rows = inputs + inputs / 2;
+    
+    CHECK_EQ(ShardedDatabaseWriter::shard_path("/data/rois.db", 3), std::string("/data/rois_shard03.db"));
+    CHECK_EQ(ShardedDatabaseWriter::shard_path("/data.d/rois", 12), std::string("/data.d/rois_shard12"));
+    
+    // Filename hash: every row sits in the shard its filename hashes to,
+    // and the cores of one input stay together
+    {
+        std::vector<std::string> paths = write_shards(base, ShardedDatabaseWriter::Partitioning::FILENAME_HASH, inputs);
+        std::vector<StoredRow> rows = read_all(paths);
+        CHECK_EQ(rows.size(), expected_rows);
+        
+        std::set<size_t> used;
+        for (const StoredRow& row : rows) {
+            CHECK_EQ(row.shard, ShardedDatabaseWriter::hash_key(row.filename) % paths.size());
+            used.insert(row.shard);
+        }
+        CHECK_EQ(used.size(), paths.size());
+        remove_all(paths);
+    }
+    
+    // Address prefix: routing sees the address computed at submit, so every
+    // row with the same prefix lands in the prefix's shard
+    std::vector<std::string> paths = write_shards(base, ShardedDatabaseWriter::Partitioning::KEY_PREFIX, inputs);
+    std::vector<StoredRow> rows = read_all(paths);
+    CHECK_EQ(rows.size(), expected_rows);
+    
+    std::map<std::string, std::set<size_t>> shards_by_prefix;
+    std::map<std::string, size_t> shard_by_filename;
+    for (const StoredRow& row : rows) {
+        CHECK_EQ(row.address.size(), AddressGenerator::ADDRESS_LENGTH);
+        
+        // Both cores of an input are one unit, routed by its first core's address
+        auto inserted = shard_by_filename.emplace(row.filename, row.shard);
+        CHECK_EQ(inserted.first->second, row.shard);
+        if (!inserted.second) continue;
+        
+        std::string prefix = row.address.substr(0, 3);
+        CHECK_EQ(row.shard, ShardedDatabaseWriter::hash_key(prefix) % paths.size());
+        shards_by_prefix[prefix].insert(row.shard);
+    }
+    CHECK(shards_by_prefix.size() > 1);
+    for (const auto& entry : shards_by_prefix) {
+        CHECK_EQ(entry.second.size(), static_cast<size_t>(1));
+    }
+    
+    // merge_into copies every shard's rows into one database
+    const std::string merged = "/tmp/test_sharded_writer_" + std::to_string(getpid()) + "_merged.db";
+    std::remove(merged.c_str());
+    CHECK(ShardSet::merge_into(paths, merged));
+    {
+        SQLiteAdapter db;
+        CHECK(db.open(merged));
+        SQLiteStatement select;
+        CHECK(db.prepare(select, "SELECT filename, address FROM rois ORDER BY filename, core_rank;"));
+        std::multiset<std::string> merged_rows, shard_rows;
+        while (select.step() == SQLITE_ROW) {
+            merged_rows.insert(std::string(select.column_text(0)) + " " + select.column_text(1));
+        }
+        for (const StoredRow& row : rows) {
+            shard_rows.insert(row.filename + " " + row.address);
+        }
+        CHECK_EQ(merged_rows.size(), expected_rows);
+        CHECK(merged_rows == shard_rows);
+    }
+    
+    // Attaching fails cleanly on a missing shard list
+    ShardSet empty;
+    CHECK(!empty.open({}));
+    
+    remove_all(paths);
+    std::remove(merged.c_str());
+    
+    return TEST_RESULT();
+}
@@ -0,0 +1,149 @@
+// test_vector_index.cpp - Background retraining keeps every vector; stored feature vectors load and search back 
+#include "TestCheck.h"
+#include "database/DatabaseWriter.h"
+#include "database/VectorIndex.h"
+#include "utils/Logger.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+static void make_vector(int64_t id, std::vector<float>& vector) {
+    uint32_t seed = static_cast<uint32_t>(id) * 2654435761u + 1;
+    for (float& value : vector) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<float>(seed >> 8) / static_cast<float>(1 << 24);
+    }
+}
+
+// Stripes of a per-input period and angle, so every stored vector differs
+static CorePointDetector::DetectionResult make_result(int index) {
+    CorePointDetector::DetectionResult result;
+    result.success = true;
+    result.core_points.emplace_back(60.0f, 70.0f, 0.8f);
+    result.extracted_roi.filename = "input_" + std::to_string(index) + ".png";
+    result.extracted_roi.file_index = index;
+    const float period = 6.0f + 0.3f * index;
+    const float angle = 0.05f * index;
+    for (int y = 0; y < 101; ++y) {
+        for (int x = 0; x < 101; ++x) {
+            float phase = (x * std::cos(angle) + y * std::sin(angle)) * 6.2831853f / period;
+            result.extracted_roi.pixels[y][x] = static_cast<uint8_t>(std::lrint(128.0f + 90.0f * std::sin(phase)));
+        }
+    }
+    result.content_hash = 500 + static_cast<uint64_t>(index);
+    return result;
+}
+
+int main() {
+    Logger::set_level(Logger::Level::WARNING);
+    
+    VectorIndex::Config config;
+    config.dimension = 24;
+    config.min_train_size = 256;
+    config.probes = 1 << 20;                // Scan every list: results must be exact
+    VectorIndex index(config);
+    
+    // Searches run throughout the adds and the rebuilds they trigger
+    std::atomic<bool> done{false};
+    std::atomic<int> searches{0};
+    std::thread reader([&]() {
+        std::vector<float> query(config.dimension);
+        for (int64_t id = 0; !done; id = (id + 1) % 64) {
+            make_vector(id, query);
+            index.search(query.data(), 5);
+            searches++;
+        }
+    });
+    
+    std::vector<float> vector(config.dimension);
+    const int64_t count = 5000;             // Trains at 256, retrains at 1024 and 4096
+    for (int64_t id = 0; id < count; ++id) {
+        make_vector(id, vector);
+        CHECK(index.add(id, vector.data()));
+    }
+    index.wait_for_rebuild();
+    done = true;
+    reader.join();
+    CHECK(searches.load() > 0);
+    
+    // Nothing added during a rebuild was lost or duplicated
+    VectorIndex::IndexStats stats = index.get_stats();
+    CHECK(stats.trained);
+    CHECK(stats.lists > 1);
+    CHECK_EQ(stats.vectors, static_cast<size_t>(count));
+    CHECK_EQ(index.size(), static_cast<size_t>(count));
+    
+    int found = 0;
+    for (int64_t id = 0; id < count; id += 7) {
+        make_vector(id, vector);
+        std::vector<VectorIndex::Neighbor> neighbors = index.search(vector.data(), 2);
+        if (!neighbors.empty() && neighbors[0].id == id && neighbors[0].distance == 0.0f &&
+            (neighbors.size() < 2 || neighbors[1].id != id)) {
+            found++;
+        }
+    }
+    CHECK_EQ(found, static_cast<int>((count + 6) / 7));
+    
+    // An explicit rebuild runs on the caller and keeps the contents
+    index.rebuild();
+    CHECK_EQ(index.size(), static_cast<size_t>(count));
+    
+    // build() replaces the contents even if a rebuild was just started
+    std::vector<int64_t> ids = {1, 2, 3};
+    std::vector<float> vectors(3 * config.dimension);
+    for (int i = 0; i < 3; ++i) {
+        std::vector<float> one(config.dimension);
+        make_vector(ids[i], one);
+        std::copy(one.begin(), one.end(), vectors.begin() + i * config.dimension);
+    }
+    CHECK(index.build(ids, vectors.data(), ids.size()));
+    CHECK_EQ(index.size(), static_cast<size_t>(3));
+    CHECK(!index.get_stats().trained);
+    
+    // Vectors stored by DatabaseWriter::write(result) load back and find their own rows
+    const std::string path = "/tmp/test_vector_index_" + std::to_string(getpid()) + ".db";
+    std::remove(path.c_str());
+    const int rows = 40;
+    {
+        DatabaseWriter::Config writer_config;
+        writer_config.database_path = path;
+        DatabaseWriter writer;
+        CHECK(writer.open(writer_config));
+        for (int i = 0; i < rows; ++i) {
+            CHECK(writer.write(make_result(i)));
+        }
+        CHECK(writer.flush());
+    }
+    
+    VectorIndex::Config stored_config;
+    stored_config.dimension = FeatureExtractor::FeatureVector::DIM;
+    stored_config.probes = 1 << 20;
+    VectorIndex stored(stored_config);
+    CHECK(stored.load_from_database(path));
+    CHECK_EQ(stored.size(), static_cast<size_t>(rows));
+    
+    SQLiteAdapter db;
+    CHECK(db.open(path));
+    SQLiteStatement select;
+    CHECK(db.prepare(select, "SELECT id, feature_vector FROM rois ORDER BY id;"));
+    int matched = 0;
+    while (select.step() == SQLITE_ROW) {
+        CHECK_EQ(select.column_bytes(1), stored_config.dimension * sizeof(float));
+        std::vector<float> query(stored_config.dimension);
+        std::memcpy(query.data(), select.column_blob(1), query.size() * sizeof(float));
+        std::vector<VectorIndex::Neighbor> neighbors = stored.search(query.data(), 2);
+        if (neighbors.size() == 2 && neighbors[0].id == select.column_int64(0) &&
+            neighbors[0].distance == 0.0f && neighbors[1].distance > 0.0f) {
+            matched++;
+        }
+    }
+    CHECK_EQ(matched, rows);
+    db.close();
+    std::remove(path.c_str());
+    
+    return TEST_RESULT();
+}